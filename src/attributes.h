@@ -16,4 +16,18 @@
 #define LIFETIMEBOUND
 #endif
 
+/**
+ * Let the compiler reuse the tail padding of a member for the members that
+ * follow it. This is standard in C++20, and supported as an extension before.
+ */
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define NO_UNIQUE_ADDRESS [[no_unique_address]]
+#else
+#define NO_UNIQUE_ADDRESS
+#endif
+#else
+#define NO_UNIQUE_ADDRESS
+#endif
+
 #endif // BITCOIN_ATTRIBUTES_H
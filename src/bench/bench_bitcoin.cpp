@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 
 #include <clientversion.h>
+#include <crypto/muhash.h>
 #include <crypto/sha256.h>
 #include <fs.h>
 #include <util/strencodings.h>
@@ -65,6 +66,7 @@ int main(int argc, char **argv) {
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    MuHash3072AutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n",
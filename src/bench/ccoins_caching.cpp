@@ -4,10 +4,16 @@
 
 #include <bench/bench.h>
 #include <coins.h>
+#include <memusage.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
+#include <tinyformat.h>
 
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -50,4 +56,72 @@ static void CCoinsCaching(benchmark::Bench &bench) {
     ECC_Stop();
 }
 
+
+static constexpr size_t NUM_CACHED_COINS{100000};
+
+static std::vector<COutPoint> RandomOutpoints(FastRandomContext &rng) {
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(NUM_CACHED_COINS);
+    for (size_t i = 0; i < NUM_CACHED_COINS; ++i) {
+        outpoints.emplace_back(TxId(rng.rand256()), rng.randrange(4));
+    }
+    return outpoints;
+}
+
+static Coin P2PKHCoin() {
+    CScript scriptPubKey;
+    scriptPubKey << OP_DUP << OP_HASH160 << std::vector<uint8_t>(20, 0)
+                 << OP_EQUALVERIFY << OP_CHECKSIG;
+    return Coin(CTxOut(50 * COIN, scriptPubKey), 1, false);
+}
+
+// Add coins to an empty cache, as connecting blocks does.
+static void CCoinsCachingInsert(benchmark::Bench &bench) {
+    FastRandomContext rng(true);
+    const std::vector<COutPoint> outpoints = RandomOutpoints(rng);
+    const Coin coin = P2PKHCoin();
+    CCoinsView coinsDummy;
+
+    bench.batch(outpoints.size()).unit("coin").run([&] {
+        CCoinsViewCache coins(&coinsDummy);
+        for (const COutPoint &outpoint : outpoints) {
+            coins.AddCoin(outpoint, Coin(coin), false);
+        }
+        ankerl::nanobench::doNotOptimizeAway(coins.GetCacheSize());
+    });
+}
+
+// Look up coins in a cache in random order, as validating transactions does.
+static void CCoinsCachingLookup(benchmark::Bench &bench) {
+    FastRandomContext rng(true);
+    std::vector<COutPoint> outpoints = RandomOutpoints(rng);
+    const Coin coin = P2PKHCoin();
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>
+        node_map;
+    for (const COutPoint &outpoint : outpoints) {
+        coins.AddCoin(outpoint, Coin(coin), false);
+        node_map.emplace(outpoint, CCoinsCacheEntry(Coin(coin)));
+    }
+
+    // Compare the number of coins that fit in a MiB of -dbcache with the
+    // accounting of a map that allocates its nodes one by one.
+    std::cout << strprintf(
+        "CCoinsCachingLookup: %d coins per MiB of cache (%d with "
+        "std::allocator)\n",
+        NUM_CACHED_COINS * (1 << 20) / coins.DynamicMemoryUsage(),
+        NUM_CACHED_COINS * (1 << 20) / memusage::DynamicUsage(node_map));
+
+    Shuffle(outpoints.begin(), outpoints.end(), rng);
+    size_t i = 0;
+    bench.unit("lookup").minEpochIterations(10000).run([&] {
+        const Coin &cached = coins.AccessCoin(outpoints[i]);
+        assert(!cached.IsSpent());
+        i = (i + 1) % outpoints.size();
+    });
+}
+
 BENCHMARK(CCoinsCaching);
+BENCHMARK(CCoinsCachingInsert);
+BENCHMARK(CCoinsCachingLookup);
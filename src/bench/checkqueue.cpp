@@ -4,10 +4,12 @@
 
 #include <bench/bench.h>
 #include <checkqueue.h>
+#include <crypto/sha256.h>
 #include <key.h>
 #include <prevector.h>
 #include <pubkey.h>
 #include <random.h>
+#include <uint256.h>
 #include <util/system.h>
 
 #include <vector>
@@ -17,6 +19,7 @@ static const size_t BATCHES = 101;
 static const size_t BATCH_SIZE = 30;
 static const int PREVECTOR_SIZE = 28;
 static const size_t QUEUE_BATCH_SIZE = 128;
+static const int HASH_JOB_ROUNDS = 16;
 
 // This Benchmark tests the CheckQueue with a slightly realistic workload, where
 // checks all contain a prevector that is indirect 50% of the time and there is
@@ -65,3 +68,65 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench &bench) {
     ECC_Stop();
 }
 BENCHMARK(CCheckQueueSpeedPrevectorJob);
+
+// This Benchmark tests how the CheckQueue scales with the number of threads
+// (including the master), with checks that do a little bit of work like a
+// signature check would.
+static void CCheckQueueSpeedHashJob(benchmark::Bench &bench, int threads_num) {
+    struct HashJob {
+        uint256 hash;
+        bool operator()() {
+            for (int i = 0; i < HASH_JOB_ROUNDS; ++i) {
+                CSHA256().Write(hash.begin(), hash.size()).Finalize(
+                    hash.begin());
+            }
+            return true;
+        }
+        void swap(HashJob &x) noexcept { std::swap(hash, x.hash); };
+    };
+    CCheckQueue<HashJob> queue{QUEUE_BATCH_SIZE};
+    queue.StartWorkerThreads(threads_num - 1);
+
+    bench.minEpochIterations(10)
+        .batch(BATCH_SIZE * BATCHES)
+        .unit("job")
+        .run([&] {
+            CCheckQueueControl<HashJob> control(&queue);
+            for (size_t i = 0; i < BATCHES; ++i) {
+                std::vector<HashJob> vChecks(BATCH_SIZE);
+                control.Add(vChecks);
+            }
+            control.Wait();
+        });
+    queue.StopWorkerThreads();
+}
+
+static void CCheckQueueSpeedHashJob1Thread(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 1);
+}
+static void CCheckQueueSpeedHashJob2Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 2);
+}
+static void CCheckQueueSpeedHashJob4Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 4);
+}
+static void CCheckQueueSpeedHashJob8Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 8);
+}
+static void CCheckQueueSpeedHashJob16Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 16);
+}
+static void CCheckQueueSpeedHashJob32Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 32);
+}
+static void CCheckQueueSpeedHashJob64Threads(benchmark::Bench &bench) {
+    CCheckQueueSpeedHashJob(bench, 64);
+}
+
+BENCHMARK(CCheckQueueSpeedHashJob1Thread);
+BENCHMARK(CCheckQueueSpeedHashJob2Threads);
+BENCHMARK(CCheckQueueSpeedHashJob4Threads);
+BENCHMARK(CCheckQueueSpeedHashJob8Threads);
+BENCHMARK(CCheckQueueSpeedHashJob16Threads);
+BENCHMARK(CCheckQueueSpeedHashJob32Threads);
+BENCHMARK(CCheckQueueSpeedHashJob64Threads);
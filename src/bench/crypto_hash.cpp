@@ -111,6 +111,18 @@ static void MuHashDiv(benchmark::Bench &bench) {
     bench.run([&] { acc /= muhash; });
 }
 
+static void MuHashFinalize(benchmark::Bench &bench) {
+    FastRandomContext rng(true);
+    MuHash3072 acc{rng.randbytes(32)};
+    acc /= MuHash3072(rng.randbytes(32));
+
+    bench.run([&] {
+        uint256 out;
+        acc.Finalize(out);
+        acc /= MuHash3072(out);
+    });
+}
+
 static void MuHashPrecompute(benchmark::Bench &bench) {
     MuHash3072 acc;
     FastRandomContext rng(true);
@@ -134,4 +146,5 @@ BENCHMARK(FastRandom_1bit);
 BENCHMARK(MuHash);
 BENCHMARK(MuHashMul);
 BENCHMARK(MuHashDiv);
+BENCHMARK(MuHashFinalize);
 BENCHMARK(MuHashPrecompute);
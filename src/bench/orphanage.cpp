@@ -0,0 +1,82 @@
+// Copyright (c) 2023 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net_processing.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <txorphanage.h>
+
+#include <set>
+#include <vector>
+
+static constexpr size_t NUM_PEERS = 125;
+static constexpr size_t NUM_PARENTS = 1000;
+static constexpr size_t ORPHANS_PER_PARENT = 5;
+
+// Simulates a flood of orphans announced by many peers: the orphanage is kept
+// at its default limits while orphans are added, their parents show up and
+// peers disconnect.
+static void OrphanageChurn(benchmark::Bench &bench) {
+    FastRandomContext rng{true};
+
+    // Transactions that go missing, and orphans spending their outputs. Some
+    // of the orphans are much larger than the others.
+    std::vector<CTransactionRef> parents;
+    std::vector<CTransactionRef> orphans;
+    for (size_t i = 0; i < NUM_PARENTS; i++) {
+        CMutableTransaction parent;
+        parent.vin.resize(1);
+        parent.vin[0].prevout = COutPoint(TxId(rng.rand256()), 0);
+        parent.vout.resize(ORPHANS_PER_PARENT);
+        for (auto &txout : parent.vout) {
+            txout.nValue = 1 * COIN;
+        }
+        parents.push_back(MakeTransactionRef(parent));
+
+        for (size_t n = 0; n < ORPHANS_PER_PARENT; n++) {
+            CMutableTransaction orphan;
+            orphan.vin.resize(1);
+            orphan.vin[0].prevout = COutPoint(parents.back()->GetId(), n);
+            orphan.vout.resize(1);
+            orphan.vout[0].nValue = 1 * COIN;
+            orphan.vout[0].scriptPubKey =
+                CScript() << std::vector<uint8_t>(
+                    rng.randrange(10) == 0 ? 50000 : 100, 0x51);
+            orphans.push_back(MakeTransactionRef(orphan));
+        }
+    }
+
+    const size_t max_orphans_bytes =
+        DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE * 1000000;
+
+    bench.run([&] {
+        TxOrphanage orphanage;
+        std::set<TxId> work_set;
+        LOCK(g_cs_orphans);
+
+        for (size_t i = 0; i < orphans.size(); i++) {
+            orphanage.AddTx(orphans[i], i % NUM_PEERS);
+            orphanage.LimitOrphans(DEFAULT_MAX_ORPHAN_TRANSACTIONS,
+                                   max_orphans_bytes);
+
+            // Once all its orphans were announced, the parent shows up.
+            if (i % ORPHANS_PER_PARENT == ORPHANS_PER_PARENT - 1) {
+                orphanage.AddChildrenToWorkSet(
+                    *parents[i / ORPHANS_PER_PARENT], work_set);
+                for (const TxId &txid : work_set) {
+                    orphanage.EraseTx(txid);
+                }
+                work_set.clear();
+            }
+
+            // Peers disconnect now and then.
+            if (i % 100 == 99) {
+                orphanage.EraseForPeer((i / 100) % NUM_PEERS);
+            }
+        }
+    });
+}
+
+BENCHMARK(OrphanageChurn);
@@ -4,6 +4,8 @@
 
 #include <bench/bench.h>
 #include <key.h>
+#include <pubkey.h>
+#include <random.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/bitcoinconsensus.h>
 #endif
@@ -39,3 +41,51 @@ static void VerifyNestedIfScript(benchmark::Bench &bench) {
 }
 
 BENCHMARK(VerifyNestedIfScript);
+
+static constexpr size_t SCHNORR_BATCH_SIZE = 64;
+
+static void VerifySchnorr(benchmark::Bench &bench, bool batch) {
+    const ECCVerifyHandle verify_handle;
+    ECC_Start();
+
+    FastRandomContext rand(true);
+    std::vector<CPubKey> pubkeys;
+    std::vector<uint256> hashes;
+    std::vector<std::vector<uint8_t>> sigs(SCHNORR_BATCH_SIZE);
+    for (size_t i = 0; i < SCHNORR_BATCH_SIZE; ++i) {
+        CKey key;
+        key.MakeNewKey(true);
+        pubkeys.push_back(key.GetPubKey());
+        hashes.push_back(rand.rand256());
+        key.SignSchnorr(hashes[i], sigs[i]);
+    }
+
+    bench.batch(SCHNORR_BATCH_SIZE).unit("sig").run([&] {
+        if (batch) {
+            CSchnorrBatch schnorr_batch;
+            for (size_t i = 0; i < SCHNORR_BATCH_SIZE; ++i) {
+                schnorr_batch.Add(pubkeys[i], hashes[i], sigs[i]);
+            }
+            bool ret = schnorr_batch.Verify();
+            assert(ret);
+        } else {
+            for (size_t i = 0; i < SCHNORR_BATCH_SIZE; ++i) {
+                bool ret = pubkeys[i].VerifySchnorr(hashes[i], sigs[i]);
+                assert(ret);
+            }
+        }
+    });
+
+    ECC_Stop();
+}
+
+static void VerifySchnorrOneByOne(benchmark::Bench &bench) {
+    VerifySchnorr(bench, false);
+}
+
+static void VerifySchnorrBatch(benchmark::Bench &bench) {
+    VerifySchnorr(bench, true);
+}
+
+BENCHMARK(VerifySchnorrOneByOne);
+BENCHMARK(VerifySchnorrBatch);
@@ -10,10 +10,31 @@
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 template <typename T> class CCheckQueueControl;
 
+/**
+ * Run a batch of verifications taken from the queue, and return whether they
+ * all succeeded. Verification types that can be performed more efficiently
+ * together provide an overload of this function.
+ */
+template <typename T> bool RunCheckBatch(std::vector<T> &checks) {
+    for (T &check : checks) {
+        if (!check()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * Queue for verifications that have to be performed.
  * The verifications are represented by a type T, which must provide an
@@ -23,10 +44,23 @@ template <typename T> class CCheckQueueControl;
  * queue, where they are processed by N-1 worker threads. When the master is
  * done adding work, it temporarily joins the worker pool as an N'th worker,
  * until all jobs are done.
+ *
+ * Each of the N threads owns a deque of verifications. The master spreads the
+ * verifications it adds over all the deques, and each thread takes batches
+ * from the back of its own deque. A thread that runs out of work steals half
+ * of the verifications at the front of another thread's deque, so the deque
+ * locks are only contended while stealing. The threads only go through the
+ * shared mutex to sleep when there is no work left, and to wake up.
  */
 template <typename T> class CCheckQueue {
 private:
-    //! Mutex to protect the inner state
+    //! The verifications owned by one of the threads.
+    struct WorkerQueue {
+        Mutex m_mutex;
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex used to sleep and to wake up the threads
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
@@ -35,103 +69,125 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
-
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! One deque per worker thread, followed by the deque of the master. Only
+    //! modified while starting and stopping the worker threads.
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
+    //! The deque the next verifications are added to.
+    std::atomic<size_t> m_next_queue{0};
 
-    //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    //! The number of verifications that are queued and not taken by a thread
+    //! yet. Incremented before they are pushed to the deques, so that threads
+    //! don't go to sleep while there is still work to take.
+    std::atomic<uint64_t> m_pending{0};
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
-     * worker's own batches.
+     * thread's own batches.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<uint64_t> m_todo{0};
+
+    //! The number of worker threads that are about to sleep or sleeping.
+    std::atomic<int> m_idle{0};
+
+    //! The temporary evaluation result.
+    std::atomic<bool> m_all_ok{true};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
 
+    //! Prefix used to name the worker threads
+    const std::string m_thread_name;
+
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
+    /**
+     * Take a batch of verifications, from the back of the deque owned by the
+     * calling thread or, when it is empty, from the front of another thread's
+     * deque. Returns false if there was nothing to take.
+     */
+    bool TakeChecks(size_t self, std::vector<T> &vChecks) {
+        const size_t n_queues = m_queues.size();
+        for (size_t i = 0; i < n_queues; i++) {
+            const bool own = i == 0;
+            WorkerQueue &queue = *m_queues[(self + i) % n_queues];
+            LOCK(queue.m_mutex);
+            if (queue.m_checks.empty()) {
+                continue;
+            }
+
+            // Leave half of the verifications in the deque, so that idle
+            // threads can help, but don't do batches smaller than 1 (duh), or
+            // larger than nBatchSize.
+            const size_t n_take = std::max<size_t>(
+                1, std::min<size_t>(nBatchSize, queue.m_checks.size() / 2));
+            vChecks.resize(n_take);
+            for (T &check : vChecks) {
+                // We want the lock to be as short as possible, so swap jobs
+                // from the deque to the local batch vector instead of copying.
+                if (own) {
+                    check.swap(queue.m_checks.back());
+                    queue.m_checks.pop_back();
+                } else {
+                    check.swap(queue.m_checks.front());
+                    queue.m_checks.pop_front();
+                }
+            }
+            m_pending -= n_take;
+            return true;
+        }
+        return false;
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        std::condition_variable &cond = fMaster ? m_master_cv : m_worker_cv;
+    bool Loop(size_t self, bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
         do {
-            {
-                WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us
-                // to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster) {
-                        // We processed the last element; inform the master it
-                        // can exit and return the result
-                        m_master_cv.notify_one();
-                    }
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
+            if (TakeChecks(self, vChecks)) {
+                // Check whether we need to do work at all
+                if (m_all_ok.load(std::memory_order_relaxed) &&
+                    !RunCheckBatch(vChecks)) {
+                    m_all_ok = false;
                 }
-                if (m_request_stop) {
-                    return false;
+                const size_t n_done = vChecks.size();
+                // The verifications must be destroyed before they are
+                // reported as completed.
+                vChecks.clear();
+                if ((m_todo -= n_done) == 0 && !fMaster) {
+                    // We processed the last element; inform the master it can
+                    // exit and return the result
+                    WITH_LOCK(m_mutex, m_master_cv.notify_one());
                 }
+                continue;
+            }
 
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for
-                // increasingly smaller batches so all workers finish
-                // approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start
-                // helping.
-                // * Don't do batches smaller than 1 (duh), or larger than
-                // nBatchSize.
-                nNow = std::max(
-                    1U, std::min(nBatchSize, (unsigned int)queue.size() /
-                                                 (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the m_mutex to be as short as
-                    // possible, so swap jobs from the global queue to the local
-                    // batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
+            WAIT_LOCK(m_mutex, lock);
+            if (fMaster) {
+                if (m_todo == 0) {
+                    // return the current status, and reset it for new work
+                    // later
+                    return m_all_ok.exchange(true);
                 }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
-            }
-            // execute work
-            for (T &check : vChecks) {
-                if (fOk) {
-                    fOk = check();
+                if (m_pending == 0) {
+                    // The remaining work is in progress in the worker threads.
+                    m_master_cv.wait(lock);
                 }
+                continue;
+            }
+
+            // Announce that we are going to sleep before checking for work, so
+            // that the master doesn't miss us when it adds work.
+            m_idle++;
+            while (m_pending == 0 && !m_request_stop) {
+                m_worker_cv.wait(lock);
+            }
+            m_idle--;
+            if (m_request_stop) {
+                return false;
             }
-            vChecks.clear();
         } while (true);
     }
 
@@ -140,23 +196,27 @@ public:
     Mutex m_control_mutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn)
-        : nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn,
+                         std::string thread_name = "scriptch")
+        : nBatchSize(nBatchSizeIn), m_thread_name(std::move(thread_name)) {
+        // The deque of the master.
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
 
     //! Create a pool of new worker threads.
     void StartWorkerThreads(const int threads_num)
         EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        {
-            LOCK(m_mutex);
-            nIdle = 0;
-            nTotal = 0;
-            fAllOk = true;
-        }
         assert(m_worker_threads.empty());
+        assert(m_todo == 0);
+        m_all_ok = true;
+        m_queues.clear();
+        for (int n = 0; n <= threads_num; ++n) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
         for (int n = 0; n < threads_num; ++n) {
             m_worker_threads.emplace_back([this, n]() {
-                util::ThreadRename(strprintf("scriptch.%i", n));
-                Loop(false /* worker thread */);
+                util::ThreadRename(strprintf("%s.%i", m_thread_name, n));
+                Loop(n, false /* worker thread */);
             });
         }
     }
@@ -164,21 +224,42 @@ public:
     //! Wait until execution finishes, and return whether all evaluations were
     //! successful.
     bool Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        return Loop(true /* master thread */);
+        return Loop(m_queues.size() - 1, true /* master thread */);
     }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T> &vChecks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        LOCK(m_mutex);
-        for (T &check : vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
+        if (vChecks.empty()) {
+            return;
         }
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1) {
-            m_worker_cv.notify_one();
-        } else if (vChecks.size() > 1) {
-            m_worker_cv.notify_all();
+
+        m_todo += vChecks.size();
+        m_pending += vChecks.size();
+
+        // Spread the checks over the deques in contiguous chunks, starting
+        // with the deque following the one used by the previous call.
+        const size_t n_queues = m_queues.size();
+        const size_t chunk_size = (vChecks.size() + n_queues - 1) / n_queues;
+        size_t n_chunks = 0;
+        for (size_t begin = 0; begin < vChecks.size(); begin += chunk_size) {
+            const size_t end = std::min(begin + chunk_size, vChecks.size());
+            WorkerQueue &queue = *m_queues[m_next_queue++ % n_queues];
+            LOCK(queue.m_mutex);
+            for (size_t i = begin; i < end; i++) {
+                queue.m_checks.emplace_back();
+                vChecks[i].swap(queue.m_checks.back());
+            }
+            n_chunks++;
+        }
+
+        // Only wake up the threads that are sleeping, and no more than needed.
+        if (m_idle > 0) {
+            LOCK(m_mutex);
+            if (n_chunks == 1) {
+                m_worker_cv.notify_one();
+            } else {
+                m_worker_cv.notify_all();
+            }
         }
     }
 
@@ -191,6 +272,7 @@ public:
         }
         m_worker_threads.clear();
         WITH_LOCK(m_mutex, m_request_stop = false);
+        m_queues.resize(1);
     }
 
     ~CCheckQueue() { assert(m_worker_threads.empty()); }
@@ -10,6 +10,9 @@
 #include <util/trace.h>
 #include <version.h>
 
+#include <algorithm>
+#include <vector>
+
 bool CCoinsView::GetCoin(const COutPoint &outpoint, Coin &coin) const {
     return false;
 }
@@ -19,12 +22,21 @@ BlockHash CCoinsView::GetBestBlock() const {
 std::vector<BlockHash> CCoinsView::GetHeadBlocks() const {
     return std::vector<BlockHash>();
 }
-bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
+bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                            bool erase) {
     return false;
 }
 CCoinsViewCursor *CCoinsView::Cursor() const {
     return nullptr;
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsView::RangeCursors(size_t count) const {
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    if (CCoinsViewCursor *cursor = Cursor()) {
+        cursors.emplace_back(cursor);
+    }
+    return cursors;
+}
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const {
     Coin coin;
     return GetCoin(outpoint, coin);
@@ -47,18 +59,25 @@ void CCoinsViewBacked::SetBackend(CCoinsView &viewIn) {
     base = &viewIn;
 }
 bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins,
-                                  const BlockHash &hashBlock) {
-    return base->BatchWrite(mapCoins, hashBlock);
+                                  const BlockHash &hashBlock, bool erase) {
+    return base->BatchWrite(mapCoins, hashBlock, erase);
 }
 CCoinsViewCursor *CCoinsViewBacked::Cursor() const {
     return base->Cursor();
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsViewBacked::RangeCursors(size_t count) const {
+    return base->RangeCursors(count);
+}
 size_t CCoinsViewBacked::EstimateSize() const {
     return base->EstimateSize();
 }
 
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn)
-    : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
+    : CCoinsViewBacked(baseIn),
+      cacheCoins{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{},
+                 m_cache_coins_memory_resource.get()},
+      cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
     return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
@@ -149,6 +168,15 @@ void CCoinsViewCache::EmplaceCoinInternalDANGER(COutPoint &&outpoint,
         std::forward_as_tuple(std::move(coin), CCoinsCacheEntry::DIRTY));
 }
 
+void CCoinsViewCache::EmplaceCoinFromBase(const COutPoint &outpoint,
+                                          Coin &&coin) {
+    assert(!coin.IsSpent());
+    auto [it, inserted] = cacheCoins.try_emplace(outpoint, std::move(coin));
+    if (inserted) {
+        cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    }
+}
+
 void AddCoins(CCoinsViewCache &cache, const CTransaction &tx, int nHeight,
               bool check_for_overwrite) {
     bool fCoinbase = tx.IsCoinBase();
@@ -219,9 +247,9 @@ void CCoinsViewCache::SetBestBlock(const BlockHash &hashBlockIn) {
 }
 
 bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
-                                 const BlockHash &hashBlockIn) {
+                                 const BlockHash &hashBlockIn, bool erase) {
     for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();
-         it = mapCoins.erase(it)) {
+         it = erase ? mapCoins.erase(it) : std::next(it)) {
         // Ignore non-dirty entries (optimization).
         if (!(it->second.flags & CCoinsCacheEntry::DIRTY)) {
             continue;
@@ -235,7 +263,11 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
                 // Create the coin in the parent cache, move the data up
                 // and mark it as dirty.
                 CCoinsCacheEntry &entry = cacheCoins[it->first];
-                entry.coin = std::move(it->second.coin);
+                if (erase) {
+                    entry.coin = std::move(it->second.coin);
+                } else {
+                    entry.coin = it->second.coin;
+                }
                 cachedCoinsUsage += entry.coin.DynamicMemoryUsage();
                 entry.flags = CCoinsCacheEntry::DIRTY;
                 // We can mark it FRESH in the parent if it was FRESH in the
@@ -266,7 +298,11 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
             } else {
                 // A normal modification.
                 cachedCoinsUsage -= itUs->second.coin.DynamicMemoryUsage();
-                itUs->second.coin = std::move(it->second.coin);
+                if (erase) {
+                    itUs->second.coin = std::move(it->second.coin);
+                } else {
+                    itUs->second.coin = it->second.coin;
+                }
                 cachedCoinsUsage += itUs->second.coin.DynamicMemoryUsage();
                 itUs->second.flags |= CCoinsCacheEntry::DIRTY;
                 // NOTE: It isn't safe to mark the coin as FRESH in the parent
@@ -283,10 +319,91 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
 bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock);
     cacheCoins.clear();
+    // The memory resource keeps the memory of the erased entries for the next
+    // ones, so it has to be reallocated for the flush to release it.
+    ReallocateCache();
     cachedCoinsUsage = 0;
     return fOk;
 }
 
+bool CCoinsViewCache::Sync() {
+    bool fOk = base->BatchWrite(cacheCoins, hashBlock, /*erase=*/false);
+    // Instead of clearing the cache as Flush() does, only drop the spent
+    // coins and mark the others as unmodified.
+    for (CCoinsMap::iterator it = cacheCoins.begin();
+         it != cacheCoins.end();) {
+        if (it->second.coin.IsSpent()) {
+            cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+            it = cacheCoins.erase(it);
+        } else {
+            it->second.flags = 0;
+            ++it;
+        }
+    }
+    return fOk;
+}
+
+void CCoinsViewCache::Trim(size_t max_usage) {
+    const size_t usage = DynamicMemoryUsage();
+    if (usage <= max_usage || cacheCoins.empty()) {
+        return;
+    }
+
+    // Entries are about the same size, so keep as many of them as fit in
+    // max_usage at the average size.
+    const size_t keep_count = cacheCoins.size() * (max_usage / double(usage));
+    size_t evict_count = cacheCoins.size() - keep_count;
+
+    // Find the height under which all the unmodified coins are evicted. Some
+    // of the coins at that height are evicted too if needed.
+    std::vector<uint32_t> heights;
+    for (const auto &[outpoint, entry] : cacheCoins) {
+        if (entry.flags == 0) {
+            heights.push_back(entry.coin.GetHeight());
+        }
+    }
+    evict_count = std::min(evict_count, heights.size());
+    if (evict_count == 0) {
+        return;
+    }
+    std::nth_element(heights.begin(), heights.begin() + evict_count - 1,
+                     heights.end());
+    const uint32_t max_evicted_height = heights[evict_count - 1];
+    size_t evict_at_max_height =
+        evict_count - std::count_if(heights.begin(),
+                                    heights.begin() + evict_count,
+                                    [&](uint32_t height) {
+                                        return height < max_evicted_height;
+                                    });
+    heights.clear();
+    heights.shrink_to_fit();
+
+    // Move the kept entries to a new map and memory resource, so that the
+    // memory of the evicted ones is released.
+    auto resource = std::make_unique<CCoinsMapMemoryResource>();
+    CCoinsMap kept{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{},
+                   resource.get()};
+    kept.reserve(keep_count);
+    for (CCoinsMap::iterator it = cacheCoins.begin();
+         it != cacheCoins.end(); it = cacheCoins.erase(it)) {
+        if (it->second.flags == 0) {
+            const uint32_t height = it->second.coin.GetHeight();
+            if (height < max_evicted_height ||
+                (height == max_evicted_height && evict_at_max_height > 0)) {
+                if (height == max_evicted_height) {
+                    --evict_at_max_height;
+                }
+                cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+                continue;
+            }
+        }
+        kept.emplace(it->first, std::move(it->second));
+    }
+    cacheCoins.~CCoinsMap();
+    m_cache_coins_memory_resource = std::move(resource);
+    ::new (&cacheCoins) CCoinsMap{std::move(kept)};
+}
+
 void CCoinsViewCache::Uncache(const COutPoint &outpoint) {
     CCoinsMap::iterator it = cacheCoins.find(outpoint);
     if (it != cacheCoins.end() && it->second.flags == 0) {
@@ -321,7 +438,20 @@ void CCoinsViewCache::ReallocateCache() {
     // Cache should be empty when we're calling this.
     assert(cacheCoins.size() == 0);
     cacheCoins.~CCoinsMap();
-    ::new (&cacheCoins) CCoinsMap();
+    m_cache_coins_memory_resource = std::make_unique<CCoinsMapMemoryResource>();
+    ::new (&cacheCoins)
+        CCoinsMap{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{},
+                  m_cache_coins_memory_resource.get()};
+}
+
+CCoinsMapContent CCoinsViewCache::TakeCoins() {
+    // The moved map keeps allocating from the moved resource.
+    CCoinsMapContent content{std::move(m_cache_coins_memory_resource),
+                             std::move(cacheCoins), hashBlock};
+    cacheCoins.clear();
+    ReallocateCache();
+    cachedCoinsUsage = 0;
+    return content;
 }
 
 // TODO: merge with similar definition in undo.h.
@@ -6,16 +6,20 @@
 #ifndef BITCOIN_COINS_H
 #define BITCOIN_COINS_H
 
+#include <attributes.h>
 #include <compressor.h>
 #include <memusage.h>
 #include <primitives/blockhash.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <util/hasher.h>
 
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -88,8 +92,11 @@ public:
  *   flushed to the parent)
  */
 struct CCoinsCacheEntry {
-    // The actual cached data.
-    Coin coin;
+    // The actual cached data. The flags are stored in its tail padding, which
+    // makes the entries, and so the nodes of CCoinsMap, 8 bytes smaller on
+    // 64-bit platforms. The coin is not stored compressed, since
+    // CCoinsViewCache::AccessCoin() returns references to it.
+    NO_UNIQUE_ADDRESS Coin coin;
     uint8_t flags;
 
     enum Flags {
@@ -120,8 +127,36 @@ struct CCoinsCacheEntry {
         : coin(std::move(coin_)), flags(flag) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>
-    CCoinsMap;
+/**
+ * The nodes of CCoinsMap are allocated from a PoolResource, which carves them
+ * out of large chunks of memory instead of allocating them one by one. This
+ * saves the per-allocation overhead of malloc and makes the memory usage of the
+ * map an exact count of the chunks.
+ *
+ * PoolAllocator's MAX_BLOCK_SIZE_BYTES parameter here uses sizeof the data,
+ * and adds the size of 4 pointers. We do not know the exact node size used in
+ * the std::unordered_node implementation because it is implementation defined.
+ * Most implementations have an extra pointer, so we use 4 pointers to be on
+ * the safe side.
+ */
+using CCoinsMap = std::unordered_map<
+    COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+    PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                  sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) +
+                      sizeof(void *) * 4>>;
+
+using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
+
+/**
+ * The entries taken out of a CCoinsViewCache by TakeCoins(), together with the
+ * memory resource they are allocated from and the block they are consistent
+ * with.
+ */
+struct CCoinsMapContent {
+    std::unique_ptr<CCoinsMapMemoryResource> resource;
+    CCoinsMap coins;
+    BlockHash hashBlock;
+};
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor {
@@ -167,12 +202,21 @@ public:
     virtual std::vector<BlockHash> GetHeadBlocks() const;
 
     //! Do a bulk modification (multiple Coin changes + BestBlock change).
-    //! The passed mapCoins can be modified.
-    virtual bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock);
+    //! The passed mapCoins can be modified. Its entries are erased as they are
+    //! written, unless erase is false, in which case they are left unchanged.
+    virtual bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                            bool erase = true);
 
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
 
+    //! Get up to `count` cursors which iterate over consecutive, disjoint
+    //! ranges of txids covering the whole state, so that the state can be
+    //! processed in parallel. All the outputs of a transaction are in the same
+    //! range. Views which can't be split return a single cursor.
+    virtual std::vector<std::unique_ptr<CCoinsViewCursor>>
+    RangeCursors(size_t count) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() {}
 
@@ -192,8 +236,11 @@ public:
     BlockHash GetBestBlock() const override;
     std::vector<BlockHash> GetHeadBlocks() const override;
     void SetBackend(CCoinsView &viewIn);
-    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase = true) override;
     CCoinsViewCursor *Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    RangeCursors(size_t count) const override;
     size_t EstimateSize() const override;
 };
 
@@ -207,6 +254,8 @@ protected:
      * declared as "const".
      */
     mutable BlockHash hashBlock;
+    std::unique_ptr<CCoinsMapMemoryResource> m_cache_coins_memory_resource{
+        std::make_unique<CCoinsMapMemoryResource>()};
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -226,7 +275,8 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     BlockHash GetBestBlock() const override;
     void SetBestBlock(const BlockHash &hashBlock);
-    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase = true) override;
     CCoinsViewCursor *Cursor() const override {
         throw std::logic_error(
             "CCoinsViewCache cursor iteration not supported.");
@@ -266,6 +316,13 @@ public:
      */
     void EmplaceCoinInternalDANGER(COutPoint &&outpoint, Coin &&coin);
 
+    /**
+     * Insert an unspent coin that was read from the backing view, as a cache
+     * miss would, unless the outpoint is already cached. The coin must still
+     * be up to date in the backing view.
+     */
+    void EmplaceCoinFromBase(const COutPoint &outpoint, Coin &&coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call has no
@@ -281,6 +338,20 @@ public:
      */
     bool Flush();
 
+    /**
+     * Push the modifications applied to this cache to its base, like Flush(),
+     * but keep the unspent coins cached, as unmodified entries. The spent
+     * coins are removed from the cache.
+     */
+    bool Sync();
+
+    /**
+     * Remove unmodified entries from the cache, those of the coins created at
+     * the lowest heights first, until it uses no more than max_usage bytes,
+     * and release the memory they used. Modified entries are never removed.
+     */
+    void Trim(size_t max_usage);
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is not
      * modified.
@@ -299,12 +370,21 @@ public:
 
     //! Force a reallocation of the cache map. This is required when downsizing
     //! the cache because the map's allocator may be hanging onto a lot of
-    //! memory despite having called .clear().
+    //! memory despite having called .clear(). The memory resource holds on to
+    //! the nodes of the erased entries as well, so it is reallocated too.
     //!
     //! See:
     //! https://stackoverflow.com/questions/42114044/how-to-release-unordered-map-memory
     void ReallocateCache();
 
+    /**
+     * Move all the entries out of the cache, so that they can be written to
+     * the backing view by the caller, and leave the cache empty. Unlike
+     * Flush(), the backing view doesn't see the entries until the caller
+     * writes them, so it must be able to serve them in the meantime.
+     */
+    CCoinsMapContent TakeCoins();
+
 private:
     /**
      * @note this is marked const, but may actually append to `cacheCoins`,
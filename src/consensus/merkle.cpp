@@ -66,6 +66,21 @@ uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool *mutated) {
     return hashes[0];
 }
 
+uint256 ComputeMerkleSubtreeRoot(std::vector<uint256> hashes, int height,
+                                 bool *mutated) {
+    int levels = 0;
+    while ((size_t(1) << levels) < hashes.size()) {
+        levels++;
+    }
+    uint256 root = ComputeMerkleRoot(std::move(hashes), mutated);
+    // If the last subtree has fewer leaves, its root gets duplicated until it
+    // reaches the height of the other subtrees. This is not a mutation.
+    for (; levels < height; levels++) {
+        root = Hash(root, root);
+    }
+    return root;
+}
+
 uint256 BlockMerkleRoot(const CBlock &block, bool *mutated) {
     std::vector<uint256> leaves;
     leaves.resize(block.vtx.size());
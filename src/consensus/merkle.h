@@ -12,6 +12,17 @@
 
 uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool *mutated = nullptr);
 
+/**
+ * Compute the root of a subtree of the given height of a merkle tree, from the
+ * hashes of its leaves. Only the last subtree of a tree may have less than
+ * 2^height leaves.
+ * Applying ComputeMerkleRoot to the roots of all the subtrees of a tree gives
+ * the root of the tree, and it is mutated if and only if a subtree or the tree
+ * formed by the subtrees roots is mutated.
+ */
+uint256 ComputeMerkleSubtreeRoot(std::vector<uint256> hashes, int height,
+                                 bool *mutated = nullptr);
+
 /**
  * Compute the Merkle root of the transactions in a block.
  * *mutated is set to true if a duplicated subtree was found.
@@ -165,20 +165,17 @@ bool SequenceLocks(const CTransaction &tx, int flags,
 }
 
 namespace Consensus {
-bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
-                   const CCoinsViewCache &inputs, int nSpendHeight,
-                   Amount &txfee) {
-    // are the actual inputs available?
-    if (!inputs.HaveInputs(tx)) {
-        return state.Invalid(TxValidationResult::TX_MISSING_INPUTS,
-                             "bad-txns-inputs-missingorspent",
-                             strprintf("%s: inputs missing/spent", __func__));
-    }
-
+/**
+ * Shared implementation of CheckTxInputs. GetCoin(i) must return the unspent
+ * coin spent by the i-th input of tx.
+ */
+template <typename GetCoinFn>
+static bool CheckTxInputValues(const CTransaction &tx,
+                               TxValidationState &state, int nSpendHeight,
+                               Amount &txfee, GetCoinFn &&GetCoin) {
     Amount nValueIn = Amount::zero();
-    for (const auto &in : tx.vin) {
-        const COutPoint &prevout = in.prevout;
-        const Coin &coin = inputs.AccessCoin(prevout);
+    for (size_t i = 0; i < tx.vin.size(); i++) {
+        const Coin &coin = GetCoin(i);
         assert(!coin.IsSpent());
 
         // If prev is coinbase, check that it's matured
@@ -217,4 +214,29 @@ bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
     txfee = txfee_aux;
     return true;
 }
+
+bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
+                   const CCoinsViewCache &inputs, int nSpendHeight,
+                   Amount &txfee) {
+    // are the actual inputs available?
+    if (!inputs.HaveInputs(tx)) {
+        return state.Invalid(TxValidationResult::TX_MISSING_INPUTS,
+                             "bad-txns-inputs-missingorspent",
+                             strprintf("%s: inputs missing/spent", __func__));
+    }
+
+    return CheckTxInputValues(
+        tx, state, nSpendHeight, txfee, [&](size_t i) -> const Coin & {
+            return inputs.AccessCoin(tx.vin[i].prevout);
+        });
+}
+
+bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
+                   const std::vector<Coin> &spent_coins, int nSpendHeight,
+                   Amount &txfee) {
+    assert(spent_coins.size() == tx.vin.size());
+    return CheckTxInputValues(
+        tx, state, nSpendHeight, txfee,
+        [&](size_t i) -> const Coin & { return spent_coins[i]; });
+}
 } // namespace Consensus
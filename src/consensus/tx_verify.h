@@ -11,6 +11,7 @@
 struct Amount;
 class CBlockIndex;
 class CCoinsViewCache;
+class Coin;
 class CTransaction;
 class TxValidationState;
 
@@ -28,6 +29,16 @@ bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
                    const CCoinsViewCache &inputs, int nSpendHeight,
                    Amount &txfee);
 
+/**
+ * Same as above, but takes the coins spent by the transaction directly, in
+ * the order of tx.vin, instead of looking them up in a view. This does not
+ * check for missing or double spent inputs, which is left to the caller.
+ * Unlike the view based variant, this is safe to call concurrently.
+ */
+bool CheckTxInputs(const CTransaction &tx, TxValidationState &state,
+                   const std::vector<Coin> &spent_coins, int nSpendHeight,
+                   Amount &txfee);
+
 } // namespace Consensus
 
 /**
@@ -14,12 +14,14 @@
 #include <uint256.h>
 
 #include <cstdint>
+#include <string>
 
 class Num3072 {
 private:
     void FullReduce();
     bool IsOverflow() const;
     Num3072 GetInverse() const;
+    bool MultiplyAccelerated(const Num3072 &a);
 
 public:
     static constexpr size_t BYTE_SIZE = 384;
@@ -63,6 +65,13 @@ public:
     }
 };
 
+/**
+ * Autodetect the best available Num3072 multiplication implementation.
+ * Returns the name of the implementation. If use_accelerated is false, the
+ * portable implementation is selected, which is used for testing.
+ */
+std::string MuHash3072AutoDetect(bool use_accelerated = true);
+
 /**
  * A class representing MuHash sets
  *
@@ -0,0 +1,58 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// Multiplication of 3072-bit numbers using the BMI2 and ADX instructions.
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__amd64__)
+
+namespace muhash_adx {
+/**
+ * Compute the 6144-bit product out[0..95] = a[0..47] * b[0..47]. The CPU must
+ * support BMI2 and ADX.
+ *
+ * Each row adds a[i] * b to the partial product. The low halves of the limb
+ * products are accumulated with adcx, which only uses the carry flag, while
+ * the high halves are accumulated with adox, which only uses the overflow
+ * flag, so both carry chains run interleaved without saving the flags.
+ */
+void Multiply(uint64_t *out, const uint64_t *a, const uint64_t *b) {
+    for (int i = 0; i < 96; ++i) {
+        out[i] = 0;
+    }
+
+    for (int i = 0; i < 48; ++i) {
+        uint64_t *t = out + i;
+        __asm__ __volatile__(
+            "xorl %%r10d, %%r10d\n"
+            "xorl %%r11d, %%r11d\n"
+            // Also clears CF and OF.
+            "xorl %%r8d, %%r8d\n"
+            ".set muhash_adx_offset, 0\n"
+            ".rept 24\n"
+            "mulx muhash_adx_offset(%[b]), %%r9, %%r10\n"
+            "adcx muhash_adx_offset(%[t]), %%r9\n"
+            "adox %%r11, %%r9\n"
+            "movq %%r9, muhash_adx_offset(%[t])\n"
+            ".set muhash_adx_offset, muhash_adx_offset + 8\n"
+            "mulx muhash_adx_offset(%[b]), %%r9, %%r11\n"
+            "adcx muhash_adx_offset(%[t]), %%r9\n"
+            "adox %%r10, %%r9\n"
+            "movq %%r9, muhash_adx_offset(%[t])\n"
+            ".set muhash_adx_offset, muhash_adx_offset + 8\n"
+            ".endr\n"
+            // The top limb of this row was still zero. Adding both carries to
+            // the high half of the last product cannot overflow.
+            "adcx %%r8, %%r11\n"
+            "adox %%r8, %%r11\n"
+            "movq %%r11, muhash_adx_offset(%[t])\n"
+            :
+            : [t] "r"(t), [b] "r"(b), "d"(a[i])
+            : "r8", "r9", "r10", "r11", "cc", "memory");
+    }
+}
+} // namespace muhash_adx
+
+#endif
@@ -522,6 +522,20 @@ public:
         return false;
     }
 
+    /**
+     * for_each calls `fn` on every element of the table that is not marked
+     * for erasure, in table order. Not threadsafe with concurrent insert.
+     *
+     * @param fn The function to call with each `const Element &`
+     */
+    template <typename F> void for_each(F fn) const {
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!collection_flags.bit_is_set(i)) {
+                fn(table[i]);
+            }
+        }
+    }
+
 private:
     const Element *find(const Key &k, const bool erase) const {
         std::array<uint32_t, 8> locs = compute_hashes(k);
@@ -16,7 +16,9 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <memory>
 #include <optional>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
@@ -308,6 +310,25 @@ public:
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
     }
 
+    /**
+     * Create `count` iterators which all see the same state of the database,
+     * even if it is written to while they are being created.
+     */
+    std::vector<std::unique_ptr<CDBIterator>> NewIterators(size_t count) {
+        leveldb::ReadOptions options{iteroptions};
+        options.snapshot = pdb->GetSnapshot();
+        std::vector<std::unique_ptr<CDBIterator>> iterators;
+        iterators.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            iterators.push_back(std::make_unique<CDBIterator>(
+                *this, pdb->NewIterator(options)));
+        }
+        // The iterators pin the state they see, so the snapshot is no longer
+        // needed once they are created.
+        pdb->ReleaseSnapshot(options.snapshot);
+        return iterators;
+    }
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
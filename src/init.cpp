@@ -43,6 +43,7 @@
 #include <node/blockstorage.h>
 #include <node/caches.h>
 #include <node/chainstate.h>
+#include <node/coinsprefetcher.h>
 #include <node/context.h>
 #include <node/miner.h>
 #include <node/ui_interface.h>
@@ -243,6 +244,9 @@ void Shutdown(NodeContext &node) {
     if (node.peerman) {
         UnregisterValidationInterface(node.peerman.get());
     }
+    if (node.block_template_selection) {
+        UnregisterValidationInterface(node.block_template_selection.get());
+    }
     if (node.connman) {
         node.connman->Stop();
     }
@@ -262,6 +266,7 @@ void Shutdown(NodeContext &node) {
     // After the threads that potentially access these pointers have been
     // stopped, destruct and reset all to nullptr.
     node.peerman.reset();
+    node.block_template_selection.reset();
 
     // Destroy various global instances
     g_avalanche.reset();
@@ -274,6 +279,11 @@ void Shutdown(NodeContext &node) {
         DumpMempool(*node.mempool);
     }
 
+    if (node.args->GetBoolArg("-persistsigcache", DEFAULT_PERSIST_SIGCACHE)) {
+        DumpSignatureCache();
+        DumpScriptExecutionCache();
+    }
+
     // FlushStateToDisk generates a ChainStateFlushed callback, which we should
     // avoid missing
     if (node.chainman) {
@@ -319,6 +329,10 @@ void Shutdown(NodeContext &node) {
                 chainstate->ResetCoinsViews();
             }
         }
+        if (node.args->GetBoolArg("-persistblockindex",
+                                  node::DEFAULT_PERSIST_BLOCK_INDEX)) {
+            node.chainman->m_blockman.WriteBlockIndexSnapshot();
+        }
     }
     for (const auto &client : node.chain_clients) {
         client->stop();
@@ -540,6 +554,11 @@ void SetupServerArgs(NodeContext &node) {
                              "memory (default: %u)",
                              DEFAULT_MAX_ORPHAN_TRANSACTIONS),
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxorphantxsize=<n>",
+                   strprintf("Keep the unconnectable transactions in memory "
+                             "below <n> megabytes (default: %u)",
+                             DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-mempoolexpiry=<n>",
                    strprintf("Do not keep transactions in the mempool longer "
                              "than <n> hours (default: %u)",
@@ -561,11 +580,46 @@ void SetupServerArgs(NodeContext &node) {
                   -GetNumCores(), MAX_SCRIPTCHECK_THREADS,
                   DEFAULT_SCRIPTCHECK_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-parallelconnect",
+        strprintf("Check the transactions of a block against the coins they "
+                  "spend on the script verification threads when connecting "
+                  "it (default: %u)",
+                  DEFAULT_PARALLEL_CONNECT),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-backgroundflush",
+        strprintf("Write the coins cache to disk on a background thread when "
+                  "it is full, so that validation can go on meanwhile. The "
+                  "memory used by the cache can temporarily reach twice "
+                  "-dbcache (default: %u)",
+                  DEFAULT_BACKGROUND_FLUSH),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-prefetchblocks=<n>",
+        strprintf("During initial block download, read the next <n> blocks "
+                  "from disk and the coins they spend from the database in "
+                  "the background (0 to %d, default: %d)",
+                  node::MAX_PREFETCH_BLOCKS, node::DEFAULT_PREFETCH_BLOCKS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool",
                    strprintf("Whether to save the mempool on shutdown and load "
                              "on restart (default: %u)",
                              DEFAULT_PERSIST_MEMPOOL),
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-persistblockindex",
+        strprintf("Whether to save a snapshot of the block index on shutdown, "
+                  "which is loaded on restart instead of reading the block "
+                  "index database (default: %u)",
+                  node::DEFAULT_PERSIST_BLOCK_INDEX),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-persistsigcache",
+                   strprintf("Whether to save the signature and script "
+                             "execution caches on shutdown and load them on "
+                             "restart (default: %u)",
+                             DEFAULT_PERSIST_SIGCACHE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg(
         "-pid=<file>",
         strprintf("Specify pid file. Relative paths will be prefixed "
@@ -596,6 +650,14 @@ void SetupServerArgs(NodeContext &node) {
         "-reindex",
         "Rebuild chain state and block index from the blk*.dat files on disk",
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-reindexthreads=<n>",
+        strprintf("During -reindex, read and check up to <n> block files in "
+                  "parallel ahead of adding their blocks to the block index. "
+                  "The blocks of these files are held in memory meanwhile "
+                  "(0 to %d, default: %d)",
+                  node::MAX_REINDEX_THREADS, node::DEFAULT_REINDEX_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg(
         "-settings=<file>",
         strprintf(
@@ -1013,6 +1075,14 @@ void SetupServerArgs(NodeContext &node) {
                              Join(CHECKLEVEL_DOC, ", "), DEFAULT_CHECKLEVEL),
                    ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY,
                    OptionsCategory::DEBUG_TEST);
+    argsman.AddArg(
+        "-checkblocksthreads=<n>",
+        strprintf("Read and check up to <n> of the blocks verified by "
+                  "-checkblocks in parallel, ahead of the disconnection and "
+                  "reconnection of checklevels 3 and 4 (0 to %d, default: %d)",
+                  MAX_CHECKBLOCKS_THREADS, DEFAULT_CHECKBLOCKS_THREADS),
+        ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY,
+        OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkblockindex",
                    strprintf("Do a consistency check for the block tree, "
                              "chainstate, and other validation data structures "
@@ -1846,6 +1916,14 @@ bool AppInitParameterInteraction(Config &config, const ArgsManager &args) {
                                        chainparams.DefaultConsistencyChecks());
     fCheckpointsEnabled =
         args.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
+    g_parallel_connect =
+        args.GetBoolArg("-parallelconnect", DEFAULT_PARALLEL_CONNECT);
+    g_background_flush =
+        args.GetBoolArg("-backgroundflush", DEFAULT_BACKGROUND_FLUSH);
+    g_prefetch_blocks =
+        std::clamp<int>(args.GetIntArg("-prefetchblocks",
+                                       node::DEFAULT_PREFETCH_BLOCKS),
+                        0, node::MAX_PREFETCH_BLOCKS);
     if (fCheckpointsEnabled) {
         LogPrintf("Checkpoints will be verified.\n");
     } else {
@@ -2147,6 +2225,10 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    if (args.GetBoolArg("-persistsigcache", DEFAULT_PERSIST_SIGCACHE)) {
+        LoadSignatureCache();
+        LoadScriptExecutionCache();
+    }
 
     int script_threads = args.GetIntArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
     if (script_threads <= 0) {
@@ -2469,6 +2551,9 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         options.check_blocks =
             args.GetIntArg("-checkblocks", DEFAULT_CHECKBLOCKS);
         options.check_level = args.GetIntArg("-checklevel", DEFAULT_CHECKLEVEL);
+        options.check_threads = std::clamp<int>(
+            args.GetIntArg("-checkblocksthreads", DEFAULT_CHECKBLOCKS_THREADS),
+            0, MAX_CHECKBLOCKS_THREADS);
         options.require_full_verification =
             args.IsArgSet("-checkblocks") || args.IsArgSet("-checklevel");
         options.check_interrupt = ShutdownRequested;
@@ -2557,6 +2642,12 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         *node.mempool, args.GetBoolArg("-blocksonly", DEFAULT_BLOCKSONLY));
     RegisterValidationInterface(node.peerman.get());
 
+    // Keep the transactions selected for getblocktemplate up to date with the
+    // mempool.
+    node.block_template_selection =
+        std::make_unique<node::BlockTemplateSelection>(*node.mempool);
+    RegisterValidationInterface(node.block_template_selection.get());
+
     // Encoded addresses using cashaddr instead of base58.
     // We do this by default to avoid confusion with BTC addresses.
     config.SetCashAddrEncoding(args.GetBoolArg("-usecashaddr", true));
@@ -8,6 +8,7 @@
 
 #include <clientversion.h>
 #include <compat/sanity.h>
+#include <crypto/muhash.h>
 #include <crypto/sha256.h>
 #include <key.h>
 #include <logging.h>
@@ -29,6 +30,8 @@ namespace init {
 void SetGlobals() {
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    std::string muhash_algo = MuHash3072AutoDetect();
+    LogPrintf("Using the '%s' MuHash implementation\n", muhash_algo);
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
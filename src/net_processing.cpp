@@ -53,6 +53,7 @@
 #include <chrono>
 #include <functional>
 #include <future>
+#include <limits>
 #include <memory>
 #include <typeinfo>
 
@@ -5357,7 +5358,17 @@ void PeerManagerImpl::ProcessMessage(
                     int64_t(0),
                     gArgs.GetIntArg("-maxorphantx",
                                     DEFAULT_MAX_ORPHAN_TRANSACTIONS));
-                unsigned int nEvicted = m_orphanage.LimitOrphans(nMaxOrphanTx);
+                // Clamp the size in megabytes so that it doesn't overflow
+                // once converted to bytes.
+                size_t nMaxOrphanTxSize =
+                    size_t(std::clamp<int64_t>(
+                        gArgs.GetIntArg("-maxorphantxsize",
+                                        DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE),
+                        0,
+                        std::numeric_limits<size_t>::max() / 1000000)) *
+                    1000000;
+                unsigned int nEvicted =
+                    m_orphanage.LimitOrphans(nMaxOrphanTx, nMaxOrphanTxSize);
                 if (nEvicted > 0) {
                     LogPrint(BCLog::MEMPOOL,
                              "orphanage overflow, removed %u tx\n", nEvicted);
@@ -6272,6 +6283,7 @@ void PeerManagerImpl::ProcessMessage(
                         if (it.has_value()) {
                             m_mempool.removeRecursive(
                                 *tx, MemPoolRemovalReason::AVALANCHE);
+                            m_mempool.PublishSnapshot();
                         }
 
                         break;
@@ -24,6 +24,11 @@ class Config;
  * memory.
  */
 static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS = 100;
+/**
+ * Default for -maxorphantxsize, maximum total size in megabytes of the orphan
+ * transactions kept in memory.
+ */
+static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE = 5;
 /**
  * Default number of orphan+recently-replaced txn to keep around for block
  * reconstruction.
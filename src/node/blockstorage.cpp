@@ -19,8 +19,12 @@
 #include <streams.h>
 #include <undo.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <deque>
+#include <future>
 #include <map>
 
 namespace node {
@@ -242,19 +246,197 @@ CBlockIndex *BlockManager::InsertBlockIndex(const BlockHash &hash) {
     return pindex;
 }
 
-bool BlockManager::LoadBlockIndex(const Consensus::Params &params) {
+/** Version of the block index snapshot written at shutdown. */
+static constexpr uint64_t BLOCK_INDEX_SNAPSHOT_VERSION{1};
+
+static fs::path GetBlockIndexSnapshotPath() {
+    return gArgs.GetBlocksDirPath() / "index.dat";
+}
+
+/**
+ * Identify the state of the block files recorded in the block tree database,
+ * which changes whenever a block is stored. It is recorded in the snapshot as
+ * a further check that the snapshot matches the database.
+ */
+static uint256 GetBlockFilesFingerprint(CBlockTreeDB &block_tree_db) {
+    int last_file{0};
+    block_tree_db.ReadLastBlockFile(last_file);
+    CBlockFileInfo info;
+    block_tree_db.ReadBlockFileInfo(last_file, info);
+    CHashWriter hasher(SER_GETHASH, 0);
+    hasher << last_file << info;
+    return hasher.GetHash();
+}
+
+bool BlockManager::LoadBlockIndexSnapshot(
+    const Consensus::Params &params,
+    std::vector<CBlockIndex *> &sorted_by_height) {
     AssertLockHeld(cs_main);
-    if (!m_block_tree_db->LoadBlockIndexGuts(
-            params, [this](const BlockHash &hash) EXCLUSIVE_LOCKS_REQUIRED(
-                        cs_main) { return this->InsertBlockIndex(hash); })) {
+    uint256 expected_hash;
+    if (!m_block_index.empty() ||
+        !m_block_tree_db->ReadBlockIndexSnapshotHash(expected_hash)) {
+        return false;
+    }
+    // The snapshot only matches the database until the block index is
+    // modified, which may happen as soon as it is loaded.
+    if (!m_block_tree_db->EraseBlockIndexSnapshotHash()) {
         return false;
     }
 
-    // Calculate nChainWork
-    std::vector<CBlockIndex *> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open block index snapshot %s\n",
+                  fs::PathToString(path));
+        return false;
+    }
+
+    try {
+        std::vector<uint8_t> data(fs::file_size(path));
+        file.read(reinterpret_cast<char *>(data.data()), data.size());
+        if (Hash(data) != expected_hash) {
+            LogPrintf("Block index snapshot %s doesn't match the block index "
+                      "database, ignoring it\n",
+                      fs::PathToString(path));
+            return false;
+        }
+
+        VectorReader reader(SER_DISK, CLIENT_VERSION, data, 0);
+        uint64_t version;
+        int client_version;
+        uint256 fingerprint;
+        uint64_t count;
+        reader >> version >> client_version >> fingerprint >> count;
+        if (version != BLOCK_INDEX_SNAPSHOT_VERSION ||
+            client_version != CLIENT_VERSION ||
+            fingerprint != GetBlockFilesFingerprint(*m_block_tree_db)) {
+            LogPrintf("Block index snapshot %s is outdated, ignoring it\n",
+                      fs::PathToString(path));
+            return false;
+        }
+
+        // The entries are sorted by height, so the parent of each entry is
+        // already loaded.
+        m_block_index.reserve(count);
+        sorted_by_height.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            BlockHash hash;
+            CDiskBlockIndex diskindex;
+            reader >> hash >> diskindex;
+
+            CBlockIndex *pindexNew = InsertBlockIndex(hash);
+            if (!diskindex.hashPrev.IsNull()) {
+                pindexNew->pprev = LookupBlockIndex(diskindex.hashPrev);
+                if (!pindexNew->pprev) {
+                    throw std::runtime_error("missing parent block");
+                }
+            }
+            pindexNew->nHeight = diskindex.nHeight;
+            pindexNew->nFile = diskindex.nFile;
+            pindexNew->nDataPos = diskindex.nDataPos;
+            pindexNew->nUndoPos = diskindex.nUndoPos;
+            pindexNew->nVersion = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime = diskindex.nTime;
+            pindexNew->nBits = diskindex.nBits;
+            pindexNew->nNonce = diskindex.nNonce;
+            pindexNew->nStatus = diskindex.nStatus;
+            pindexNew->nTx = diskindex.nTx;
+
+            if (!CheckProofOfWork(hash, pindexNew->nBits, params)) {
+                throw std::runtime_error("CheckProofOfWork failed");
+            }
+            sorted_by_height.push_back(pindexNew);
+        }
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to load block index snapshot %s: %s\n",
+                  fs::PathToString(path), e.what());
+        m_block_index.clear();
+        sorted_by_height.clear();
+        return false;
+    }
+
+    LogPrintf("Loaded %u block index entries from %s\n",
+              sorted_by_height.size(), fs::PathToString(path));
+    return true;
+}
+
+bool BlockManager::WriteBlockIndexSnapshot() {
+    AssertLockHeld(cs_main);
+    if (!m_block_index_loaded) {
+        // Don't replace the block index with an incomplete one.
+        return false;
+    }
+
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    try {
+        // The snapshot has to match the database, so write the pending
+        // changes first.
+        {
+            LOCK(cs_LastBlockFile);
+            if (!WriteBlockIndexDB()) {
+                throw std::runtime_error("failed to write block index");
+            }
+        }
+
+        std::vector<CBlockIndex *> sorted_by_height{GetAllBlockIndices()};
+        std::sort(sorted_by_height.begin(), sorted_by_height.end(),
+                  CBlockIndexHeightOnlyComparator());
+
+        std::vector<uint8_t> data;
+        CVectorWriter writer(SER_DISK, CLIENT_VERSION, data, 0);
+        writer << BLOCK_INDEX_SNAPSHOT_VERSION << CLIENT_VERSION
+               << GetBlockFilesFingerprint(*m_block_tree_db)
+               << uint64_t(sorted_by_height.size());
+        for (const CBlockIndex *pindex : sorted_by_height) {
+            writer << pindex->GetBlockHash() << CDiskBlockIndex(pindex);
+        }
+
+        const fs::path tmp_path{gArgs.GetBlocksDirPath() / "index.dat.new"};
+        CAutoFile file(fsbridge::fopen(tmp_path, "wb"), SER_DISK,
+                       CLIENT_VERSION);
+        if (file.IsNull()) {
+            throw std::runtime_error("failed to open file");
+        }
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(tmp_path, path)) {
+            throw std::runtime_error("Rename failed");
+        }
+        if (!m_block_tree_db->WriteBlockIndexSnapshotHash(Hash(data))) {
+            throw std::runtime_error("failed to write snapshot hash");
+        }
+        LogPrintf("Wrote %u block index entries to %s\n",
+                  sorted_by_height.size(), fs::PathToString(path));
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to write block index snapshot %s: %s. Continuing "
+                  "anyway.\n",
+                  fs::PathToString(path), e.what());
+        return false;
+    }
+    return true;
+}
+
+bool BlockManager::LoadBlockIndex(const Consensus::Params &params) {
+    AssertLockHeld(cs_main);
+    std::vector<CBlockIndex *> vSortedByHeight;
+    if (!LoadBlockIndexSnapshot(params, vSortedByHeight)) {
+        if (!m_block_tree_db->LoadBlockIndexGuts(
+                params,
+                [this](const BlockHash &hash) EXCLUSIVE_LOCKS_REQUIRED(
+                    cs_main) { return this->InsertBlockIndex(hash); })) {
+            return false;
+        }
+
+        vSortedByHeight = GetAllBlockIndices();
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+                  CBlockIndexHeightOnlyComparator());
+    }
 
+    // Calculate nChainWork
     for (CBlockIndex *pindex : vSortedByHeight) {
         if (ShutdownRequested()) {
             return false;
@@ -364,6 +546,7 @@ bool BlockManager::LoadBlockIndexDB(const Consensus::Params &consensus_params) {
         fReindex = true;
     }
 
+    m_block_index_loaded = true;
     return true;
 }
 
@@ -475,9 +658,8 @@ static bool UndoWriteToDisk(const CBlockUndo &blockundo, FlatFilePos &pos,
     return true;
 }
 
-bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
-    const FlatFilePos pos{WITH_LOCK(::cs_main, return pindex->GetUndoPos())};
-
+bool UndoReadFromDisk(CBlockUndo &blockundo, const FlatFilePos &pos,
+                      const BlockHash &hashPrevBlock) {
     if (pos.IsNull()) {
         return error("%s: no undo data available", __func__);
     }
@@ -493,7 +675,7 @@ bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
     // We need a CHashVerifier as reserializing may lose data
     CHashVerifier<CAutoFile> verifier(&filein);
     try {
-        verifier << pindex->pprev->GetBlockHash();
+        verifier << hashPrevBlock;
         verifier >> blockundo;
         filein >> hashChecksum;
     } catch (const std::exception &e) {
@@ -508,6 +690,11 @@ bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
     return true;
 }
 
+bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
+    const FlatFilePos pos{WITH_LOCK(::cs_main, return pindex->GetUndoPos())};
+    return UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash());
+}
+
 void BlockManager::FlushUndoFile(int block_file, bool finalize) {
     FlatFilePos undo_pos_old(block_file,
                              m_blockfile_info[block_file].nUndoSize);
@@ -869,6 +1056,75 @@ struct CImportingNow {
     }
 };
 
+/**
+ * Import the block files for -reindex, in order. With threads_num > 0, up to
+ * threads_num files are read ahead of time on their own thread.
+ *
+ * @returns false if a shutdown was requested
+ */
+static bool ReindexBlockFiles(const Config &config,
+                              ChainstateManager &chainman, int threads_num) {
+    // Map of disk positions for blocks with unknown parent (only used for
+    // reindex); parent hash -> child disk position, multiple children can
+    // have the same parent.
+    std::multimap<BlockHash, FlatFilePos> blocks_with_unknown_parent;
+    // The files being read ahead of time, in file order.
+    std::deque<std::future<std::vector<ExternalBlock>>> pending_reads;
+    int nFileRead = 0;
+    for (int nFile = 0;; nFile++) {
+        for (; threads_num > 0 && nFileRead < nFile + threads_num;
+             nFileRead++) {
+            FlatFilePos pos(nFileRead, 0);
+            if (!fs::exists(GetBlockPosFilename(pos))) {
+                break;
+            }
+            FILE *file = OpenBlockFile(pos, true);
+            if (!file) {
+                // This error is logged in OpenBlockFile
+                break;
+            }
+            pending_reads.push_back(std::async(
+                std::launch::async, [&config, file, n = nFileRead]() {
+                    util::ThreadRename(strprintf("reindex.%i", n));
+                    return ReadBlockFile(config, file, n);
+                }));
+        }
+
+        if (threads_num > 0) {
+            if (pending_reads.empty()) {
+                // No block files left to reindex
+                break;
+            }
+            LogPrintf("Reindexing block file blk%05u.dat...\n",
+                      (unsigned int)nFile);
+            std::vector<ExternalBlock> blocks = pending_reads.front().get();
+            pending_reads.pop_front();
+            chainman.ActiveChainstate().LoadExternalBlocks(
+                config, std::move(blocks), blocks_with_unknown_parent);
+        } else {
+            FlatFilePos pos(nFile, 0);
+            if (!fs::exists(GetBlockPosFilename(pos))) {
+                // No block files left to reindex
+                break;
+            }
+            FILE *file = OpenBlockFile(pos, true);
+            if (!file) {
+                // This error is logged in OpenBlockFile
+                break;
+            }
+            LogPrintf("Reindexing block file blk%05u.dat...\n",
+                      (unsigned int)nFile);
+            chainman.ActiveChainstate().LoadExternalBlockFile(
+                config, file, &pos, &blocks_with_unknown_parent);
+        }
+        if (ShutdownRequested()) {
+            // The pending reads stop early as well.
+            return false;
+        }
+    }
+    return true;
+}
+
 void ThreadImport(const Config &config, ChainstateManager &chainman,
                   std::vector<fs::path> vImportFiles, const ArgsManager &args) {
     ScheduleBatchPriority();
@@ -880,31 +1136,12 @@ void ThreadImport(const Config &config, ChainstateManager &chainman,
 
         // -reindex
         if (fReindex) {
-            int nFile = 0;
-            // Map of disk positions for blocks with unknown parent (only used
-            // for reindex);  parent hash -> child disk position, multiple
-            // children can have the same parent.
-            std::multimap<BlockHash, FlatFilePos> blocks_with_unknown_parent;
-            while (true) {
-                FlatFilePos pos(nFile, 0);
-                if (!fs::exists(GetBlockPosFilename(pos))) {
-                    // No block files left to reindex
-                    break;
-                }
-                FILE *file = OpenBlockFile(pos, true);
-                if (!file) {
-                    // This error is logged in OpenBlockFile
-                    break;
-                }
-                LogPrintf("Reindexing block file blk%05u.dat...\n",
-                          (unsigned int)nFile);
-                chainman.ActiveChainstate().LoadExternalBlockFile(
-                    config, file, &pos, &blocks_with_unknown_parent);
-                if (ShutdownRequested()) {
-                    LogPrintf("Shutdown requested. Exit %s\n", __func__);
-                    return;
-                }
-                nFile++;
+            const int threads_num = std::clamp<int>(
+                args.GetIntArg("-reindexthreads", DEFAULT_REINDEX_THREADS), 0,
+                MAX_REINDEX_THREADS);
+            if (!ReindexBlockFiles(config, chainman, threads_num)) {
+                LogPrintf("Shutdown requested. Exit %s\n", __func__);
+                return;
             }
             WITH_LOCK(
                 ::cs_main,
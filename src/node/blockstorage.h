@@ -6,11 +6,14 @@
 #define BITCOIN_NODE_BLOCKSTORAGE_H
 
 #include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
 #include <chain.h>
 #include <fs.h>
 #include <protocol.h> // For CMessageHeader::MessageStartChars
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <txdb.h>
 
@@ -36,6 +39,16 @@ struct Params;
 
 namespace node {
 static constexpr bool DEFAULT_STOPAFTERBLOCKIMPORT{false};
+/** Default for -reindexthreads */
+static constexpr int DEFAULT_REINDEX_THREADS{0};
+/**
+ * Maximum number of block files read ahead of time during a reindex. Each of
+ * them is held in memory as deserialized blocks, up to a few times the 128 MiB
+ * of the file, until its blocks are added to the block index.
+ */
+static constexpr int MAX_REINDEX_THREADS{8};
+/** Default for -persistblockindex */
+static constexpr bool DEFAULT_PERSIST_BLOCK_INDEX{true};
 
 /** The pre-allocation chunk size for blk?????.dat files (since 0.8) */
 static constexpr unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
@@ -57,7 +70,27 @@ extern uint64_t nPruneTarget;
 // we ever switch to another associative container, we need to either use a
 // container that has stable addressing (true of all std associative
 // containers), or make the key a `std::unique_ptr<CBlockIndex>`
-using BlockMap = std::unordered_map<BlockHash, CBlockIndex, BlockHasher>;
+//
+// The nodes are allocated from a PoolResource, like those of CCoinsMap, so
+// that the block index entries are packed next to each other in large chunks
+// of memory instead of being scattered over the heap. Entries that are inserted
+// one after the other, e.g. in height order when loading the block index
+// snapshot or when syncing headers, end up next to each other, which keeps
+// walks along pprev and pskip within few cache lines and pages.
+using BlockMap = std::unordered_map<
+    BlockHash, CBlockIndex, BlockHasher, std::equal_to<BlockHash>,
+    PoolAllocator<std::pair<const BlockHash, CBlockIndex>,
+                  sizeof(std::pair<const BlockHash, CBlockIndex>) +
+                      sizeof(void *) * 4>>;
+
+using BlockMapMemoryResource = BlockMap::allocator_type::ResourceType;
+
+/**
+ * Size of the chunks the block index entries are allocated from. It is larger
+ * than the default of PoolResource because the block index only grows, and
+ * holds about a million entries on mainnet.
+ */
+static constexpr size_t BLOCK_INDEX_CHUNK_SIZE_BYTES{1 << 22};
 
 /**
  * Maintains a tree of blocks (stored in `m_block_index`) which is consulted
@@ -78,6 +111,14 @@ private:
      */
     bool LoadBlockIndex(const Consensus::Params &consensus_params)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /**
+     * Load the block index from the snapshot written by
+     * WriteBlockIndexSnapshot(), if the block tree database still matches it.
+     * The loaded entries are returned sorted by height.
+     */
+    bool LoadBlockIndexSnapshot(const Consensus::Params &consensus_params,
+                                std::vector<CBlockIndex *> &sorted_by_height)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     void FlushBlockFile(bool fFinalize = false, bool finalize_undo = false);
     void FlushUndoFile(int block_file, bool finalize = false);
     bool FindBlockPos(FlatFilePos &pos, unsigned int nAddSize,
@@ -134,8 +175,17 @@ private:
     /** Dirty block file entries. */
     std::set<int> m_dirty_fileinfo;
 
+    /** Whether the block index was loaded by LoadBlockIndexDB(). */
+    bool m_block_index_loaded GUARDED_BY(::cs_main){false};
+
+    /** Memory the entries of m_block_index are allocated from. */
+    BlockMapMemoryResource m_block_index_memory_resource{
+        BLOCK_INDEX_CHUNK_SIZE_BYTES};
+
 public:
-    BlockMap m_block_index GUARDED_BY(cs_main);
+    BlockMap m_block_index GUARDED_BY(cs_main){
+        0, BlockHasher{}, std::equal_to<BlockHash>{},
+        &m_block_index_memory_resource};
 
     std::vector<CBlockIndex *> GetAllBlockIndices()
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
@@ -153,6 +203,14 @@ public:
     bool LoadBlockIndexDB(const Consensus::Params &consensus_params)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /**
+     * Write the whole block index to a snapshot file in the blocks directory,
+     * and record its hash in the block tree database, so that the next start
+     * can load it instead of iterating over the database. Meant to be called
+     * at shutdown, once the block index is not modified anymore.
+     */
+    bool WriteBlockIndexSnapshot() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     CBlockIndex *AddToBlockIndex(const CBlockHeader &block,
                                  CBlockIndex *&best_header)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -233,6 +291,8 @@ bool ReadBlockFromDisk(CBlock &block, const FlatFilePos &pos,
                        const Consensus::Params &consensusParams);
 bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex,
                        const Consensus::Params &consensusParams);
+bool UndoReadFromDisk(CBlockUndo &blockundo, const FlatFilePos &pos,
+                      const BlockHash &hashPrevBlock);
 bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex);
 
 /** Functions for disk access for txs */
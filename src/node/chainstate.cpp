@@ -278,7 +278,8 @@ VerifyLoadedChainstate(ChainstateManager &chainman,
 
             VerifyDBResult result =
                 CVerifyDB().VerifyDB(*chainstate, config, chainstate->CoinsDB(),
-                                     options.check_level, options.check_blocks);
+                                     options.check_level, options.check_blocks,
+                                     options.check_threads);
             switch (result) {
                 case VerifyDBResult::SUCCESS:
                 case VerifyDBResult::SKIPPED_MISSING_BLOCKS:
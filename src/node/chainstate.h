@@ -33,6 +33,7 @@ struct ChainstateLoadOptions {
     bool require_full_verification{true};
     int64_t check_blocks{DEFAULT_CHECKBLOCKS};
     int64_t check_level{DEFAULT_CHECKLEVEL};
+    int check_threads{DEFAULT_CHECKBLOCKS_THREADS};
     std::function<bool()> check_interrupt;
     std::function<void()> coins_error_cb;
 };
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/coinsprefetcher.h>
+
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <tinyformat.h>
+#include <util/hasher.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_set>
+
+namespace node {
+
+CoinsPrefetcher::CoinsPrefetcher(const CCoinsView &db,
+                                 const Consensus::Params &params,
+                                 int threads_num)
+    : m_db(db), m_params(params) {
+    for (int n = 0; n < threads_num; ++n) {
+        m_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("prefetch.%i", n));
+            ThreadPrefetch();
+        });
+    }
+}
+
+CoinsPrefetcher::~CoinsPrefetcher() {
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_cv.notify_all();
+    for (std::thread &t : m_threads) {
+        t.join();
+    }
+}
+
+void CoinsPrefetcher::Prefetch(
+    const std::vector<std::pair<BlockHash, FlatFilePos>> &blocks) {
+    LOCK(m_mutex);
+    std::map<BlockHash, Entry> entries;
+    for (const auto &[hash, pos] : blocks) {
+        auto it = m_entries.find(hash);
+        if (it != m_entries.end()) {
+            entries.insert(m_entries.extract(it));
+            continue;
+        }
+        const uint64_t id = m_next_id++;
+        entries.emplace(hash, Entry{id, pos, std::nullopt});
+        m_queue.emplace_back(hash, id);
+    }
+    m_entries = std::move(entries);
+    // Don't let requests for forgotten blocks pile up in the queue.
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                 [&](const auto &request) {
+                                     return !m_entries.count(request.first);
+                                 }),
+                  m_queue.end());
+    m_cv.notify_all();
+}
+
+std::optional<CoinsPrefetcher::Prefetched>
+CoinsPrefetcher::Take(const BlockHash &hash) {
+    LOCK(m_mutex);
+    auto it = m_entries.find(hash);
+    if (it == m_entries.end() || !it->second.result) {
+        return std::nullopt;
+    }
+    std::optional<Prefetched> result = std::move(it->second.result);
+    m_entries.erase(it);
+    return result;
+}
+
+void CoinsPrefetcher::Clear() {
+    LOCK(m_mutex);
+    m_entries.clear();
+    m_queue.clear();
+}
+
+void CoinsPrefetcher::ThreadPrefetch() {
+    while (true) {
+        BlockHash hash;
+        uint64_t id;
+        FlatFilePos pos;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return m_request_stop || !m_queue.empty();
+            });
+            if (m_request_stop) {
+                return;
+            }
+            std::tie(hash, id) = m_queue.front();
+            m_queue.pop_front();
+            auto it = m_entries.find(hash);
+            if (it == m_entries.end() || it->second.id != id) {
+                continue;
+            }
+            pos = it->second.pos;
+        }
+
+        Prefetched result;
+        try {
+            // Deserializing the block also computes the hashes of its
+            // transactions.
+            auto block = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*block, pos, m_params) ||
+                block->GetHash() != hash) {
+                // Leave it to the validation thread to report the error.
+                continue;
+            }
+            result.block = block;
+
+            // Outputs created by the block itself are not in the database.
+            std::unordered_set<TxId, SaltedTxIdHasher> block_txids;
+            for (const auto &ptx : block->vtx) {
+                block_txids.insert(ptx->GetId());
+            }
+
+            for (const auto &ptx : block->vtx) {
+                if (ptx->IsCoinBase()) {
+                    continue;
+                }
+                for (const CTxIn &txin : ptx->vin) {
+                    if (block_txids.count(txin.prevout.GetTxId())) {
+                        continue;
+                    }
+                    Coin coin;
+                    if (m_db.GetCoin(txin.prevout, coin)) {
+                        result.coins.emplace_back(txin.prevout,
+                                                  std::move(coin));
+                    }
+                }
+            }
+        } catch (const std::exception &e) {
+            // Leave it to the validation thread to deal with the error.
+            LogPrint(BCLog::VALIDATION,
+                     "Failed to prefetch block %s: %s\n",
+                     hash.ToString(), e.what());
+            continue;
+        }
+
+        LOCK(m_mutex);
+        auto it = m_entries.find(hash);
+        if (it != m_entries.end() && it->second.id == id) {
+            it->second.result = std::move(result);
+        }
+    }
+}
+
+} // namespace node
@@ -0,0 +1,114 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_COINSPREFETCHER_H
+#define BITCOIN_NODE_COINSPREFETCHER_H
+
+#include <coins.h>
+#include <flatfile.h>
+#include <primitives/blockhash.h>
+#include <sync.h>
+#include <threadsafety.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class CBlock;
+
+namespace Consensus {
+struct Params;
+}
+
+namespace node {
+
+/** Default for -prefetchblocks */
+static constexpr int DEFAULT_PREFETCH_BLOCKS{0};
+/** Maximum number of blocks, and of threads, used to prefetch coins */
+static constexpr int MAX_PREFETCH_BLOCKS{16};
+
+/**
+ * Reads and deserializes upcoming blocks on a pool of threads, and looks up the
+ * coins they spend in the coins database, so that connecting them doesn't have
+ * to wait on synchronous disk and database reads.
+ *
+ * The prefetched coins reflect the content of the database at the time they
+ * were read, so the owner must call Clear() whenever the database is written
+ * to. Coins created by blocks that are not flushed yet are not found in the
+ * database and are simply not prefetched.
+ */
+class CoinsPrefetcher {
+public:
+    using PrefetchedCoins = std::vector<std::pair<COutPoint, Coin>>;
+
+    struct Prefetched {
+        std::shared_ptr<const CBlock> block;
+        //! The coins spent by the block that were found in the database
+        PrefetchedCoins coins;
+    };
+
+    /**
+     * @param[in] db          The coins database. It must outlive this object.
+     * @param[in] threads_num Number of reader threads to start.
+     */
+    CoinsPrefetcher(const CCoinsView &db, const Consensus::Params &params,
+                    int threads_num);
+    ~CoinsPrefetcher();
+
+    /**
+     * Set the blocks to prefetch, in the order they are going to be connected.
+     * Blocks that were requested before and are not part of this list are
+     * forgotten.
+     */
+    void Prefetch(const std::vector<std::pair<BlockHash, FlatFilePos>> &blocks)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Return the block and the coins it spends that were found in the
+     * database, and forget about the block, or std::nullopt if they are not
+     * ready yet.
+     */
+    std::optional<Prefetched> Take(const BlockHash &hash)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Forget about all the blocks. The results of the reads in progress are
+     * discarded when they complete.
+     */
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        //! Identifies this request, so that the results of a read that was
+        //! started for a forgotten request are discarded.
+        uint64_t id;
+        FlatFilePos pos;
+        std::optional<Prefetched> result;
+    };
+
+    const CCoinsView &m_db;
+    const Consensus::Params &m_params;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<BlockHash, Entry> m_entries GUARDED_BY(m_mutex);
+    //! Requests waiting for a reader thread
+    std::deque<std::pair<BlockHash, uint64_t>> m_queue GUARDED_BY(m_mutex);
+    uint64_t m_next_id GUARDED_BY(m_mutex){0};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+
+    void ThreadPrefetch() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_COINSPREFETCHER_H
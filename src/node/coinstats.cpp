@@ -14,9 +14,14 @@
 #include <serialize.h>
 #include <util/check.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <cstring>
+#include <future>
 #include <map>
+#include <vector>
 
 namespace node {
 CCoinsStats::CCoinsStats(int block_height, const BlockHash &block_hash)
@@ -90,15 +95,11 @@ static void ApplyStats(CCoinsStats &stats, const TxId &txid,
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Add the coins of the cursor to the statistics
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
-                             const std::function<void()> &interruption_point) {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
-    PrepareHash(hash_obj, stats);
-
+static bool ApplyCursor(CCoinsViewCursor *pcursor, CCoinsStats &stats,
+                        T &hash_obj,
+                        const std::function<void()> &interruption_point) {
     TxId prevkey;
     std::map<uint32_t, Coin> outputs;
     while (pcursor->Valid()) {
@@ -123,6 +124,78 @@ static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
+                             const std::function<void()> &interruption_point) {
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    PrepareHash(hash_obj, stats);
+
+    if (!ApplyCursor(pcursor.get(), stats, hash_obj, interruption_point)) {
+        return false;
+    }
+
+    FinalizeHash(hash_obj, stats);
+
+    stats.nDiskSize = view->EstimateSize();
+
+    return true;
+}
+
+static void CombineHash(MuHash3072 &muhash, const MuHash3072 &range_muhash) {
+    muhash *= range_muhash;
+}
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
+/**
+ * Calculate statistics about the unspent transaction output set, processing
+ * ranges of it in parallel. Only for the hashes that don't depend on the
+ * order of the coins.
+ */
+template <typename T>
+static bool
+ComputeUTXOStatsParallel(CCoinsView *view, CCoinsStats &stats, T hash_obj,
+                         const std::function<void()> &interruption_point) {
+    const size_t num_ranges =
+        std::clamp(GetNumCores(), 1, MAX_UTXO_STATS_THREADS);
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{
+        view->RangeCursors(num_ranges)};
+    assert(!cursors.empty());
+
+    PrepareHash(hash_obj, stats);
+
+    std::vector<CCoinsStats> range_stats(cursors.size());
+    std::vector<T> range_hashes(cursors.size());
+    std::vector<std::future<bool>> range_results;
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        range_results.push_back(std::async(std::launch::async, [&, i]() {
+            util::ThreadRename(strprintf("utxostats.%i", i));
+            return ApplyCursor(cursors[i].get(), range_stats[i],
+                               range_hashes[i], interruption_point);
+        }));
+    }
+
+    bool success{true};
+    for (auto &result : range_results) {
+        success = result.get() && success;
+    }
+    if (!success) {
+        return false;
+    }
+
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        stats.nTransactions += range_stats[i].nTransactions;
+        stats.nTransactionOutputs += range_stats[i].nTransactionOutputs;
+        stats.nBogoSize += range_stats[i].nBogoSize;
+        stats.nTotalAmount += range_stats[i].nTotalAmount;
+        stats.coins_count += range_stats[i].coins_count;
+        CombineHash(hash_obj, range_hashes[i]);
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -147,12 +220,12 @@ ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
             }
             case (CoinStatsHashType::MUHASH): {
                 MuHash3072 muhash;
-                return ComputeUTXOStats(view, stats, muhash,
-                                        interruption_point);
+                return ComputeUTXOStatsParallel(view, stats, muhash,
+                                                interruption_point);
             }
             case (CoinStatsHashType::NONE): {
-                return ComputeUTXOStats(view, stats, nullptr,
-                                        interruption_point);
+                return ComputeUTXOStatsParallel(view, stats, nullptr,
+                                                interruption_point);
             }
         } // no default case, so the compiler can warn about missing cases
         assert(false);
@@ -182,6 +255,54 @@ static void FinalizeHash(MuHash3072 &muhash, CCoinsStats &stats) {
 }
 static void FinalizeHash(std::nullptr_t, CCoinsStats &stats) {}
 
+SerializedCoinsHasher::SerializedCoinsHasher(int block_height,
+                                             const BlockHash &block_hash)
+    : m_stats(block_height, block_hash) {
+    PrepareHash(m_hasher, m_stats);
+}
+
+bool SerializedCoinsHasher::Add(const COutPoint &outpoint, const Coin &coin) {
+    if (!m_in_order) {
+        return false;
+    }
+    if (coin.IsSpent()) {
+        // Spent coins are not written to the database.
+        m_in_order = false;
+        return false;
+    }
+
+    const TxId &txid = outpoint.GetTxId();
+    if (!m_outputs.empty() && txid != m_prev_txid) {
+        // The database orders the txids by their serialized bytes, unlike
+        // uint256::operator<.
+        if (std::memcmp(txid.data(), m_prev_txid.data(), txid.size()) < 0) {
+            m_in_order = false;
+            return false;
+        }
+        ApplyStats(m_stats, m_prev_txid, m_outputs);
+        ApplyHash(m_hasher, m_prev_txid, m_outputs);
+        m_outputs.clear();
+    }
+    m_prev_txid = txid;
+    if (!m_outputs.emplace(outpoint.GetN(), coin).second) {
+        // Duplicated outpoint.
+        m_in_order = false;
+        return false;
+    }
+    m_stats.coins_count++;
+    return true;
+}
+
+CCoinsStats SerializedCoinsHasher::Finalize() {
+    if (!m_outputs.empty()) {
+        ApplyStats(m_stats, m_prev_txid, m_outputs);
+        ApplyHash(m_hasher, m_prev_txid, m_outputs);
+        m_outputs.clear();
+    }
+    FinalizeHash(m_hasher, m_stats);
+    return m_stats;
+}
+
 std::optional<CCoinsStats>
 GetUTXOStats(CCoinsView *view, BlockManager &blockman,
              CoinStatsHashType hash_type,
@@ -9,12 +9,15 @@
 #include <chain.h>
 #include <coins.h>
 #include <consensus/amount.h>
+#include <hash.h>
 #include <primitives/blockhash.h>
+#include <primitives/txid.h>
 #include <streams.h>
 #include <uint256.h>
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <optional>
 
 class CCoinsView;
@@ -23,6 +26,10 @@ class BlockManager;
 } // namespace node
 
 namespace node {
+//! Maximum number of threads used to compute the statistics of the UTXO set
+//! when the hash doesn't depend on the order of the coins.
+static constexpr int MAX_UTXO_STATS_THREADS{16};
+
 enum class CoinStatsHashType {
     HASH_SERIALIZED,
     MUHASH,
@@ -96,6 +103,41 @@ std::optional<CCoinsStats>
 ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
                  BlockManager &blockman,
                  const std::function<void()> &interruption_point = {});
+
+/**
+ * Compute the HASH_SERIALIZED statistics of a coins set incrementally, as the
+ * coins are streamed in.
+ *
+ * The result is identical to ComputeUTXOStats() over a view holding exactly
+ * the added coins, provided they were added in database order: all the
+ * outputs of a transaction are contiguous and the txids are strictly
+ * increasing. This lets a UTXO snapshot be hashed while it is being loaded
+ * instead of reading the whole coins database back afterwards.
+ */
+class SerializedCoinsHasher {
+private:
+    CCoinsStats m_stats;
+    CHashWriter m_hasher{SER_GETHASH, PROTOCOL_VERSION};
+    TxId m_prev_txid;
+    std::map<uint32_t, Coin> m_outputs;
+    bool m_in_order{true};
+
+public:
+    SerializedCoinsHasher(int block_height, const BlockHash &block_hash);
+
+    /**
+     * Add a coin to the hash. Returns false, and ignores any further coins,
+     * if the coins are not in database order or if the coin is spent, in
+     * which case the result would not match the database content.
+     */
+    bool Add(const COutPoint &outpoint, const Coin &coin);
+
+    /** Whether all the added coins were in database order. */
+    bool InOrder() const { return m_in_order; }
+
+    /** Return the statistics. Must only be called once. */
+    CCoinsStats Finalize();
+};
 } // namespace node
 
 #endif // BITCOIN_NODE_COINSTATS_H
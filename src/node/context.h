@@ -25,6 +25,8 @@ class WalletClient;
 } // namespace interfaces
 
 namespace node {
+class BlockTemplateSelection;
+
 //! NodeContext struct containing references to chain state and connection
 //! state.
 //!
@@ -42,6 +44,7 @@ struct NodeContext {
     std::unique_ptr<PeerManager> peerman;
     std::unique_ptr<ChainstateManager> chainman;
     std::unique_ptr<BanMan> banman;
+    std::unique_ptr<BlockTemplateSelection> block_template_selection;
     // Currently a raw pointer because the memory is not managed by this struct
     ArgsManager *args{nullptr};
     std::unique_ptr<interfaces::Chain> chain;
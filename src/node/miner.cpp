@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 namespace node {
@@ -61,10 +62,12 @@ BlockAssembler::Options::Options()
 
 BlockAssembler::BlockAssembler(Chainstate &chainstate,
                                const CTxMemPool *mempool,
-                               const Options &options)
+                               const Options &options,
+                               BlockTemplateSelection *selection)
     : chainParams(chainstate.m_chainman.GetParams()), m_mempool(mempool),
-      m_chainstate(chainstate), fPrintPriority(gArgs.GetBoolArg(
-                                    "-printpriority", DEFAULT_PRINTPRIORITY)) {
+      m_chainstate(chainstate), m_selection(selection),
+      fPrintPriority(
+          gArgs.GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY)) {
     blockMinFeeRate = options.blockMinFeeRate;
     // Limit size to between 1K and options.nExcessiveBlockSize -1K for sanity:
     nMaxGeneratedBlockSize = std::max<uint64_t>(
@@ -103,8 +106,9 @@ static BlockAssembler::Options DefaultOptions(const Config &config) {
 }
 
 BlockAssembler::BlockAssembler(const Config &config, Chainstate &chainstate,
-                               const CTxMemPool *mempool)
-    : BlockAssembler(chainstate, mempool, DefaultOptions(config)) {}
+                               const CTxMemPool *mempool,
+                               BlockTemplateSelection *selection)
+    : BlockAssembler(chainstate, mempool, DefaultOptions(config), selection) {}
 
 void BlockAssembler::resetBlock() {
     // Reserve space for coinbase tx.
@@ -155,7 +159,11 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn) {
 
     if (m_mempool) {
         LOCK(m_mempool->cs);
-        addTxs(*m_mempool);
+        if (m_selection) {
+            addSelectedTxs(*m_mempool, pindexPrev);
+        } else {
+            addTxs(*m_mempool);
+        }
     }
 
     if (IsMagneticAnomalyEnabled(consensusParams, pindexPrev)) {
@@ -412,4 +420,271 @@ void BlockAssembler::addTxs(const CTxMemPool &mempool) {
         }
     }
 }
+
+void BlockAssembler::addSelectedTxs(const CTxMemPool &mempool,
+                                    const CBlockIndex *pindexPrev) {
+    const BlockTemplateSelection::Limits limits{
+        nMaxGeneratedBlockSize, nMaxGeneratedBlockSigChecks, blockMinFeeRate};
+    const std::optional<std::vector<TxId>> selected =
+        m_selection->GetSelectedTxs(mempool, pindexPrev->GetBlockHash(),
+                                    limits);
+    if (!selected) {
+        addTxs(mempool);
+        m_selection->Reset(mempool, pindexPrev->GetBlockHash(),
+                           chainParams.GetConsensus(), nHeight,
+                           m_lock_time_cutoff, limits, pblocktemplate->entries,
+                           nBlockSize, nBlockSigChecks);
+        return;
+    }
+
+    // The selection may lag behind the mempool, as it is updated from the
+    // validation interface queue. Skip the transactions that are gone and
+    // their descendants.
+    std::unordered_set<TxId, SaltedTxIdHasher> added;
+    added.reserve(selected->size());
+    for (const TxId &txid : *selected) {
+        auto it = mempool.mapTx.find(txid);
+        if (it == mempool.mapTx.end()) {
+            continue;
+        }
+        const CTxMemPoolEntryRef &entry = *it;
+
+        const auto &parents = entry->GetMemPoolParentsConst();
+        if (!std::all_of(parents.begin(), parents.end(),
+                         [&added](const CTxMemPoolEntryRef &parent) {
+                             return added.count(parent->GetTx().GetId()) > 0;
+                         })) {
+            continue;
+        }
+
+        if (!TestTxFits(entry->GetTxSize(), entry->GetSigChecks()) ||
+            !CheckTx(entry->GetTx())) {
+            continue;
+        }
+
+        AddToBlock(entry);
+        added.insert(txid);
+    }
+}
+
+std::optional<std::vector<TxId>>
+BlockTemplateSelection::GetSelectedTxs(const CTxMemPool &mempool,
+                                       const BlockHash &tip,
+                                       const Limits &limits) const {
+    AssertLockHeld(mempool.cs);
+    assert(&mempool == &m_mempool);
+
+    LOCK(m_mutex);
+    if (!m_valid || m_tip != tip ||
+        m_limits.nMaxGeneratedBlockSize != limits.nMaxGeneratedBlockSize ||
+        m_limits.nMaxGeneratedBlockSigChecks !=
+            limits.nMaxGeneratedBlockSigChecks ||
+        m_limits.blockMinFeeRate != limits.blockMinFeeRate ||
+        m_fee_deltas_updated != mempool.GetFeeDeltasUpdated()) {
+        return std::nullopt;
+    }
+
+    std::vector<TxId> txids;
+    txids.reserve(m_by_sequence.size());
+    for (const auto &[sequence, txid] : m_by_sequence) {
+        txids.push_back(txid);
+    }
+    return txids;
+}
+
+void BlockTemplateSelection::Reset(
+    const CTxMemPool &mempool, const BlockHash &tip,
+    const Consensus::Params &params, int height, int64_t lock_time_cutoff,
+    const Limits &limits, const std::vector<CBlockTemplateEntry> &entries,
+    uint64_t block_size, uint64_t block_sigchecks) {
+    AssertLockHeld(mempool.cs);
+    assert(&mempool == &m_mempool);
+
+    LOCK(m_mutex);
+    Clear();
+    m_tip = tip;
+    m_params = &params;
+    m_height = height;
+    m_lock_time_cutoff = lock_time_cutoff;
+    m_limits = limits;
+    m_fee_deltas_updated = mempool.GetFeeDeltasUpdated();
+
+    // Select() accounts for the size and sigchecks of each transaction.
+    m_block_size = block_size;
+    m_block_sigchecks = block_sigchecks;
+    for (const CBlockTemplateEntry &entry : entries) {
+        // Skip the coinbase placeholder.
+        if (!entry.tx) {
+            continue;
+        }
+        auto it = mempool.mapTx.find(entry.tx->GetId());
+        assert(it != mempool.mapTx.end());
+        m_block_size -= (*it)->GetTxSize();
+        m_block_sigchecks -= (*it)->GetSigChecks();
+        Select(*it);
+    }
+    m_valid = true;
+}
+
+void BlockTemplateSelection::Clear() {
+    m_valid = false;
+    m_selected.clear();
+    m_by_sequence.clear();
+    m_leaves.clear();
+    m_block_size = 0;
+    m_block_sigchecks = 0;
+}
+
+void BlockTemplateSelection::Select(const CTxMemPoolEntryRef &entry) {
+    const TxId &txid = entry->GetTx().GetId();
+    SelectedTx &selected = m_selected[txid];
+    selected.sequence = m_next_sequence++;
+    selected.feeRate = entry->GetModifiedFeeRate();
+    selected.size = entry->GetTxSize();
+    selected.sigChecks = entry->GetSigChecks();
+
+    for (const CTxMemPoolEntryRef &parent :
+         entry->GetMemPoolParentsConst()) {
+        const TxId &parentId = parent->GetTx().GetId();
+        SelectedTx &selectedParent = m_selected.at(parentId);
+        if (selectedParent.children.empty()) {
+            m_leaves.erase({selectedParent.feeRate, parentId});
+        }
+        selectedParent.children.push_back(txid);
+        selected.parents.push_back(parentId);
+    }
+
+    m_leaves.emplace(selected.feeRate, txid);
+    m_by_sequence.emplace(selected.sequence, txid);
+    m_block_size += selected.size;
+    m_block_sigchecks += selected.sigChecks;
+}
+
+void BlockTemplateSelection::Unselect(const TxId &txid) {
+    auto it = m_selected.find(txid);
+    assert(it != m_selected.end());
+    const SelectedTx &selected = it->second;
+    assert(selected.children.empty());
+
+    for (const TxId &parentId : selected.parents) {
+        SelectedTx &selectedParent = m_selected.at(parentId);
+        auto &children = selectedParent.children;
+        children.erase(std::find(children.begin(), children.end(), txid));
+        if (children.empty()) {
+            m_leaves.emplace(selectedParent.feeRate, parentId);
+        }
+    }
+
+    m_leaves.erase({selected.feeRate, txid});
+    m_by_sequence.erase(selected.sequence);
+    m_block_size -= selected.size;
+    m_block_sigchecks -= selected.sigChecks;
+    m_selected.erase(it);
+}
+
+void BlockTemplateSelection::TransactionAddedToMempool(
+    const CTransactionRef &tx, std::shared_ptr<const std::vector<Coin>>,
+    uint64_t mempool_sequence) {
+    // Don't contend for the mempool lock if the selection is not in use. If it
+    // is rebuilt in the meantime, it already accounts for this transaction.
+    if (!WITH_LOCK(m_mutex, return m_valid)) {
+        return;
+    }
+
+    LOCK2(m_mempool.cs, m_mutex);
+    if (!m_valid) {
+        return;
+    }
+
+    // The transaction may already be gone, or have been selected when the
+    // selection was rebuilt.
+    const TxId &txid = tx->GetId();
+    auto it = m_mempool.mapTx.find(txid);
+    if (it == m_mempool.mapTx.end() || m_selected.count(txid) > 0) {
+        return;
+    }
+    const CTxMemPoolEntryRef &entry = *it;
+
+    const CFeeRate feeRate = entry->GetModifiedFeeRate();
+    if (feeRate < m_limits.blockMinFeeRate) {
+        return;
+    }
+
+    const auto &parents = entry->GetMemPoolParentsConst();
+    if (!std::all_of(parents.begin(), parents.end(),
+                     [this](const CTxMemPoolEntryRef &parent)
+                         EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                             return m_selected.count(
+                                        parent->GetTx().GetId()) > 0;
+                         })) {
+        return;
+    }
+
+    TxValidationState state;
+    if (!ContextualCheckTransaction(*m_params, *tx, state, m_height,
+                                    m_lock_time_cutoff)) {
+        return;
+    }
+
+    // If the block is full, look for selected transactions with a lower fee
+    // rate to make room for this one. Only the transactions without selected
+    // children can be removed, and the parents of this one must stay.
+    std::vector<TxId> evicted;
+    uint64_t freedSize = 0;
+    int64_t freedSigChecks = 0;
+    auto fits = [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return m_block_size - freedSize + entry->GetTxSize() <
+                   m_limits.nMaxGeneratedBlockSize &&
+               m_block_sigchecks - freedSigChecks + entry->GetSigChecks() <
+                   m_limits.nMaxGeneratedBlockSigChecks;
+    };
+    for (auto leaf = m_leaves.begin(); !fits(); ++leaf) {
+        if (leaf == m_leaves.end() || !(leaf->first < feeRate)) {
+            return;
+        }
+        const bool isParent =
+            std::any_of(parents.begin(), parents.end(),
+                        [&leaf](const CTxMemPoolEntryRef &parent) {
+                            return parent->GetTx().GetId() == leaf->second;
+                        });
+        if (isParent) {
+            continue;
+        }
+        const SelectedTx &selected = m_selected.at(leaf->second);
+        evicted.push_back(leaf->second);
+        freedSize += selected.size;
+        freedSigChecks += selected.sigChecks;
+    }
+
+    for (const TxId &evictedId : evicted) {
+        Unselect(evictedId);
+    }
+    Select(entry);
+}
+
+void BlockTemplateSelection::TransactionRemovedFromMempool(
+    const CTransactionRef &tx, MemPoolRemovalReason reason,
+    uint64_t mempool_sequence) {
+    LOCK(m_mutex);
+    // The descendants of the transaction are removed as well, so rebuild the
+    // selection to fill the space they leave.
+    if (m_valid && m_selected.count(tx->GetId()) > 0) {
+        Clear();
+    }
+}
+
+void BlockTemplateSelection::BlockConnected(
+    const std::shared_ptr<const CBlock> &block, const CBlockIndex *pindex) {
+    LOCK(m_mutex);
+    // The selection may already have been rebuilt on top of this block.
+    if (m_valid && m_tip != pindex->GetBlockHash()) {
+        Clear();
+    }
+}
+
+void BlockTemplateSelection::BlockDisconnected(
+    const std::shared_ptr<const CBlock> &block, const CBlockIndex *pindex) {
+    LOCK(m_mutex);
+    Clear();
+}
 } // namespace node
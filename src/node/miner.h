@@ -7,15 +7,26 @@
 #define BITCOIN_NODE_MINER_H
 
 #include <consensus/amount.h>
+#include <feerate.h>
 #include <primitives/block.h>
+#include <primitives/blockhash.h>
+#include <primitives/txid.h>
+#include <sync.h>
 #include <txmempool.h>
+#include <util/hasher.h>
+#include <validationinterface.h>
 
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class CBlockIndex;
 class CChainParams;
@@ -44,6 +55,111 @@ struct CBlockTemplate {
     std::vector<CBlockTemplateEntry> entries;
 };
 
+/**
+ * The mempool transactions selected for the next block template, kept up to
+ * date with the mempool so getblocktemplate doesn't need to walk the whole
+ * mempool every time.
+ *
+ * The selection is built by BlockAssembler::addTxs() the first time it is used,
+ * and again when the tip or the block limits change, when a fee delta is
+ * applied or when a selected transaction is removed from the mempool for any
+ * other reason than being mined. In between, a transaction added to the
+ * mempool is selected if all its mempool parents are selected, replacing
+ * selected transactions with a lower fee rate and no selected children if the
+ * block is full.
+ */
+class BlockTemplateSelection final : public CValidationInterface {
+public:
+    struct Limits {
+        uint64_t nMaxGeneratedBlockSize;
+        uint64_t nMaxGeneratedBlockSigChecks;
+        CFeeRate blockMinFeeRate;
+    };
+
+    explicit BlockTemplateSelection(const CTxMemPool &mempool)
+        : m_mempool(mempool) {}
+
+    /**
+     * Return the selected transactions in the order they were selected, so
+     * parents come before their children, or std::nullopt if the selection
+     * must be rebuilt for a block on top of tip with these limits.
+     */
+    std::optional<std::vector<TxId>>
+    GetSelectedTxs(const CTxMemPool &mempool, const BlockHash &tip,
+                   const Limits &limits) const
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs) LOCKS_EXCLUDED(m_mutex);
+
+    /**
+     * Replace the selection with the transactions of a block template built
+     * from the whole mempool, in the order they were added to the block.
+     *
+     * @param[in] block_size       The size of the block, including the space
+     *                             reserved for the coinbase.
+     * @param[in] block_sigchecks  The sigchecks of the block, including the
+     *                             ones reserved for the coinbase.
+     */
+    void Reset(const CTxMemPool &mempool, const BlockHash &tip,
+               const Consensus::Params &params, int height,
+               int64_t lock_time_cutoff, const Limits &limits,
+               const std::vector<CBlockTemplateEntry> &entries,
+               uint64_t block_size, uint64_t block_sigchecks)
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs) LOCKS_EXCLUDED(m_mutex);
+
+protected:
+    void TransactionAddedToMempool(const CTransactionRef &tx,
+                                   std::shared_ptr<const std::vector<Coin>>,
+                                   uint64_t mempool_sequence) override
+        LOCKS_EXCLUDED(m_mutex);
+    void TransactionRemovedFromMempool(const CTransactionRef &tx,
+                                       MemPoolRemovalReason reason,
+                                       uint64_t mempool_sequence) override
+        LOCKS_EXCLUDED(m_mutex);
+    void BlockConnected(const std::shared_ptr<const CBlock> &block,
+                        const CBlockIndex *pindex) override
+        LOCKS_EXCLUDED(m_mutex);
+    void BlockDisconnected(const std::shared_ptr<const CBlock> &block,
+                           const CBlockIndex *pindex) override
+        LOCKS_EXCLUDED(m_mutex);
+
+private:
+    struct SelectedTx {
+        //! Position in the selection order
+        uint64_t sequence;
+        CFeeRate feeRate;
+        uint64_t size;
+        int64_t sigChecks;
+        //! Selected mempool parents and children
+        std::vector<TxId> parents;
+        std::vector<TxId> children;
+    };
+
+    const CTxMemPool &m_mempool;
+
+    mutable Mutex m_mutex;
+    //! Whether the selection is in use and up to date with the mempool
+    bool m_valid GUARDED_BY(m_mutex){false};
+    BlockHash m_tip GUARDED_BY(m_mutex);
+    const Consensus::Params *m_params GUARDED_BY(m_mutex){nullptr};
+    int m_height GUARDED_BY(m_mutex){0};
+    int64_t m_lock_time_cutoff GUARDED_BY(m_mutex){0};
+    Limits m_limits GUARDED_BY(m_mutex);
+    uint64_t m_fee_deltas_updated GUARDED_BY(m_mutex){0};
+
+    uint64_t m_block_size GUARDED_BY(m_mutex){0};
+    uint64_t m_block_sigchecks GUARDED_BY(m_mutex){0};
+    uint64_t m_next_sequence GUARDED_BY(m_mutex){0};
+    std::unordered_map<TxId, SelectedTx, SaltedTxIdHasher>
+        m_selected GUARDED_BY(m_mutex);
+    std::map<uint64_t, TxId> m_by_sequence GUARDED_BY(m_mutex);
+    //! Selected transactions without selected children, by fee rate
+    std::set<std::pair<CFeeRate, TxId>> m_leaves GUARDED_BY(m_mutex);
+
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Select(const CTxMemPoolEntryRef &entry)
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Unselect(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
 /** Generate a new block, without valid proof-of-work */
 class BlockAssembler {
 private:
@@ -68,6 +184,7 @@ private:
 
     const CTxMemPool *const m_mempool;
     Chainstate &m_chainstate;
+    BlockTemplateSelection *const m_selection;
 
     const bool fPrintPriority;
 
@@ -79,10 +196,16 @@ public:
         CFeeRate blockMinFeeRate;
     };
 
+    /**
+     * If a selection is provided, the transactions are taken from it instead
+     * of being selected from the whole mempool. It must track mempool.
+     */
     BlockAssembler(const Config &config, Chainstate &chainstate,
-                   const CTxMemPool *mempool);
+                   const CTxMemPool *mempool,
+                   BlockTemplateSelection *selection = nullptr);
     BlockAssembler(Chainstate &chainstate, const CTxMemPool *mempool,
-                   const Options &options);
+                   const Options &options,
+                   BlockTemplateSelection *selection = nullptr);
 
     /** Construct a new block template with coinbase to scriptPubKeyIn */
     std::unique_ptr<CBlockTemplate>
@@ -105,6 +228,13 @@ private:
      * Add transactions from the mempool based on individual tx feerate.
      */
     void addTxs(const CTxMemPool &mempool) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
+    /**
+     * Add the transactions of the selection that are still valid, or rebuild
+     * the selection with addTxs() if it is out of date.
+     */
+    void addSelectedTxs(const CTxMemPool &mempool,
+                        const CBlockIndex *pindexPrev)
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
 
     // helper functions for addTxs()
     /** Test if a new Tx would "fit" in the block */
@@ -19,6 +19,8 @@
 #include <validationinterface.h>
 
 #include <future>
+#include <map>
+#include <utility>
 
 namespace node {
 static TransactionError HandleATMPError(const TxValidationState &state,
@@ -126,6 +128,85 @@ TransactionError BroadcastTransaction(const NodeContext &node,
     return TransactionError::OK;
 }
 
+std::vector<TransactionError>
+BroadcastTransactions(const NodeContext &node,
+                      const std::vector<CTransactionRef> &txns,
+                      std::vector<std::string> &err_strings,
+                      const CFeeRate &max_fee_rate, bool relay) {
+    assert(node.chainman);
+    assert(node.mempool);
+    assert(node.peerman);
+
+    std::vector<TransactionError> errors(txns.size(), TransactionError::OK);
+    err_strings.assign(txns.size(), "");
+    // The index of each copy of a transaction, and of its first copy.
+    std::vector<std::pair<size_t, size_t>> copies;
+
+    {
+        LOCK(cs_main);
+
+        // Only submit the transactions that are neither confirmed nor already
+        // in the mempool, once each. Like when they are broadcast one by one,
+        // the copies of a transaction get the result of the first one.
+        CCoinsViewCache &view = node.chainman->ActiveChainstate().CoinsTip();
+        std::vector<CTransactionRef> to_submit;
+        std::vector<size_t> to_submit_index;
+        std::map<TxId, size_t> first_copy;
+        for (size_t i = 0; i < txns.size(); ++i) {
+            const TxId txid = txns[i]->GetId();
+            const auto [it, inserted] = first_copy.emplace(txid, i);
+            if (!inserted) {
+                copies.emplace_back(i, it->second);
+                continue;
+            }
+            for (size_t o = 0; o < txns[i]->vout.size(); o++) {
+                if (!view.AccessCoin(COutPoint(txid, o)).IsSpent()) {
+                    errors[i] = TransactionError::ALREADY_IN_CHAIN;
+                    break;
+                }
+            }
+            if (errors[i] == TransactionError::OK &&
+                !node.mempool->exists(txid)) {
+                to_submit.push_back(txns[i]);
+                to_submit_index.push_back(i);
+            }
+        }
+
+        const std::vector<MempoolAcceptResult> results =
+            node.chainman->ProcessTransactions(to_submit, /*test_accept=*/false,
+                                               max_fee_rate);
+        for (size_t j = 0; j < results.size(); ++j) {
+            const size_t i = to_submit_index[j];
+            if (results[j].m_result_type !=
+                MempoolAcceptResult::ResultType::VALID) {
+                errors[i] =
+                    results[j].m_state.GetRejectReason() == "max-fee-exceeded"
+                        ? TransactionError::MAX_FEE_EXCEEDED
+                        : HandleATMPError(results[j].m_state, err_strings[i]);
+            } else if (relay) {
+                // the mempool tracks locally submitted transactions to make a
+                // best-effort of initial broadcast
+                node.mempool->AddUnbroadcastTx(txns[i]->GetId());
+            }
+        }
+    } // cs_main
+
+    for (const auto &[i, first] : copies) {
+        errors[i] = errors[first];
+        err_strings[i] = err_strings[first];
+    }
+
+    if (relay) {
+        for (size_t i = 0; i < txns.size(); ++i) {
+            if (errors[i] == TransactionError::OK) {
+                node.peerman->RelayTransaction(txns[i]->GetId());
+            }
+        }
+    }
+
+    return errors;
+}
+
 CTransactionRef GetTransaction(const CBlockIndex *const block_index,
                                const CTxMemPool *const mempool,
                                const TxId &txid,
@@ -9,6 +9,9 @@
 #include <primitives/transaction.h>
 #include <util/error.h>
 
+#include <string>
+#include <vector>
+
 struct BlockHash;
 class CBlockIndex;
 class Config;
@@ -57,6 +60,31 @@ BroadcastTransaction(const NodeContext &node, CTransactionRef tx,
                      std::string &err_string, Amount max_tx_fee, bool relay,
                      bool wait_callback);
 
+/**
+ * Submit transactions to the mempool, as if they were submitted one by one in
+ * order, and relay the accepted ones to all P2P peers. The script checks of the
+ * transactions that neither depend on nor conflict with an earlier one are run
+ * in parallel.
+ *
+ * Transactions that are already in the mempool are relayed again, and the
+ * copies of a transaction get the result of the first one. Unlike
+ * BroadcastTransaction, this does not wait for the validation interface
+ * callbacks.
+ *
+ * @param[in]  node reference to node context
+ * @param[in]  txns the transactions to broadcast
+ * @param[out] err_strings the error string of each transaction, if available
+ * @param[in]  max_fee_rate reject txs with a higher fee rate (if 0, accept any
+ * fee rate)
+ * @param[in]  relay flag if both mempool insertion and p2p relay are requested
+ * @return the error of each transaction
+ */
+[[nodiscard]] std::vector<TransactionError>
+BroadcastTransactions(const NodeContext &node,
+                      const std::vector<CTransactionRef> &txns,
+                      std::vector<std::string> &err_strings,
+                      const CFeeRate &max_fee_rate, bool relay);
+
 /**
  * Return transaction with a given txid.
  * If mempool is provided and block_index is not provided, check it first for
@@ -11,11 +11,56 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <cassert>
 #include <cstdio>
+#include <limits>
 #include <optional>
 
 namespace node {
 
+SnapshotMetadata SnapshotMetadata::Chunked(const BlockHash &base_blockhash,
+                                           uint64_t coins_count,
+                                           uint32_t chunk_coins) {
+    assert(chunk_coins > 0);
+    SnapshotMetadata metadata;
+    metadata.m_version = VERSION_CHUNKED;
+    metadata.m_base_blockhash = base_blockhash;
+    metadata.m_coins_count = coins_count;
+    metadata.m_chunk_coins = chunk_coins;
+    metadata.m_chunks.resize((coins_count + chunk_coins - 1) / chunk_coins);
+    return metadata;
+}
+
+uint64_t SnapshotMetadata::GetChunkCoins(size_t chunk) const {
+    assert(chunk < m_chunks.size());
+    if (chunk + 1 < m_chunks.size()) {
+        return m_chunk_coins;
+    }
+    return m_coins_count - uint64_t{m_chunk_coins} * chunk;
+}
+
+bool SnapshotMetadata::CheckChunks(uint64_t data_offset) const {
+    if (!IsChunked()) {
+        return m_chunks.empty();
+    }
+    if (m_chunk_coins == 0 || m_chunk_coins > MAX_SNAPSHOT_CHUNK_COINS) {
+        return false;
+    }
+    if (m_chunks.size() !=
+        (m_coins_count + m_chunk_coins - 1) / m_chunk_coins) {
+        return false;
+    }
+    uint64_t offset{data_offset};
+    for (const SnapshotChunk &chunk : m_chunks) {
+        if (chunk.m_offset != offset || chunk.m_size == 0 ||
+            chunk.m_size > std::numeric_limits<uint64_t>::max() - offset) {
+            return false;
+        }
+        offset += chunk.m_size;
+    }
+    return true;
+}
+
 bool WriteSnapshotBaseBlockhash(Chainstate &snapshot_chainstate) {
     AssertLockHeld(::cs_main);
     assert(snapshot_chainstate.m_from_snapshot_blockhash);
@@ -9,19 +9,63 @@
 #include <fs.h>
 #include <primitives/blockhash.h>
 #include <serialize.h>
+#include <tinyformat.h>
+#include <uint256.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ios>
 #include <optional>
+#include <vector>
 
 struct BlockHash;
 
 extern RecursiveMutex cs_main;
 
 namespace node {
+//! Magic bytes at the start of a versioned snapshot. Snapshots without them
+//! are legacy snapshots, which start with the base block hash.
+static constexpr std::array<uint8_t, 5> SNAPSHOT_MAGIC_BYTES{
+    {'u', 't', 'x', 'o', 0xff}};
+
+//! Default number of coins in each chunk of a chunked snapshot.
+static constexpr uint32_t DEFAULT_SNAPSHOT_CHUNK_COINS{50000};
+//! Maximum number of coins in each chunk of a chunked snapshot.
+static constexpr uint32_t MAX_SNAPSHOT_CHUNK_COINS{1000000};
+
+//! Location and checksum of a chunk of coins in a chunked snapshot.
+class SnapshotChunk {
+public:
+    //! Position of the first coin of the chunk in the snapshot file.
+    uint64_t m_offset{0};
+
+    //! Size of the serialized coins of the chunk, in bytes.
+    uint64_t m_size{0};
+
+    //! Double SHA-256 of the serialized coins of the chunk.
+    uint256 m_checksum;
+
+    SERIALIZE_METHODS(SnapshotChunk, obj) {
+        READWRITE(obj.m_offset, obj.m_size, obj.m_checksum);
+    }
+};
+
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo Chainstate can be constructed.
+//!
+//! Legacy snapshots are a single stream of coins. Chunked snapshots split the
+//! coins into chunks of m_chunk_coins coins (the last one may be smaller),
+//! which are indexed in the metadata so that they can be located, verified
+//! and decoded independently of each other.
 class SnapshotMetadata {
 public:
+    static constexpr uint16_t VERSION_LEGACY{1};
+    static constexpr uint16_t VERSION_CHUNKED{2};
+
+    uint16_t m_version{VERSION_LEGACY};
+
     //! The hash of the block that reflects the tip of the chain for the
     //! UTXO set contained in this snapshot.
     BlockHash m_base_blockhash;
@@ -30,13 +74,61 @@ public:
     //! during snapshot load to estimate progress of UTXO set reconstruction.
     uint64_t m_coins_count = 0;
 
+    //! The number of coins in each chunk, for chunked snapshots.
+    uint32_t m_chunk_coins{0};
+
+    //! The index of the chunks, for chunked snapshots.
+    std::vector<SnapshotChunk> m_chunks;
+
     SnapshotMetadata() {}
     SnapshotMetadata(const BlockHash &base_blockhash, uint64_t coins_count,
                      uint64_t nchaintx)
         : m_base_blockhash(base_blockhash), m_coins_count(coins_count) {}
+    //! Metadata of a chunked snapshot, with a zeroed chunk index.
+    static SnapshotMetadata Chunked(const BlockHash &base_blockhash,
+                                    uint64_t coins_count, uint32_t chunk_coins);
+
+    bool IsChunked() const { return m_version == VERSION_CHUNKED; }
+
+    //! Number of coins in the given chunk of a chunked snapshot.
+    uint64_t GetChunkCoins(size_t chunk) const;
+
+    //! Check that the chunk index of a chunked snapshot covers the coins of
+    //! the snapshot with contiguous chunks starting at `data_offset`.
+    bool CheckChunks(uint64_t data_offset) const;
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        if (m_version != VERSION_LEGACY) {
+            s << SNAPSHOT_MAGIC_BYTES << m_version;
+        }
+        s << m_base_blockhash << m_coins_count;
+        if (IsChunked()) {
+            s << m_chunk_coins << m_chunks;
+        }
+    }
 
-    SERIALIZE_METHODS(SnapshotMetadata, obj) {
-        READWRITE(obj.m_base_blockhash, obj.m_coins_count);
+    template <typename Stream> void Unserialize(Stream &s) {
+        std::array<uint8_t, SNAPSHOT_MAGIC_BYTES.size()> magic;
+        s >> magic;
+        if (magic != SNAPSHOT_MAGIC_BYTES) {
+            // A legacy snapshot, the magic bytes we read are the beginning of
+            // the base block hash.
+            m_version = VERSION_LEGACY;
+            std::copy(magic.begin(), magic.end(), m_base_blockhash.begin());
+            Span<uint8_t> hash_rest{m_base_blockhash.begin() + magic.size(),
+                                    m_base_blockhash.end()};
+            s >> hash_rest >> m_coins_count;
+            m_chunk_coins = 0;
+            m_chunks.clear();
+            return;
+        }
+
+        s >> m_version;
+        if (m_version != VERSION_CHUNKED) {
+            throw std::ios_base::failure(
+                strprintf("Unsupported snapshot version %d", m_version));
+        }
+        s >> m_base_blockhash >> m_coins_count >> m_chunk_coins >> m_chunks;
     }
 };
 
@@ -224,6 +224,54 @@ bool CPubKey::VerifySchnorr(const uint256 &hash,
     return VerifySchnorr(hash, sig);
 }
 
+void CSchnorrBatch::Add(const CPubKey &pubkey, const uint256 &hash,
+                        const std::vector<uint8_t> &vchSig) {
+    assert(vchSig.size() == CPubKey::SCHNORR_SIZE);
+    Entry &entry = m_entries.emplace_back();
+    entry.pubkey = pubkey;
+    entry.hash = hash;
+    std::copy(vchSig.begin(), vchSig.end(), entry.sig.begin());
+}
+
+bool CSchnorrBatch::Verify() const {
+    if (m_entries.size() == 1) {
+        return m_entries[0].pubkey.VerifySchnorr(m_entries[0].hash,
+                                                 m_entries[0].sig);
+    }
+
+    std::vector<secp256k1_pubkey> pubkeys(m_entries.size());
+    std::vector<const secp256k1_pubkey *> pubkey_ptrs;
+    std::vector<const uint8_t *> hash_ptrs;
+    std::vector<const uint8_t *> sig_ptrs;
+    pubkey_ptrs.reserve(m_entries.size());
+    hash_ptrs.reserve(m_entries.size());
+    sig_ptrs.reserve(m_entries.size());
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        const Entry &entry = m_entries[i];
+        if (!entry.pubkey.IsValid() ||
+            !secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkeys[i],
+                                       entry.pubkey.data(),
+                                       entry.pubkey.size())) {
+            return false;
+        }
+        pubkey_ptrs.push_back(&pubkeys[i]);
+        hash_ptrs.push_back(entry.hash.begin());
+        sig_ptrs.push_back(entry.sig.data());
+    }
+
+    for (size_t offset = 0; offset < m_entries.size();
+         offset += SECP256K1_SCHNORR_MAX_BATCH_SIZE) {
+        const size_t n = std::min<size_t>(SECP256K1_SCHNORR_MAX_BATCH_SIZE,
+                                          m_entries.size() - offset);
+        if (!secp256k1_schnorr_verify_batch(
+                secp256k1_context_verify, sig_ptrs.data() + offset,
+                hash_ptrs.data() + offset, pubkey_ptrs.data() + offset, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CPubKey::RecoverCompact(const uint256 &hash,
                              const std::vector<uint8_t> &vchSig) {
     if (vchSig.size() != COMPACT_SIGNATURE_SIZE) {
@@ -13,6 +13,7 @@
 
 #include <boost/range/adaptor/sliced.hpp>
 
+#include <array>
 #include <stdexcept>
 #include <vector>
 
@@ -193,6 +194,36 @@ public:
                 const ChainCode &cc) const;
 };
 
+/**
+ * A set of Schnorr signatures that are verified all at once, which is
+ * significantly faster than verifying them one by one.
+ */
+class CSchnorrBatch {
+private:
+    struct Entry {
+        CPubKey pubkey;
+        uint256 hash;
+        std::array<uint8_t, CPubKey::SCHNORR_SIZE> sig;
+    };
+
+    std::vector<Entry> m_entries;
+
+public:
+    //! Add a signature (=64 bytes) to the batch.
+    void Add(const CPubKey &pubkey, const uint256 &hash,
+             const std::vector<uint8_t> &vchSig);
+
+    /**
+     * Verify all the signatures in the batch. Returns false if any of them is
+     * invalid, without telling which one.
+     */
+    bool Verify() const;
+
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    void clear() { m_entries.clear(); }
+};
+
 struct CExtPubKey {
     uint8_t nDepth;
     uint8_t vchFingerprint[4];
@@ -90,6 +90,24 @@ public:
         return *this;
     }
 
+    /**
+     * Copy the tree without waiting for the in-flight writes to complete.
+     * This is only safe when called from the single thread that writes to the
+     * tree: no write can then be in flight, and unlike the copy constructor it
+     * never blocks on the readers.
+     */
+    RadixTree copyFromWriter() const {
+        RadixTree copy;
+        {
+            RCULock lock;
+            RadixElement e = root.load();
+            e.incrementRefCount();
+            copy.root = e;
+        }
+
+        return copy;
+    }
+
     /**
      * Move semantic.
      */
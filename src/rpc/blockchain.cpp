@@ -52,6 +52,7 @@ using node::CoinStatsHashType;
 using node::GetUTXOStats;
 using node::NodeContext;
 using node::ReadBlockFromDisk;
+using node::SnapshotChunk;
 using node::SnapshotMetadata;
 using node::UndoReadFromDisk;
 
@@ -2583,6 +2584,11 @@ static RPCHelpMan dumptxoutset() {
             {"path", RPCArg::Type::STR, RPCArg::Optional::NO,
              "path to the output file. If relative, will be prefixed by "
              "datadir."},
+            {"chunk_coins", RPCArg::Type::NUM, RPCArg::Default{0},
+             "If non-zero, write a chunked snapshot with this many coins per "
+             "chunk. The chunks are indexed and checksummed, so they can be "
+             "verified independently and decoded in parallel when the "
+             "snapshot is loaded. If zero, write a legacy snapshot."},
         },
         RPCResult{RPCResult::Type::OBJ,
                   "",
@@ -2601,8 +2607,11 @@ static RPCHelpMan dumptxoutset() {
                       {RPCResult::Type::NUM, "nchaintx",
                        "the number of transactions in the chain up to and "
                        "including the base block"},
+                      {RPCResult::Type::NUM, "chunks", /* optional */ true,
+                       "the number of chunks, for chunked snapshots"},
                   }},
-        RPCExamples{HelpExampleCli("dumptxoutset", "utxo.dat")},
+        RPCExamples{HelpExampleCli("dumptxoutset", "utxo.dat") +
+                    HelpExampleCli("dumptxoutset", "utxo.dat 50000")},
         [&](const RPCHelpMan &self, const Config &config,
             const JSONRPCRequest &request) -> UniValue {
             const ArgsManager &args{EnsureAnyArgsman(request.context)};
@@ -2622,11 +2631,25 @@ static RPCHelpMan dumptxoutset() {
                                        "move it out of the way first");
             }
 
+            uint32_t chunk_coins{0};
+            if (!request.params[1].isNull()) {
+                const int64_t chunk_coins_param{request.params[1].get_int64()};
+                if (chunk_coins_param < 0 ||
+                    chunk_coins_param > node::MAX_SNAPSHOT_CHUNK_COINS) {
+                    throw JSONRPCError(
+                        RPC_INVALID_PARAMETER,
+                        strprintf("chunk_coins must be between 0 and %d",
+                                  node::MAX_SNAPSHOT_CHUNK_COINS));
+                }
+                chunk_coins = chunk_coins_param;
+            }
+
             FILE *file{fsbridge::fopen(temppath, "wb")};
             AutoFile afile{file};
             NodeContext &node = EnsureAnyNodeContext(request.context);
-            UniValue result = CreateUTXOSnapshot(
-                node, node.chainman->ActiveChainstate(), afile, path, temppath);
+            UniValue result =
+                CreateUTXOSnapshot(node, node.chainman->ActiveChainstate(),
+                                   afile, path, temppath, chunk_coins);
             fs::rename(temppath, path);
 
             return result;
@@ -2636,7 +2659,7 @@ static RPCHelpMan dumptxoutset() {
 
 UniValue CreateUTXOSnapshot(NodeContext &node, Chainstate &chainstate,
                             AutoFile &afile, const fs::path &path,
-                            const fs::path &temppath) {
+                            const fs::path &temppath, uint32_t chunk_coins) {
     std::unique_ptr<CCoinsViewCursor> pcursor;
     std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex *tip;
@@ -2677,28 +2700,76 @@ UniValue CreateUTXOSnapshot(NodeContext &node, Chainstate &chainstate,
                   tip->nHeight, tip->GetBlockHash().ToString(),
                   fs::PathToString(path), fs::PathToString(temppath)));
 
-    SnapshotMetadata metadata{tip->GetBlockHash(), maybe_stats->coins_count,
-                              uint64_t(tip->GetChainTxCount())};
+    SnapshotMetadata metadata =
+        chunk_coins == 0
+            ? SnapshotMetadata{tip->GetBlockHash(), maybe_stats->coins_count,
+                               uint64_t(tip->GetChainTxCount())}
+            : SnapshotMetadata::Chunked(tip->GetBlockHash(),
+                                        maybe_stats->coins_count, chunk_coins);
 
+    // For chunked snapshots, this writes a zeroed chunk index of the final
+    // size which is filled in once all the chunks are written.
     afile << metadata;
 
     COutPoint key;
     Coin coin;
     unsigned int iter{0};
 
+    uint64_t offset{GetSerializeSize(metadata, PROTOCOL_VERSION)};
+    size_t chunk{0};
+    CDataStream chunk_data(SER_DISK, PROTOCOL_VERSION);
+    uint32_t chunk_data_coins{0};
+    const auto write_chunk = [&]() {
+        if (chunk >= metadata.m_chunks.size()) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR,
+                               "Unexpected number of coins in the UTXO set");
+        }
+        SnapshotChunk &entry = metadata.m_chunks[chunk++];
+        entry.m_offset = offset;
+        entry.m_size = chunk_data.size();
+        entry.m_checksum = Hash(chunk_data);
+        afile << MakeUCharSpan(chunk_data);
+        offset += chunk_data.size();
+        chunk_data.clear();
+        chunk_data_coins = 0;
+    };
+
     while (pcursor->Valid()) {
         if (iter % 5000 == 0) {
             node.rpc_interruption_point();
         }
         ++iter;
         if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            afile << key;
-            afile << coin;
+            if (chunk_coins == 0) {
+                afile << key;
+                afile << coin;
+            } else {
+                chunk_data << key;
+                chunk_data << coin;
+                if (++chunk_data_coins == chunk_coins) {
+                    write_chunk();
+                }
+            }
         }
 
         pcursor->Next();
     }
 
+    if (chunk_coins != 0) {
+        if (chunk_data_coins > 0) {
+            write_chunk();
+        }
+        if (chunk != metadata.m_chunks.size()) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR,
+                               "Unexpected number of coins in the UTXO set");
+        }
+        if (std::fseek(afile.Get(), 0, SEEK_SET) != 0) {
+            throw JSONRPCError(RPC_MISC_ERROR,
+                               "Unable to write the UTXO snapshot chunk index");
+        }
+        afile << metadata;
+    }
+
     afile.fclose();
 
     UniValue result(UniValue::VOBJ);
@@ -2710,6 +2781,9 @@ UniValue CreateUTXOSnapshot(NodeContext &node, Chainstate &chainstate,
     // Cast required because univalue doesn't have serialization specified for
     // `unsigned int`, nChainTx's type.
     result.pushKV("nchaintx", uint64_t{tip->nChainTx});
+    if (chunk_coins != 0) {
+        result.pushKV("chunks", uint64_t{metadata.m_chunks.size()});
+    }
     return result;
 }
 
@@ -49,10 +49,13 @@ UniValue blockheaderToJSON(const CBlockIndex *tip,
 
 /**
  * Helper to create UTXO snapshots given a chainstate and a file handle.
+ * @param[in] chunk_coins If non-zero, write a chunked snapshot with this many
+ *                        coins per chunk. The file must be seekable.
  * @return a UniValue map containing metadata about the snapshot.
  */
 UniValue CreateUTXOSnapshot(node::NodeContext &node, Chainstate &chainstate,
                             AutoFile &afile, const fs::path &path,
-                            const fs::path &tmppath);
+                            const fs::path &tmppath,
+                            uint32_t chunk_coins = 0);
 
 #endif // BITCOIN_RPC_BLOCKCHAIN_H
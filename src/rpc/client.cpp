@@ -68,6 +68,7 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     {"sendmany", 4, "subtractfeefrom"},
     {"deriveaddresses", 1, "range"},
     {"scantxoutset", 1, "scanobjects"},
+    {"dumptxoutset", 1, "chunk_coins"},
     {"addmultisigaddress", 0, "nrequired"},
     {"addmultisigaddress", 1, "keys"},
     {"createmultisig", 0, "nrequired"},
@@ -91,6 +92,8 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     {"signrawtransactionwithkey", 2, "prevtxs"},
     {"signrawtransactionwithwallet", 1, "prevtxs"},
     {"sendrawtransaction", 1, "maxfeerate"},
+    {"sendrawtransactions", 0, "rawtxs"},
+    {"sendrawtransactions", 1, "maxfeerate"},
     {"testmempoolaccept", 0, "rawtxs"},
     {"testmempoolaccept", 1, "maxfeerate"},
     {"combinerawtransaction", 0, "txs"},
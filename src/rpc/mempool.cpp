@@ -55,23 +55,20 @@ static std::vector<RPCResult> MempoolEntryDescription() {
     };
 }
 
-static void entryToJSON(const CTxMemPool &pool, UniValue &info,
-                        const CTxMemPoolEntryRef &e)
-    EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
-    AssertLockHeld(pool.cs);
-
+static void entryToJSON(const CTxMemPoolSnapshot &snapshot, UniValue &info,
+                        const CTxMemPoolSnapshotEntry &e) {
     UniValue fees(UniValue::VOBJ);
-    fees.pushKV("base", e->GetFee());
-    fees.pushKV("modified", e->GetModifiedFee());
+    fees.pushKV("base", e.fee);
+    fees.pushKV("modified", e.modifiedFee);
     info.pushKV("fees", fees);
 
-    info.pushKV("size", (int)e->GetTxSize());
-    info.pushKV("time", count_seconds(e->GetTime()));
-    info.pushKV("height", (int)e->GetHeight());
-    const CTransaction &tx = e->GetTx();
+    info.pushKV("size", (int)e.txSize);
+    info.pushKV("time", count_seconds(e.time));
+    info.pushKV("height", (int)e.height);
+    const CTransaction &tx = *e.tx;
     std::set<std::string> setDepends;
     for (const CTxIn &txin : tx.vin) {
-        if (pool.exists(txin.prevout.GetTxId())) {
+        if (snapshot.exists(txin.prevout.GetTxId())) {
             setDepends.insert(txin.prevout.GetTxId().ToString());
         }
     }
@@ -84,12 +81,12 @@ static void entryToJSON(const CTxMemPool &pool, UniValue &info,
     info.pushKV("depends", depends);
 
     UniValue spent(UniValue::VARR);
-    for (const auto &child : e->GetMemPoolChildrenConst()) {
-        spent.push_back(child.get()->GetTx().GetId().ToString());
+    for (const TxId &child : e.children) {
+        spent.push_back(child.ToString());
     }
 
     info.pushKV("spentby", spent);
-    info.pushKV("unbroadcast", pool.IsUnbroadcastTx(tx.GetId()));
+    info.pushKV("unbroadcast", e.unbroadcast);
 }
 
 UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose,
@@ -100,12 +97,12 @@ UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose,
                 RPC_INVALID_PARAMETER,
                 "Verbose results cannot contain mempool sequence values.");
         }
-        LOCK(pool.cs);
+        const auto snapshot = pool.GetSnapshot();
         UniValue o(UniValue::VOBJ);
-        for (const CTxMemPoolEntryRef &e : pool.mapTx) {
-            const TxId &txid = e->GetTx().GetId();
+        for (const auto &e : snapshot->GetEntries()) {
+            const TxId &txid = e->tx->GetId();
             UniValue info(UniValue::VOBJ);
-            entryToJSON(pool, info, e);
+            entryToJSON(*snapshot, info, *e);
             // Mempool has unique entries so there is no advantage in using
             // UniValue::pushKV, which checks if the key already exists in O(N).
             // UniValue::__pushKV is used instead which currently is O(1).
@@ -113,16 +110,20 @@ UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose,
         }
         return o;
     } else {
-        uint64_t mempool_sequence;
-        std::vector<TxId> vtxids;
-        {
+        uint64_t mempool_sequence{0};
+        RCUPtr<const CTxMemPoolSnapshot> snapshot;
+        if (include_mempool_sequence) {
+            // The sequence number is only updated after the snapshot is
+            // published, so the lock is needed for them to match.
             LOCK(pool.cs);
-            pool.getAllTxIds(vtxids);
+            snapshot = pool.GetSnapshot();
             mempool_sequence = pool.GetSequence();
+        } else {
+            snapshot = pool.GetSnapshot();
         }
         UniValue a(UniValue::VARR);
-        for (const TxId &txid : vtxids) {
-            a.push_back(txid.ToString());
+        for (const auto &e : snapshot->GetEntries()) {
+            a.push_back(e->tx->GetId().ToString());
         }
 
         if (!include_mempool_sequence) {
@@ -259,12 +260,13 @@ RPCHelpMan getmempoolancestors() {
                 }
                 return o;
             } else {
+                // The snapshot is up to date since mempool.cs is held.
+                const auto snapshot = mempool.GetSnapshot();
                 UniValue o(UniValue::VOBJ);
                 for (CTxMemPool::txiter ancestorIt : setAncestors) {
-                    const CTxMemPoolEntryRef &e = *ancestorIt;
-                    const TxId &_txid = e->GetTx().GetId();
+                    const TxId &_txid = (*ancestorIt)->GetTx().GetId();
                     UniValue info(UniValue::VOBJ);
-                    entryToJSON(mempool, info, e);
+                    entryToJSON(*snapshot, info, *snapshot->get(_txid));
                     o.pushKV(_txid.ToString(), info);
                 }
                 return o;
@@ -333,12 +335,13 @@ RPCHelpMan getmempooldescendants() {
 
                 return o;
             } else {
+                // The snapshot is up to date since mempool.cs is held.
+                const auto snapshot = mempool.GetSnapshot();
                 UniValue o(UniValue::VOBJ);
                 for (CTxMemPool::txiter descendantIt : setDescendants) {
-                    const CTxMemPoolEntryRef &e = *descendantIt;
-                    const TxId &_txid = e->GetTx().GetId();
+                    const TxId &_txid = (*descendantIt)->GetTx().GetId();
                     UniValue info(UniValue::VOBJ);
-                    entryToJSON(mempool, info, e);
+                    entryToJSON(*snapshot, info, *snapshot->get(_txid));
                     o.pushKV(_txid.ToString(), info);
                 }
                 return o;
@@ -363,16 +366,16 @@ RPCHelpMan getmempoolentry() {
             TxId txid(ParseHashV(request.params[0], "parameter 1"));
 
             const CTxMemPool &mempool = EnsureAnyMemPool(request.context);
-            LOCK(mempool.cs);
+            const auto snapshot = mempool.GetSnapshot();
 
-            CTxMemPool::txiter it = mempool.mapTx.find(txid);
-            if (it == mempool.mapTx.end()) {
+            const auto entry = snapshot->get(txid);
+            if (!entry) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
                                    "Transaction not in mempool");
             }
 
             UniValue info(UniValue::VOBJ);
-            entryToJSON(mempool, info, *it);
+            entryToJSON(*snapshot, info, *entry);
             return info;
         },
     };
@@ -978,7 +978,8 @@ static RPCHelpMan getblocktemplate() {
                 // Create new block
                 CScript scriptDummy = CScript() << OP_TRUE;
                 pblocktemplate =
-                    BlockAssembler{config, active_chainstate, &mempool}
+                    BlockAssembler{config, active_chainstate, &mempool,
+                                   node.block_template_selection.get()}
                         .CreateNewBlock(scriptDummy);
                 if (!pblocktemplate) {
                     throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
@@ -870,6 +870,124 @@ static RPCHelpMan sendrawtransaction() {
     };
 }
 
+/** Maximum number of transactions submitted by a sendrawtransactions call. */
+static constexpr size_t MAX_SENDRAWTRANSACTIONS_COUNT{1000};
+
+static RPCHelpMan sendrawtransactions() {
+    return RPCHelpMan{
+        "sendrawtransactions",
+        "Submits raw transactions (serialized, hex-encoded) to local node and "
+        "network.\n"
+        "\nThe result is the same as calling sendrawtransaction for each "
+        "transaction in order, but the scripts of the transactions that do not "
+        "depend on an earlier one are checked in parallel.\n"
+        "\nThe maximum number of transactions allowed is " +
+            ToString(MAX_SENDRAWTRANSACTIONS_COUNT) +
+            ".\n"
+            "\nSee sendrawtransaction call.\n",
+        {
+            {
+                "rawtxs",
+                RPCArg::Type::ARR,
+                RPCArg::Optional::NO,
+                "An array of hex strings of raw transactions.",
+                {
+                    {"rawtx", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED,
+                     ""},
+                },
+            },
+            {"maxfeerate", RPCArg::Type::AMOUNT,
+             RPCArg::Default{
+                 FormatMoney(DEFAULT_MAX_RAW_TX_FEE_RATE.GetFeePerK())},
+             "Reject transactions whose fee rate is higher than the specified "
+             "value, expressed in " +
+                 Currency::get().ticker +
+                 "/kB\nSet to 0 to accept any fee rate.\n"},
+        },
+        RPCResult{
+            RPCResult::Type::ARR,
+            "",
+            "The result of the submission of each raw transaction in the input "
+            "array, in the same order.",
+            {
+                {RPCResult::Type::OBJ,
+                 "",
+                 "",
+                 {
+                     {RPCResult::Type::STR_HEX, "txid",
+                      "The transaction hash in hex"},
+                     {RPCResult::Type::STR, "error",
+                      /*optional=*/true,
+                      "Rejection string (only present when the transaction "
+                      "was not submitted)"},
+                 }},
+            }},
+        RPCExamples{
+            HelpExampleCli("sendrawtransactions",
+                           R"('["signedhex1", "signedhex2"]')") +
+            "\nAs a JSON-RPC call\n" +
+            HelpExampleRpc("sendrawtransactions",
+                           "[\"signedhex1\", \"signedhex2\"]")},
+        [&](const RPCHelpMan &self, const Config &config,
+            const JSONRPCRequest &request) -> UniValue {
+            RPCTypeCheck(request.params,
+                         {
+                             UniValue::VARR,
+                             // VNUM or VSTR, checked inside AmountFromValue()
+                             UniValueType(),
+                         });
+            const UniValue raw_transactions = request.params[0].get_array();
+            if (raw_transactions.size() < 1 ||
+                raw_transactions.size() > MAX_SENDRAWTRANSACTIONS_COUNT) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER,
+                                   "Array must contain between 1 and " +
+                                       ToString(MAX_SENDRAWTRANSACTIONS_COUNT) +
+                                       " transactions.");
+            }
+
+            const CFeeRate max_raw_tx_fee_rate =
+                request.params[1].isNull()
+                    ? DEFAULT_MAX_RAW_TX_FEE_RATE
+                    : CFeeRate(AmountFromValue(request.params[1]));
+
+            std::vector<CTransactionRef> txns;
+            txns.reserve(raw_transactions.size());
+            for (const auto &rawtx : raw_transactions.getValues()) {
+                CMutableTransaction mtx;
+                if (!DecodeHexTx(mtx, rawtx.get_str())) {
+                    throw JSONRPCError(RPC_DESERIALIZATION_ERROR,
+                                       "TX decode failed: " + rawtx.get_str());
+                }
+                txns.emplace_back(MakeTransactionRef(std::move(mtx)));
+            }
+
+            std::vector<std::string> err_strings;
+            AssertLockNotHeld(cs_main);
+            NodeContext &node = EnsureAnyNodeContext(request.context);
+            const std::vector<TransactionError> errors = BroadcastTransactions(
+                node, txns, err_strings, max_raw_tx_fee_rate, /*relay=*/true);
+
+            // Block to make sure wallet/indexers sync before returning
+            SyncWithValidationInterfaceQueue();
+
+            UniValue rpc_result(UniValue::VARR);
+            for (size_t i = 0; i < txns.size(); ++i) {
+                UniValue result_inner(UniValue::VOBJ);
+                result_inner.pushKV("txid", txns[i]->GetId().GetHex());
+                if (errors[i] != TransactionError::OK) {
+                    result_inner.pushKV(
+                        "error",
+                        err_strings[i].empty()
+                            ? TransactionErrorString(errors[i]).original
+                            : err_strings[i]);
+                }
+                rpc_result.push_back(result_inner);
+            }
+            return rpc_result;
+        },
+    };
+}
+
 static RPCHelpMan testmempoolaccept() {
     return RPCHelpMan{
         "testmempoolaccept",
@@ -2099,6 +2217,7 @@ void RegisterRawTransactionRPCCommands(CRPCTable &t) {
         { "rawtransactions",    decoderawtransaction,       },
         { "rawtransactions",    decodescript,               },
         { "rawtransactions",    sendrawtransaction,         },
+        { "rawtransactions",    sendrawtransactions,        },
         { "rawtransactions",    combinerawtransaction,      },
         { "rawtransactions",    signrawtransactionwithkey,  },
         { "rawtransactions",    testmempoolaccept,          },
@@ -4,11 +4,14 @@
 
 #include <script/scriptcache.h>
 
+#include <clientversion.h>
 #include <crypto/sha256.h>
 #include <cuckoocache.h>
+#include <logging.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/sigcache.h>
+#include <streams.h>
 #include <sync.h>
 #include <util/system.h>
 #include <validation.h>
@@ -34,6 +37,10 @@ struct ScriptCacheElement {
         : key(keyIn), nSigChecks(nSigChecksIn) {}
 
     const KeyType &getKey() const { return key; }
+
+    SERIALIZE_METHODS(ScriptCacheElement, obj) {
+        READWRITE(obj.key, obj.nSigChecks);
+    }
 };
 
 static_assert(sizeof(ScriptCacheElement) == 32,
@@ -72,15 +79,22 @@ public:
 static CuckooCache::cache<ScriptCacheElement, ScriptCacheHasher>
     g_scriptExecutionCache;
 static CSHA256 g_scriptExecutionCacheHasher;
+//! Null until InitScriptExecutionCache is called
+static uint256 g_scriptExecutionCacheNonce;
 
-void InitScriptExecutionCache() {
-    // Setup the salted hasher
-    uint256 nonce = GetRandHash();
+static void SetScriptExecutionCacheNonce(const uint256 &nonce) {
+    g_scriptExecutionCacheNonce = nonce;
     // We want the nonce to be 64 bytes long to force the hasher to process
     // this chunk, which makes later hash computations more efficient. We
     // just write our 32-byte entropy twice to fill the 64 bytes.
+    g_scriptExecutionCacheHasher.Reset();
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
+}
+
+void InitScriptExecutionCache() {
+    // Setup the salted hasher
+    SetScriptExecutionCacheNonce(GetRandHash());
     // nMaxCacheSize is unsigned. If -maxscriptcachesize is set to zero,
     // setup_bytes creates the minimum possible cache (2 elements).
     size_t nMaxCacheSize =
@@ -95,6 +109,93 @@ void InitScriptExecutionCache() {
               (nElems * sizeof(uint256)) >> 20, nMaxCacheSize >> 20, nElems);
 }
 
+bool DumpScriptExecutionCache() {
+    if (g_scriptExecutionCacheNonce.IsNull()) {
+        // Don't overwrite the previous dump with an empty cache.
+        return false;
+    }
+
+    try {
+        uint256 nonce;
+        std::vector<ScriptCacheElement> elements;
+        {
+            LOCK(cs_main);
+            nonce = g_scriptExecutionCacheNonce;
+            g_scriptExecutionCache.for_each(
+                [&](const ScriptCacheElement &elem) {
+                    elements.push_back(elem);
+                });
+        }
+
+        FILE *filestr{fsbridge::fopen(
+            gArgs.GetDataDirNet() / "scriptcache.dat.new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << SIGCACHE_DUMP_VERSION;
+        file << nonce;
+        file << elements;
+
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(gArgs.GetDataDirNet() / "scriptcache.dat.new",
+                        gArgs.GetDataDirNet() / "scriptcache.dat")) {
+            throw std::runtime_error("Rename failed");
+        }
+        LogPrintf("Dumped %u script execution cache entries\n",
+                  elements.size());
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to dump script execution cache: %s. Continuing "
+                  "anyway.\n",
+                  e.what());
+        return false;
+    }
+    return true;
+}
+
+bool LoadScriptExecutionCache() {
+    FILE *filestr{
+        fsbridge::fopen(gArgs.GetDataDirNet() / "scriptcache.dat", "rb")};
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open script execution cache file from disk. "
+                  "Continuing anyway.\n");
+        return false;
+    }
+
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != SIGCACHE_DUMP_VERSION) {
+            return false;
+        }
+
+        uint256 nonce;
+        std::vector<ScriptCacheElement> elements;
+        file >> nonce;
+        file >> elements;
+
+        LOCK(cs_main);
+        // The keys are only meaningful under the salt they were computed with.
+        SetScriptExecutionCacheNonce(nonce);
+        for (const ScriptCacheElement &elem : elements) {
+            g_scriptExecutionCache.insert(elem);
+        }
+        LogPrintf("Imported %u script execution cache entries\n",
+                  elements.size());
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to deserialize script execution cache data on disk: "
+                  "%s. Continuing anyway.\n",
+                  e.what());
+        return false;
+    }
+    return true;
+}
+
 ScriptCacheKey::ScriptCacheKey(const CTransaction &tx, uint32_t flags) {
     std::array<uint8_t, 32> hash;
     CSHA256 hasher = g_scriptExecutionCacheHasher;
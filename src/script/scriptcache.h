@@ -8,6 +8,7 @@
 #include <array>
 #include <cstdint>
 
+#include <serialize.h>
 #include <sync.h>
 
 // Actually declared in validation.cpp; can't include because of circular
@@ -39,6 +40,8 @@ public:
         return rhs.data == data;
     }
 
+    SERIALIZE_METHODS(ScriptCacheKey, obj) { READWRITE(obj.data); }
+
     friend class ScriptCacheHasher;
 };
 
@@ -52,6 +55,16 @@ static const int64_t MAX_MAX_SCRIPT_CACHE_SIZE = 16384;
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
 
+/** Dump the script-execution cache, along with its salt, to disk. */
+bool DumpScriptExecutionCache() LOCKS_EXCLUDED(cs_main);
+
+/**
+ * Load the script-execution cache from disk. This replaces the salt of the
+ * cache, so it must be called after InitScriptExecutionCache and before the
+ * cache is used.
+ */
+bool LoadScriptExecutionCache() LOCKS_EXCLUDED(cs_main);
+
 /**
  * Check if a given key is in the cache, and if so, return its values.
  * (if not found, nSigChecks may or may not be set to an arbitrary value)
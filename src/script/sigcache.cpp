@@ -6,8 +6,11 @@
 #include <script/sigcache.h>
 
 #include <cuckoocache.h>
+#include <clientversion.h>
+#include <logging.h>
 #include <pubkey.h>
 #include <random.h>
+#include <streams.h>
 #include <uint256.h>
 #include <util/system.h>
 
@@ -26,6 +29,7 @@ namespace {
 class CSignatureCache {
 private:
     //! Entries are SHA256(nonce || signature hash || public key || signature):
+    uint256 m_nonce;
     CSHA256 m_salted_hasher;
     typedef CuckooCache::cache<CuckooCache::KeyOnly<uint256>,
                                SignatureCacheHasher>
@@ -34,14 +38,19 @@ private:
     std::shared_mutex cs_sigcache;
 
 public:
-    CSignatureCache() {
-        uint256 nonce = GetRandHash();
+    CSignatureCache() { SetNonce(GetRandHash()); }
+
+    //! Only safe to call while the cache is not used by any other thread.
+    void SetNonce(const uint256 &nonce) {
+        m_nonce = nonce;
         // We want the nonce to be 64 bytes long to force the hasher to process
         // this chunk, which makes later hash computations more efficient. We
         // just write our 32-byte entropy twice to fill the 64 bytes.
+        m_salted_hasher.Reset();
         m_salted_hasher.Write(nonce.begin(), 32);
         m_salted_hasher.Write(nonce.begin(), 32);
     }
+    const uint256 &GetNonce() const { return m_nonce; }
 
     void ComputeEntry(uint256 &entry, const uint256 &hash,
                       const std::vector<uint8_t> &vchSig,
@@ -62,7 +71,23 @@ public:
         std::unique_lock<std::shared_mutex> lock(cs_sigcache);
         setValid.insert(entry);
     }
-    uint32_t setup_bytes(size_t n) { return setValid.setup_bytes(n); }
+    std::vector<uint256> GetAll() {
+        std::shared_lock<std::shared_mutex> lock(cs_sigcache);
+        std::vector<uint256> entries;
+        setValid.for_each([&](const uint256 &entry) {
+            entries.push_back(entry);
+        });
+        return entries;
+    }
+
+    uint32_t setup_bytes(size_t n) {
+        m_setup = true;
+        return setValid.setup_bytes(n);
+    }
+    bool IsSetup() const { return m_setup; }
+
+private:
+    bool m_setup{false};
 };
 
 /**
@@ -86,12 +111,90 @@ void InitSignatureCache() {
                                                  DEFAULT_MAX_SIG_CACHE_SIZE)),
             MAX_MAX_SIG_CACHE_SIZE) *
         (size_t(1) << 20);
+    // Resizing the cache keeps its entries, so pick a new salt to start from
+    // an empty cache, as the script execution cache does.
+    signatureCache.SetNonce(GetRandHash());
     size_t nElems = signatureCache.setup_bytes(nMaxCacheSize);
     LogPrintf("Using %zu MiB out of %zu requested for signature cache, able to "
               "store %zu elements\n",
               (nElems * sizeof(uint256)) >> 20, nMaxCacheSize >> 20, nElems);
 }
 
+bool DumpSignatureCache() {
+    if (!signatureCache.IsSetup()) {
+        // Don't overwrite the previous dump with an empty cache.
+        return false;
+    }
+
+    try {
+        const std::vector<uint256> entries = signatureCache.GetAll();
+
+        FILE *filestr{
+            fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat.new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << SIGCACHE_DUMP_VERSION;
+        file << signatureCache.GetNonce();
+        file << entries;
+
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(gArgs.GetDataDirNet() / "sigcache.dat.new",
+                        gArgs.GetDataDirNet() / "sigcache.dat")) {
+            throw std::runtime_error("Rename failed");
+        }
+        LogPrintf("Dumped %u signature cache entries\n", entries.size());
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to dump signature cache: %s. Continuing anyway.\n",
+                  e.what());
+        return false;
+    }
+    return true;
+}
+
+bool LoadSignatureCache() {
+    FILE *filestr{
+        fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat", "rb")};
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open signature cache file from disk. Continuing "
+                  "anyway.\n");
+        return false;
+    }
+
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != SIGCACHE_DUMP_VERSION) {
+            return false;
+        }
+
+        uint256 nonce;
+        std::vector<uint256> entries;
+        file >> nonce;
+        file >> entries;
+
+        // The entries are only meaningful under the salt they were computed
+        // with.
+        signatureCache.SetNonce(nonce);
+        for (const uint256 &entry : entries) {
+            signatureCache.Set(entry);
+        }
+        LogPrintf("Imported %u signature cache entries\n", entries.size());
+    } catch (const std::exception &e) {
+        LogPrintf("Failed to deserialize signature cache data on disk: %s. "
+                  "Continuing anyway.\n",
+                  e.what());
+        return false;
+    }
+    return true;
+}
+
 template <typename F>
 bool RunMemoizedCheck(const std::vector<uint8_t> &vchSig, const CPubKey &pubkey,
                       const uint256 &sighash, bool storeOrErase, const F &fun) {
@@ -119,6 +222,17 @@ bool CachingTransactionSignatureChecker::IsCached(
 bool CachingTransactionSignatureChecker::VerifySignature(
     const std::vector<uint8_t> &vchSig, const CPubKey &pubkey,
     const uint256 &sighash) const {
+    // Signatures that are to be stored in the cache are verified on their own,
+    // since the batch is only verified once the checker is gone.
+    if (m_schnorr_batch && !store && vchSig.size() == CPubKey::SCHNORR_SIZE) {
+        // Only look the signature up, it must not be stored before the batch
+        // is verified.
+        if (!RunMemoizedCheck(vchSig, pubkey, sighash, store,
+                              [] { return false; })) {
+            m_schnorr_batch->Add(pubkey, sighash, vchSig);
+        }
+        return true;
+    }
     return RunMemoizedCheck(vchSig, pubkey, sighash, store, [&] {
         return TransactionSignatureChecker::VerifySignature(vchSig, pubkey,
                                                             sighash);
@@ -17,12 +17,27 @@
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
+/** Default for -persistsigcache */
+static const bool DEFAULT_PERSIST_SIGCACHE = true;
+/**
+ * Version of the signature and script execution cache files. It must be bumped
+ * whenever the meaning of the cached entries changes, so that stale entries are
+ * not loaded.
+ */
+static const uint64_t SIGCACHE_DUMP_VERSION = 1;
 
 class CPubKey;
+class CSchnorrBatch;
 
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker {
 private:
     bool store;
+    //! If set, Schnorr signatures that are not in the cache are added to this
+    //! batch and assumed to be valid, instead of being verified immediately.
+    //! The caller must verify the batch, and discard the script result if it
+    //! fails. The batch is not used if the signatures are to be stored in the
+    //! cache.
+    CSchnorrBatch *m_schnorr_batch;
 
     bool IsCached(const std::vector<uint8_t> &vchSig, const CPubKey &vchPubKey,
                   const uint256 &sighash) const;
@@ -31,9 +46,10 @@ public:
     CachingTransactionSignatureChecker(const CTransaction *txToIn,
                                        unsigned int nInIn,
                                        const Amount amountIn, bool storeIn,
-                                       PrecomputedTransactionData &txdataIn)
+                                       PrecomputedTransactionData &txdataIn,
+                                       CSchnorrBatch *schnorr_batch = nullptr)
         : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn),
-          store(storeIn) {}
+          store(storeIn), m_schnorr_batch(schnorr_batch) {}
 
     bool VerifySignature(const std::vector<uint8_t> &vchSig,
                          const CPubKey &vchPubKey,
@@ -44,4 +60,13 @@ public:
 
 void InitSignatureCache();
 
+/** Dump the signature cache, along with its salt, to disk. */
+bool DumpSignatureCache();
+
+/**
+ * Load the signature cache from disk. This replaces the salt of the cache, so
+ * it must be called after InitSignatureCache and before the cache is used.
+ */
+bool LoadSignatureCache();
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -28,6 +28,37 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify(
   const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** The maximum number of signatures that can be verified in a single batch. */
+# define SECP256K1_SCHNORR_MAX_BATCH_SIZE 65536
+
+/**
+ * Verify a batch of signatures created by secp256k1_schnorr_sign. This is
+ * significantly faster than verifying them one by one, but doesn't tell which
+ * signature is incorrect when the batch fails.
+ * Returns: 1: all the signatures are correct
+ *          0: at least one signature is incorrect, or the memory needed to
+ *             verify the batch could not be allocated
+ * Args:    ctx:         a secp256k1 context object, initialized for
+ *                       verification.
+ * In:      sigs64:      array of n_sigs pointers to the 64-byte signatures
+ *                       being verified (can only be NULL if n_sigs is 0)
+ *          msghashes32: array of n_sigs pointers to the 32-byte message hashes
+ *                       being verified (can only be NULL if n_sigs is 0). The
+ *                       same requirements as for secp256k1_schnorr_verify
+ *                       apply.
+ *          pubkeys:     array of n_sigs pointers to the public keys to verify
+ *                       with (can only be NULL if n_sigs is 0)
+ *          n_sigs:      number of signatures in the batch, at most
+ *                       SECP256K1_SCHNORR_MAX_BATCH_SIZE
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify_batch(
+  const secp256k1_context* ctx,
+  const unsigned char *const *sigs64,
+  const unsigned char *const *msghashes32,
+  const secp256k1_pubkey *const *pubkeys,
+  size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
 /**
  * Create a signature using a custom EC-Schnorr-SHA256 construction. It
  * produces non-malleable 64-byte signatures which support batch validation,
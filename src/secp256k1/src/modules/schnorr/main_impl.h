@@ -30,6 +30,54 @@ int secp256k1_schnorr_verify(
     return secp256k1_schnorr_sig_verify(&ctx->ecmult_ctx, sig64, &q, msghash32);
 }
 
+int secp256k1_schnorr_verify_batch(
+    const secp256k1_context* ctx,
+    const unsigned char *const *sigs64,
+    const unsigned char *const *msghashes32,
+    const secp256k1_pubkey *const *pubkeys,
+    size_t n_sigs
+) {
+    secp256k1_scratch *scratch;
+    secp256k1_scalar *scalars;
+    secp256k1_ge *points;
+    size_t i;
+    int ret = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n_sigs == 0 || sigs64 != NULL);
+    ARG_CHECK(n_sigs == 0 || msghashes32 != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    ARG_CHECK(n_sigs <= SECP256K1_SCHNORR_MAX_BATCH_SIZE);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(sigs64[i] != NULL);
+        ARG_CHECK(msghashes32[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n_sigs == 0) {
+        return 1;
+    }
+
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_schnorr_batch_scratch_size(n_sigs));
+    if (scratch == NULL) {
+        return 0;
+    }
+
+    scalars = (secp256k1_scalar *)secp256k1_scratch_alloc(&ctx->error_callback, scratch, 2 * n_sigs * sizeof(secp256k1_scalar));
+    points = (secp256k1_ge *)secp256k1_scratch_alloc(&ctx->error_callback, scratch, 2 * n_sigs * sizeof(secp256k1_ge));
+    if (scalars != NULL && points != NULL) {
+        ret = 1;
+        for (i = 0; i < n_sigs && ret; i++) {
+            ret = secp256k1_pubkey_load(ctx, &points[2 * i + 1], pubkeys[i]);
+        }
+        ret = ret && secp256k1_schnorr_sig_verify_batch(&ctx->error_callback, &ctx->ecmult_ctx, scratch, sigs64, msghashes32, scalars, points, n_sigs);
+    }
+
+    secp256k1_scratch_apply_checkpoint(&ctx->error_callback, scratch, 0);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    return ret;
+}
+
 int secp256k1_schnorr_sign(
     const secp256k1_context *ctx,
     unsigned char *sig64,
@@ -17,6 +17,19 @@ static int secp256k1_schnorr_sig_verify(
     const unsigned char *msg32
 );
 
+static size_t secp256k1_schnorr_batch_scratch_size(size_t n_sigs);
+
+static int secp256k1_schnorr_sig_verify_batch(
+    const secp256k1_callback *error_callback,
+    const secp256k1_ecmult_context *ctx,
+    secp256k1_scratch *scratch,
+    const unsigned char *const *sigs64,
+    const unsigned char *const *msgs32,
+    secp256k1_scalar *scalars,
+    secp256k1_ge *points,
+    size_t n_sigs
+);
+
 static int secp256k1_schnorr_compute_e(
     secp256k1_scalar* res,
     const unsigned char *r,
@@ -98,6 +98,135 @@ static int secp256k1_schnorr_sig_verify(
     return 1;
 }
 
+typedef struct {
+    const secp256k1_scalar *scalars;
+    const secp256k1_ge *points;
+} secp256k1_schnorr_batch_data;
+
+static int secp256k1_schnorr_batch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    const secp256k1_schnorr_batch_data *data = (const secp256k1_schnorr_batch_data *)cbdata;
+    *sc = data->scalars[idx];
+    *pt = data->points[idx];
+    return 1;
+}
+
+/**
+ * Scratch space needed to verify n_sigs signatures at once: one scalar and
+ * one point for each R and each public key, plus the space used by the
+ * multi-multiplication of all of them.
+ */
+static size_t secp256k1_schnorr_batch_scratch_size(size_t n_sigs) {
+    const size_t n_points = 2 * n_sigs;
+    size_t ecmult_size = secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS * ALIGNMENT;
+    const size_t pippenger_size = secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) + PIPPENGER_SCRATCH_OBJECTS * ALIGNMENT;
+    if (pippenger_size > ecmult_size) {
+        ecmult_size = pippenger_size;
+    }
+    return ROUND_TO_ALIGN(n_points * sizeof(secp256k1_scalar)) + ROUND_TO_ALIGN(n_points * sizeof(secp256k1_ge)) + ecmult_size;
+}
+
+/**
+ * Derive the randomizer of the signature at position idx in the batch. The
+ * seed commits to all the signatures, messages and public keys of the batch,
+ * so they can't be chosen to cancel each other out.
+ */
+static void secp256k1_schnorr_batch_randomizer(secp256k1_scalar *a, const unsigned char *seed32, size_t idx) {
+    secp256k1_sha256 sha;
+    unsigned char buf[32];
+    uint64_t idx64 = idx;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        buf[i] = (idx64 >> (8 * i)) & 0xff;
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, seed32, 32);
+    secp256k1_sha256_write(&sha, buf, 8);
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(a, buf, NULL);
+}
+
+/**
+ * Verify n_sigs signatures at once by checking that
+ *   sum(a_i * s_i) * G - sum(a_i * R_i) - sum(a_i * e_i * P_i) = 0
+ * where the a_i are pseudorandom and a_0 = 1. This holds for valid signatures,
+ * and for invalid ones with negligible probability. R_i is the point with the
+ * x coordinate from the signature and a quadratic residue y coordinate, which
+ * is the point the single signature verification expects.
+ *
+ * The public keys must be loaded in points[2 * i + 1]. Both the scalars and
+ * points arrays have 2 * n_sigs entries and are overwritten.
+ */
+static int secp256k1_schnorr_sig_verify_batch(
+    const secp256k1_callback *error_callback,
+    const secp256k1_ecmult_context *ctx,
+    secp256k1_scratch *scratch,
+    const unsigned char *const *sigs64,
+    const unsigned char *const *msgs32,
+    secp256k1_scalar *scalars,
+    secp256k1_ge *points,
+    size_t n_sigs
+) {
+    secp256k1_schnorr_batch_data data;
+    secp256k1_sha256 sha;
+    secp256k1_scalar a, as, g_sc;
+    secp256k1_gej rj;
+    secp256k1_fe rx;
+    unsigned char buf[32];
+    size_t i;
+    int overflow;
+
+    /* Extract s_i into scalars[2 * i], R_i into points[2 * i] and compute e_i
+     * into scalars[2 * i + 1], while hashing them into the seed. */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n_sigs; i++) {
+        VERIFY_CHECK(!secp256k1_ge_is_infinity(&points[2 * i + 1]));
+
+        overflow = 0;
+        secp256k1_scalar_set_b32(&scalars[2 * i], sigs64[i] + 32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+
+        if (!secp256k1_fe_set_b32(&rx, sigs64[i])) {
+            return 0;
+        }
+        if (!secp256k1_ge_set_xquad(&points[2 * i], &rx)) {
+            return 0;
+        }
+
+        /* e_i commits to R_i.x, P_i and the message. */
+        secp256k1_schnorr_compute_e(&scalars[2 * i + 1], sigs64[i], &points[2 * i + 1], msgs32[i]);
+        secp256k1_scalar_get_b32(buf, &scalars[2 * i + 1]);
+        secp256k1_sha256_write(&sha, buf, 32);
+        secp256k1_sha256_write(&sha, sigs64[i] + 32, 32);
+    }
+    secp256k1_sha256_finalize(&sha, buf);
+
+    /* Replace s_i with -a_i and e_i with -a_i * e_i, and accumulate the
+     * scalar for G. */
+    secp256k1_scalar_set_int(&g_sc, 0);
+    for (i = 0; i < n_sigs; i++) {
+        if (i == 0) {
+            secp256k1_scalar_set_int(&a, 1);
+        } else {
+            secp256k1_schnorr_batch_randomizer(&a, buf, i);
+        }
+        secp256k1_scalar_mul(&as, &a, &scalars[2 * i]);
+        secp256k1_scalar_add(&g_sc, &g_sc, &as);
+        secp256k1_scalar_negate(&scalars[2 * i], &a);
+        secp256k1_scalar_mul(&scalars[2 * i + 1], &scalars[2 * i + 1], &scalars[2 * i]);
+    }
+
+    data.scalars = scalars;
+    data.points = points;
+    if (!secp256k1_ecmult_multi_var(error_callback, ctx, scratch, &rj, &g_sc, secp256k1_schnorr_batch_callback, &data, 2 * n_sigs)) {
+        return 0;
+    }
+
+    return secp256k1_gej_is_infinity(&rj);
+}
+
 static int secp256k1_schnorr_compute_e(
     secp256k1_scalar* e,
     const unsigned char *r,
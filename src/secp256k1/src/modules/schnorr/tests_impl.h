@@ -78,6 +78,76 @@ void test_schnorr_sign_verify(void) {
 
 #undef SIG_COUNT
 
+#define BATCH_SIZE 64
+
+void test_schnorr_verify_batch(void) {
+    unsigned char privkey[32];
+    unsigned char msg[BATCH_SIZE][32];
+    unsigned char sig[BATCH_SIZE][64];
+    secp256k1_pubkey pubkey[BATCH_SIZE];
+    const unsigned char *sigptr[BATCH_SIZE];
+    const unsigned char *msgptr[BATCH_SIZE];
+    const secp256k1_pubkey *pubkeyptr[BATCH_SIZE];
+    size_t i, n;
+
+    for (i = 0; i < BATCH_SIZE; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey, &key);
+        secp256k1_testrand256_test(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], privkey) == 1);
+        CHECK(secp256k1_schnorr_sign(ctx, sig[i], msg[i], privkey, NULL, NULL) == 1);
+        sigptr[i] = sig[i];
+        msgptr[i] = msg[i];
+        pubkeyptr[i] = &pubkey[i];
+    }
+
+    /* An empty batch is valid. */
+    CHECK(secp256k1_schnorr_verify_batch(ctx, NULL, NULL, NULL, 0) == 1);
+
+    for (n = 1; n <= BATCH_SIZE; n += 1 + secp256k1_testrand_int(8)) {
+        size_t bad = secp256k1_testrand_int(n);
+        int pos = secp256k1_testrand_bits(6);
+        int mod = 1 + secp256k1_testrand_int(255);
+
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 1);
+
+        /* A single bad signature makes the whole batch fail. */
+        sig[bad][pos] ^= mod;
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 0);
+        sig[bad][pos] ^= mod;
+
+        /* So does a signature for another message. */
+        msg[bad][pos % 32] ^= mod;
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 0);
+        msg[bad][pos % 32] ^= mod;
+
+        /* Or another public key. */
+        if (n > 1) {
+            pubkeyptr[bad] = &pubkey[(bad + 1) % n];
+            CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 0);
+            pubkeyptr[bad] = &pubkey[bad];
+        }
+    }
+
+    /* Two invalid signatures can't be crafted to cancel each other out: add
+     * and subtract the same value to the s of two signatures. */
+    {
+        secp256k1_scalar s0, s1, delta;
+        random_scalar_order_test(&delta);
+        secp256k1_scalar_set_b32(&s0, sig[0] + 32, NULL);
+        secp256k1_scalar_set_b32(&s1, sig[1] + 32, NULL);
+        secp256k1_scalar_add(&s0, &s0, &delta);
+        secp256k1_scalar_negate(&delta, &delta);
+        secp256k1_scalar_add(&s1, &s1, &delta);
+        secp256k1_scalar_get_b32(sig[0] + 32, &s0);
+        secp256k1_scalar_get_b32(sig[1] + 32, &s1);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, 2) == 0);
+    }
+}
+
+#undef BATCH_SIZE
+
 void run_schnorr_compact_test(void) {
     {
         /* Test vector 1 */
@@ -516,6 +586,7 @@ void run_schnorr_tests(void) {
     }
 
     test_schnorr_sign_verify();
+    test_schnorr_verify_batch();
     run_schnorr_compact_test();
 }
 
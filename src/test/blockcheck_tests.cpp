@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <config.h>
 #include <consensus/consensus.h>
+#include <consensus/merkle.h>
 #include <consensus/validation.h>
 #include <validation.h>
 
@@ -100,4 +101,61 @@ BOOST_AUTO_TEST_CASE(blockfail) {
     RunCheckOnBlock(config, block, "bad-blk-length");
 }
 
+// Large blocks are checked on the worker threads, with the same outcome.
+BOOST_FIXTURE_TEST_CASE(large_block, ChainTestingSetup) {
+    GlobalConfig config;
+    config.SetMaxBlockSize(DEFAULT_MAX_BLOCK_SIZE);
+    const auto options = BlockValidationOptions(config).withCheckPoW(false);
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig.resize(10);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 42 * SATOSHI;
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(tx));
+    for (size_t i = 1; i < 5001; i++) {
+        tx.vin[0].prevout = InsecureRandOutPoint();
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+
+    const auto check = [&](const std::string &reason) {
+        BlockValidationState state;
+        block.fChecked = false;
+        BOOST_CHECK_EQUAL(
+            CheckBlock(block, state, config.GetChainParams().GetConsensus(),
+                       options),
+            reason.empty());
+        BOOST_CHECK_EQUAL(state.GetRejectReason(), reason);
+    };
+
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    check("");
+
+    // Bad merkle root.
+    block.hashMerkleRoot = InsecureRand256();
+    check("bad-txnmrklroot");
+
+    // Duplicating the last transaction doesn't change the merkle root, but is
+    // detected as a mutation.
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    block.vtx.push_back(block.vtx.back());
+    BOOST_CHECK(BlockMerkleRoot(block) == block.hashMerkleRoot);
+    check("bad-txns-duplicate");
+    block.vtx.pop_back();
+
+    // The first invalid transaction is reported.
+    CMutableTransaction no_output(*block.vtx[3000]);
+    no_output.vout.clear();
+    CMutableTransaction duplicate_input(*block.vtx[2000]);
+    duplicate_input.vin.push_back(duplicate_input.vin[0]);
+    block.vtx[3000] = MakeTransactionRef(no_output);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    check("bad-txns-vout-empty");
+    block.vtx[2000] = MakeTransactionRef(duplicate_input);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    check("bad-txns-inputs-duplicate");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
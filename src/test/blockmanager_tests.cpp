@@ -55,4 +55,94 @@ BOOST_AUTO_TEST_CASE(blockmanager_find_block_pos) {
             BLOCK_SERIALIZATION_HEADER_SIZE);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_index_pool) {
+    BlockManager blockman{};
+    LOCK(::cs_main);
+    for (int i = 0; i < 1000; ++i) {
+        blockman.InsertBlockIndex(BlockHash(InsecureRand256()));
+    }
+    // The entries are carved out of a single chunk of the pool.
+    const auto *resource = blockman.m_block_index.get_allocator().resource();
+    BOOST_CHECK_EQUAL(resource->ChunkSizeBytes(),
+                      node::BLOCK_INDEX_CHUNK_SIZE_BYTES);
+    BOOST_CHECK_EQUAL(resource->NumAllocatedChunks(), 1U);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_index_snapshot, TestChain100Setup) {
+    LOCK(::cs_main);
+    BlockManager &blockman = m_node.chainman->m_blockman;
+    const Consensus::Params &params = m_node.chainman->GetConsensus();
+
+    BOOST_CHECK(blockman.WriteBlockIndexSnapshot());
+    uint256 snapshot_hash;
+    BOOST_CHECK(
+        blockman.m_block_tree_db->ReadBlockIndexSnapshotHash(snapshot_hash));
+
+    auto check_loaded_index = [&](const BlockManager &loaded) {
+        BOOST_CHECK_EQUAL(loaded.m_block_index.size(),
+                          blockman.m_block_index.size());
+        for (const auto &[hash, index] : blockman.m_block_index) {
+            const CBlockIndex *pindex = loaded.LookupBlockIndex(hash);
+            BOOST_REQUIRE(pindex);
+            BOOST_CHECK_EQUAL(pindex->nHeight, index.nHeight);
+            BOOST_CHECK(pindex->nChainWork == index.nChainWork);
+            BOOST_CHECK(pindex->nStatus == index.nStatus);
+            BOOST_CHECK_EQUAL(pindex->nTx, index.nTx);
+            BOOST_CHECK_EQUAL(pindex->nChainTx, index.nChainTx);
+            BOOST_CHECK_EQUAL(pindex->GetBlockPos().nPos,
+                              index.GetBlockPos().nPos);
+            BOOST_CHECK(pindex->hashMerkleRoot == index.hashMerkleRoot);
+            BOOST_CHECK((pindex->pprev ? pindex->pprev->GetBlockHash()
+                                       : BlockHash()) ==
+                        (index.pprev ? index.pprev->GetBlockHash()
+                                     : BlockHash()));
+            BOOST_CHECK(pindex->GetAncestor(0) == loaded.LookupBlockIndex(
+                                                      params.hashGenesisBlock));
+        }
+    };
+
+    // Load the snapshot into another block manager sharing the database. The
+    // snapshot hash is erased once it is loaded.
+    BlockManager from_snapshot{};
+    from_snapshot.m_block_tree_db = std::move(blockman.m_block_tree_db);
+    BOOST_CHECK(from_snapshot.LoadBlockIndexDB(params));
+    check_loaded_index(from_snapshot);
+    BOOST_CHECK(!from_snapshot.m_block_tree_db->ReadBlockIndexSnapshotHash(
+        snapshot_hash));
+
+    // Without the hash, the block index is read from the database again.
+    BlockManager from_db{};
+    from_db.m_block_tree_db = std::move(from_snapshot.m_block_tree_db);
+    BOOST_CHECK(from_db.LoadBlockIndexDB(params));
+    check_loaded_index(from_db);
+
+    // A snapshot that doesn't match the recorded hash is ignored.
+    blockman.m_block_tree_db = std::move(from_db.m_block_tree_db);
+    BOOST_CHECK(blockman.m_block_tree_db->WriteBlockIndexSnapshotHash(
+        InsecureRand256()));
+    BlockManager mismatched{};
+    mismatched.m_block_tree_db = std::move(blockman.m_block_tree_db);
+    BOOST_CHECK(mismatched.LoadBlockIndexDB(params));
+    check_loaded_index(mismatched);
+    blockman.m_block_tree_db = std::move(mismatched.m_block_tree_db);
+
+    // The hash doesn't hide the last block file number from its readers.
+    int last_file;
+    BOOST_CHECK(blockman.m_block_tree_db->ReadLastBlockFile(last_file));
+    BOOST_CHECK(blockman.WriteBlockIndexSnapshot());
+    BOOST_CHECK(
+        blockman.m_block_tree_db->ReadBlockIndexSnapshotHash(snapshot_hash));
+    int last_file_with_hash;
+    BOOST_CHECK(
+        blockman.m_block_tree_db->ReadLastBlockFile(last_file_with_hash));
+    BOOST_CHECK_EQUAL(last_file_with_hash, last_file);
+
+    // Any write of the block index drops the hash, as does the write of a
+    // status change by a version that doesn't know about the snapshot.
+    BOOST_CHECK(blockman.m_block_tree_db->WriteBatchSync(
+        {}, last_file, {m_node.chainman->ActiveChain().Tip()}));
+    BOOST_CHECK(
+        !blockman.m_block_tree_db->ReadBlockIndexSnapshotHash(snapshot_hash));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -53,8 +53,10 @@ public:
 
     BlockHash GetBestBlock() const override { return hashBestBlock_; }
 
-    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override {
-        for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase = true) override {
+        for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();
+             erase ? it = mapCoins.erase(it) : ++it) {
             if (it->second.flags & CCoinsCacheEntry::DIRTY) {
                 // Same optimization used in CCoinsViewDB is to only write dirty
                 // entries.
@@ -64,7 +66,6 @@ public:
                     map_.erase(it->first);
                 }
             }
-            mapCoins.erase(it++);
         }
         if (!hashBlock.IsNull()) {
             hashBestBlock_ = hashBlock;
@@ -232,7 +233,9 @@ void SimulationTest(CCoinsView *base, bool fake_best_block) {
                     stack[flushIndex]->SetBestBlock(
                         BlockHash(InsecureRand256()));
                 }
-                BOOST_CHECK(stack[flushIndex]->Flush());
+                bool should_erase = InsecureRandRange(4) < 3;
+                BOOST_CHECK(should_erase ? stack[flushIndex]->Flush()
+                                         : stack[flushIndex]->Sync());
             }
         }
         if (InsecureRandRange(100) == 0) {
@@ -500,7 +503,9 @@ BOOST_AUTO_TEST_CASE(updatecoins_simulation_test) {
             // Every 100 iterations, flush an intermediate cache
             if (stack.size() > 1 && InsecureRandBool() == 0) {
                 unsigned int flushIndex = InsecureRandRange(stack.size() - 1);
-                BOOST_CHECK(stack[flushIndex]->Flush());
+                bool should_erase = InsecureRandRange(4) < 3;
+                BOOST_CHECK(should_erase ? stack[flushIndex]->Flush()
+                                         : stack[flushIndex]->Sync());
             }
         }
         if (InsecureRandRange(100) == 0) {
@@ -650,7 +655,8 @@ void GetCoinMapEntry(const CCoinsMap &map, Amount &value, char &flags) {
 }
 
 void WriteCoinViewEntry(CCoinsView &view, const Amount value, char flags) {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map{0, CCoinsMap::hasher{}, CCoinsMap::key_equal{}, &resource};
     InsertCoinMapEntry(map, value, flags);
     BOOST_CHECK(view.BatchWrite(map, BlockHash()));
 }
@@ -936,4 +942,289 @@ BOOST_AUTO_TEST_CASE(coin_write) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(coins_cache_entry_layout) {
+    CCoinsCacheEntry entry{
+        Coin(CTxOut(SATOSHI, CScript()), 1, false),
+        CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH};
+
+    // The flags live in the tail padding of the coin, so they must not be
+    // overwritten when the coin is.
+    Coin coin(CTxOut(2 * SATOSHI, CScript() << OP_TRUE), 0x7fffffff, true);
+    entry.coin = coin;
+    BOOST_CHECK_EQUAL(entry.flags,
+                      CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH);
+    entry.coin.Clear();
+    BOOST_CHECK_EQUAL(entry.flags,
+                      CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH);
+    entry.coin = std::move(coin);
+    BOOST_CHECK_EQUAL(entry.flags,
+                      CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH);
+    BOOST_CHECK_EQUAL(entry.coin.GetHeight(), 0x7fffffffU);
+    BOOST_CHECK(entry.coin.IsCoinBase());
+}
+
+BOOST_AUTO_TEST_CASE(coins_sync_and_trim) {
+    CCoinsViewTest base;
+    CCoinsViewCacheTest cache{&base};
+
+    auto make_coin = [](uint32_t height) {
+        return Coin(CTxOut(int64_t(height + 1) * SATOSHI,
+                           CScript() << OP_TRUE),
+                    height, false);
+    };
+
+    // Add coins at increasing heights and sync them with the base.
+    std::vector<COutPoint> outpoints;
+    for (uint32_t height = 0; height < 1000; ++height) {
+        outpoints.emplace_back(TxId(InsecureRand256()), 0);
+        cache.AddCoin(outpoints.back(), make_coin(height), false);
+    }
+    cache.SetBestBlock(BlockHash(InsecureRand256()));
+    BOOST_CHECK(cache.Sync());
+    cache.SelfTest();
+
+    // The coins are still cached and unmodified, and the base has them.
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), outpoints.size());
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        BOOST_CHECK(cache.HaveCoinInCache(outpoints[i]));
+        BOOST_CHECK_EQUAL(cache.map().at(outpoints[i]).flags, 0);
+        Coin coin;
+        BOOST_CHECK(base.GetCoin(outpoints[i], coin));
+        BOOST_CHECK(coin.GetTxOut() == make_coin(i).GetTxOut());
+    }
+
+    // Spent coins are written to the base and removed from the cache.
+    BOOST_CHECK(cache.SpendCoin(outpoints[500]));
+    BOOST_CHECK(cache.Sync());
+    cache.SelfTest();
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), outpoints.size() - 1);
+    BOOST_CHECK(!cache.HaveCoinInCache(outpoints[500]));
+    Coin coin;
+    BOOST_CHECK(!base.GetCoin(outpoints[500], coin) || coin.IsSpent());
+
+    // A modified coin is kept by Trim(), even if it is the oldest one.
+    BOOST_CHECK(cache.SpendCoin(outpoints[0]));
+    cache.AddCoin(outpoints[0], make_coin(0), false);
+
+    // Trimming to half the memory usage evicts the oldest coins.
+    cache.Trim(cache.DynamicMemoryUsage() / 2);
+    cache.SelfTest();
+    BOOST_CHECK(cache.GetCacheSize() < outpoints.size() * 6 / 10);
+    BOOST_CHECK(cache.GetCacheSize() > outpoints.size() * 3 / 10);
+    BOOST_CHECK(cache.HaveCoinInCache(outpoints[0]));
+    BOOST_CHECK(!cache.HaveCoinInCache(outpoints[1]));
+    BOOST_CHECK(cache.HaveCoinInCache(outpoints.back()));
+    size_t first_cached = 1;
+    while (!cache.HaveCoinInCache(outpoints[first_cached])) {
+        ++first_cached;
+    }
+    for (size_t i = first_cached; i < outpoints.size(); ++i) {
+        BOOST_CHECK_EQUAL(cache.HaveCoinInCache(outpoints[i]), i != 500);
+    }
+
+    // The evicted coins are read from the base again.
+    BOOST_CHECK(cache.GetCoin(outpoints[1], coin));
+    BOOST_CHECK(coin.GetTxOut() == make_coin(1).GetTxOut());
+}
+
+BOOST_AUTO_TEST_CASE(coins_background_flush) {
+    CCoinsViewDB db{"test", /*nCacheSize*/ 1 << 23, /*fMemory*/ true,
+                    /*fWipe*/ false};
+    CCoinsViewCache cache{&db};
+
+    auto make_coin = [](uint32_t n) {
+        return Coin(CTxOut(int64_t(n + 1) * SATOSHI, CScript() << OP_TRUE), n,
+                    false);
+    };
+
+    // Write a first set of coins to the database.
+    std::vector<COutPoint> old_outpoints;
+    for (uint32_t n = 0; n < 10000; ++n) {
+        old_outpoints.emplace_back(TxId(InsecureRand256()), n);
+        cache.AddCoin(old_outpoints.back(), make_coin(n), false);
+    }
+    const BlockHash old_block{InsecureRand256()};
+    cache.SetBestBlock(old_block);
+    BOOST_CHECK(cache.Flush());
+
+    // Spend half of them and add new ones, then write the changes in the
+    // background.
+    for (size_t n = 0; n < old_outpoints.size(); n += 2) {
+        BOOST_CHECK(cache.SpendCoin(old_outpoints[n]));
+    }
+    std::vector<COutPoint> new_outpoints;
+    for (uint32_t n = 0; n < 10000; ++n) {
+        new_outpoints.emplace_back(TxId(InsecureRand256()), n);
+        cache.AddCoin(new_outpoints.back(), make_coin(n), false);
+    }
+    const BlockHash new_block{InsecureRand256()};
+    cache.SetBestBlock(new_block);
+
+    CCoinsMapContent content = cache.TakeCoins();
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK_EQUAL(content.coins.size(), 20000U);
+    BOOST_CHECK(content.hashBlock == new_block);
+    BOOST_CHECK(db.BatchWriteInBackground(std::move(content)));
+
+    // Whether the flush completed or not, the database and the caches on top
+    // of it see the new state.
+    auto check_coins = [&](const CCoinsView &view) {
+        BOOST_CHECK(view.GetBestBlock() == new_block);
+        for (size_t n = 0; n < old_outpoints.size(); ++n) {
+            Coin coin;
+            const bool spent = n % 2 == 0;
+            BOOST_CHECK_EQUAL(view.HaveCoin(old_outpoints[n]), !spent);
+            BOOST_CHECK_EQUAL(view.GetCoin(old_outpoints[n], coin), !spent);
+            if (!spent) {
+                BOOST_CHECK(coin.GetTxOut() == make_coin(n).GetTxOut());
+            }
+        }
+        for (size_t n = 0; n < new_outpoints.size(); ++n) {
+            Coin coin;
+            BOOST_CHECK(view.GetCoin(new_outpoints[n], coin));
+            BOOST_CHECK(coin.GetTxOut() == make_coin(n).GetTxOut());
+        }
+    };
+    check_coins(cache);
+
+    // The cache can be flushed again while the previous flush is in progress.
+    cache.SpendCoin(new_outpoints[0]);
+    cache.AddCoin(new_outpoints[0], make_coin(0), false);
+    BOOST_CHECK(cache.Flush());
+
+    BOOST_CHECK(db.WaitForFlush());
+    BOOST_CHECK(!db.FlushFailed());
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+    check_coins(db);
+
+    // The cursors wait for the background flush in progress, and report the
+    // best block of the coins they iterate over.
+    BOOST_CHECK(cache.SpendCoin(new_outpoints[0]));
+    const BlockHash last_block{InsecureRand256()};
+    cache.SetBestBlock(last_block);
+    BOOST_CHECK(db.BatchWriteInBackground(cache.TakeCoins()));
+    std::unique_ptr<CCoinsViewCursor> cursor{db.Cursor()};
+    BOOST_CHECK(cursor->GetBestBlock() == last_block);
+    size_t count = 0;
+    for (; cursor->Valid(); cursor->Next()) {
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count,
+                      old_outpoints.size() / 2 + new_outpoints.size() - 1);
+}
+
+BOOST_AUTO_TEST_CASE(coins_background_flush_failure) {
+    CCoinsViewDB db{"test", /*nCacheSize*/ 1 << 23, /*fMemory*/ true,
+                    /*fWipe*/ false};
+    CCoinsViewCache cache{&db};
+
+    const Coin coin_in(CTxOut(SATOSHI, CScript() << OP_TRUE), 1, false);
+    const COutPoint old_outpoint{TxId(InsecureRand256()), 0};
+    cache.AddCoin(old_outpoint, Coin(coin_in), false);
+    const BlockHash old_block{InsecureRand256()};
+    cache.SetBestBlock(old_block);
+    BOOST_CHECK(cache.Flush());
+
+    // The background flush fails after the database was marked as being in
+    // the middle of the transition to the new block.
+    BOOST_CHECK(cache.SpendCoin(old_outpoint));
+    const COutPoint new_outpoint{TxId(InsecureRand256()), 0};
+    cache.AddCoin(new_outpoint, Coin(coin_in), false);
+    cache.SetBestBlock(BlockHash(InsecureRand256()));
+    db.TestOnlySimulateWriteFailure();
+    BOOST_CHECK(db.BatchWriteInBackground(cache.TakeCoins()));
+    BOOST_CHECK(!db.WaitForFlush());
+    BOOST_CHECK(db.FlushFailed());
+
+    // The reads don't fall through to the half-written database, whether the
+    // coins were part of the failed flush or not.
+    Coin coin;
+    BOOST_CHECK_THROW(db.GetCoin(old_outpoint, coin), dbwrapper_error);
+    BOOST_CHECK_THROW(db.GetCoin(new_outpoint, coin), dbwrapper_error);
+    BOOST_CHECK_THROW(db.HaveCoin(old_outpoint), dbwrapper_error);
+    BOOST_CHECK_THROW(db.HaveCoin(new_outpoint), dbwrapper_error);
+    BOOST_CHECK_THROW(db.GetBestBlock(), dbwrapper_error);
+    BOOST_CHECK_THROW(db.Cursor(), dbwrapper_error);
+    BOOST_CHECK_THROW(db.RangeCursors(2), dbwrapper_error);
+    BOOST_CHECK(coin.IsSpent());
+
+    // Nothing is written to the database anymore.
+    CCoinsMapContent content = cache.TakeCoins();
+    BOOST_CHECK(!db.BatchWrite(content.coins, old_block));
+    BOOST_CHECK(!db.BatchWriteInBackground(std::move(content)));
+}
+
+BOOST_AUTO_TEST_CASE(coins_range_cursors) {
+    CCoinsViewDB db{"test", /*nCacheSize*/ 1 << 23, /*fMemory*/ true,
+                    /*fWipe*/ false};
+    CCoinsViewCache cache{&db};
+
+    // Several outputs per transaction, so we can check that transactions are
+    // not split across ranges.
+    for (uint32_t n = 0; n < 3000; ++n) {
+        const TxId txid{InsecureRand256()};
+        for (uint32_t i = 0; i < 3; ++i) {
+            cache.AddCoin(COutPoint(txid, i),
+                          Coin(CTxOut(int64_t(n + 1) * SATOSHI,
+                                      CScript() << OP_TRUE),
+                               n, false),
+                          false);
+        }
+    }
+    cache.SetBestBlock(BlockHash{InsecureRand256()});
+    BOOST_CHECK(cache.Flush());
+
+    std::vector<COutPoint> expected;
+    std::unique_ptr<CCoinsViewCursor> cursor{db.Cursor()};
+    for (; cursor->Valid(); cursor->Next()) {
+        COutPoint outpoint;
+        BOOST_REQUIRE(cursor->GetKey(outpoint));
+        expected.push_back(outpoint);
+    }
+    BOOST_CHECK_EQUAL(expected.size(), 9000U);
+
+    for (size_t count : {1, 2, 3, 7, 16}) {
+        std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{
+            db.RangeCursors(count)};
+        BOOST_REQUIRE_EQUAL(cursors.size(), count);
+
+        // The ranges are consecutive and cover all the coins in order.
+        std::vector<COutPoint> outpoints;
+        for (auto &range_cursor : cursors) {
+            BOOST_CHECK(range_cursor->GetBestBlock() == db.GetBestBlock());
+            const size_t range_start{outpoints.size()};
+            for (; range_cursor->Valid(); range_cursor->Next()) {
+                COutPoint outpoint;
+                Coin coin;
+                BOOST_REQUIRE(range_cursor->GetKey(outpoint));
+                BOOST_REQUIRE(range_cursor->GetValue(coin));
+                outpoints.push_back(outpoint);
+            }
+            // All the outputs of a transaction are in the same range.
+            if (range_start > 0 && range_start < outpoints.size()) {
+                BOOST_CHECK(outpoints[range_start - 1].GetTxId() !=
+                            outpoints[range_start].GetTxId());
+            }
+            // With random txids, no range is empty.
+            BOOST_CHECK(outpoints.size() > range_start);
+        }
+        BOOST_CHECK(outpoints == expected);
+    }
+
+    // The cursors keep seeing the state they were created with.
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{db.RangeCursors(4)};
+    for (const COutPoint &outpoint : expected) {
+        cache.SpendCoin(outpoint);
+    }
+    BOOST_CHECK(cache.Flush());
+    size_t coins{0};
+    for (auto &range_cursor : cursors) {
+        for (; range_cursor->Valid(); range_cursor->Next()) {
+            ++coins;
+        }
+    }
+    BOOST_CHECK_EQUAL(coins, expected.size());
+    BOOST_CHECK(!std::unique_ptr<CCoinsViewCursor>{db.Cursor()}->Valid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
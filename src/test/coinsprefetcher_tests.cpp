@@ -0,0 +1,130 @@
+// Copyright (c) 2026 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/coinsprefetcher.h>
+
+#include <chainparams.h>
+#include <consensus/amount.h>
+#include <node/blockstorage.h>
+#include <script/standard.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+
+using node::CoinsPrefetcher;
+
+BOOST_FIXTURE_TEST_SUITE(coinsprefetcher_tests, TestChain100Setup)
+
+static CoinsPrefetcher::Prefetched WaitForBlock(CoinsPrefetcher &prefetcher,
+                                                const BlockHash &hash) {
+    const auto timeout = GetTime<std::chrono::seconds>() + 120s;
+    while (true) {
+        if (auto prefetched = prefetcher.Take(hash)) {
+            return std::move(*prefetched);
+        }
+        BOOST_REQUIRE(timeout > GetTime<std::chrono::milliseconds>());
+        UninterruptibleSleep(10ms);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_spent_coins) {
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+    const CScript script_pub_key =
+        GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+
+    // A block spending a mature coinbase output, and an output that is
+    // created by the block itself.
+    CMutableTransaction parent = CreateValidMempoolTransaction(
+        m_coinbase_txns[0], 0, 1, coinbaseKey, script_pub_key, 10 * COIN,
+        /*submit=*/false);
+    CMutableTransaction child = CreateValidMempoolTransaction(
+        MakeTransactionRef(parent), 0, 101, coinbaseKey, script_pub_key,
+        9 * COIN, /*submit=*/false);
+    const CBlock block =
+        CreateBlock({parent, child}, script_pub_key, chainstate);
+
+    FlatFilePos pos;
+    {
+        LOCK(cs_main);
+        pos = m_node.chainman->m_blockman.SaveBlockToDisk(
+            block, chainstate.m_chain.Height() + 1, chainstate.m_chain,
+            Params(), nullptr);
+        BOOST_REQUIRE(!pos.IsNull());
+        // Only the coins in the database are prefetched.
+        chainstate.ForceFlushStateToDisk();
+    }
+
+    const COutPoint prevout{m_coinbase_txns[0]->GetId(), 0};
+    const CCoinsView &db = WITH_LOCK(cs_main, return chainstate.CoinsDB());
+    CoinsPrefetcher prefetcher(db, Params().GetConsensus(), 2);
+
+    // Unknown blocks are never ready.
+    BOOST_CHECK(!prefetcher.Take(block.GetHash()));
+
+    prefetcher.Prefetch({{block.GetHash(), pos}});
+    auto prefetched = WaitForBlock(prefetcher, block.GetHash());
+    BOOST_REQUIRE(prefetched.block);
+    BOOST_CHECK(prefetched.block->GetHash() == block.GetHash());
+    BOOST_REQUIRE_EQUAL(prefetched.block->vtx.size(), 3U);
+    BOOST_CHECK(prefetched.block->vtx[1]->GetId() == block.vtx[1]->GetId());
+    BOOST_CHECK(prefetched.block->vtx[2]->GetId() == block.vtx[2]->GetId());
+    const auto &coins = prefetched.coins;
+    BOOST_REQUIRE_EQUAL(coins.size(), 1U);
+    BOOST_CHECK(coins.front().first == prevout);
+    BOOST_CHECK(coins.front().second.GetTxOut() ==
+                m_coinbase_txns[0]->vout[0]);
+    BOOST_CHECK(coins.front().second.IsCoinBase());
+
+    // The block is forgotten once its coins are taken.
+    BOOST_CHECK(!prefetcher.Take(block.GetHash()));
+
+    // Blocks that are dropped from the window are forgotten.
+    prefetcher.Prefetch({{block.GetHash(), pos}});
+    prefetcher.Prefetch({});
+    UninterruptibleSleep(100ms);
+    BOOST_CHECK(!prefetcher.Take(block.GetHash()));
+
+    // So are cleared blocks.
+    prefetcher.Prefetch({{block.GetHash(), pos}});
+    prefetcher.Clear();
+    UninterruptibleSleep(100ms);
+    BOOST_CHECK(!prefetcher.Take(block.GetHash()));
+
+    // Prefetched coins can be added to the cache when they are not in it.
+    CCoinsViewCache &coins_tip =
+        WITH_LOCK(cs_main, return chainstate.CoinsTip());
+    prefetcher.Prefetch({{block.GetHash(), pos}});
+    prefetched = WaitForBlock(prefetcher, block.GetHash());
+    LOCK(cs_main);
+    BOOST_CHECK(!coins_tip.HaveCoinInCache(prevout));
+    for (auto &[outpoint, coin] : prefetched.coins) {
+        coins_tip.EmplaceCoinFromBase(outpoint, std::move(coin));
+    }
+    BOOST_CHECK(coins_tip.HaveCoinInCache(prevout));
+    BOOST_CHECK(coins_tip.AccessCoin(prevout).GetTxOut() ==
+                m_coinbase_txns[0]->vout[0]);
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_wrong_block) {
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+    const CBlockIndex *tip =
+        WITH_LOCK(cs_main, return chainstate.m_chain.Tip());
+    const FlatFilePos pos = WITH_LOCK(cs_main, return tip->GetBlockPos());
+    const CCoinsView &db = WITH_LOCK(cs_main, return chainstate.CoinsDB());
+    CoinsPrefetcher prefetcher(db, Params().GetConsensus(), 1);
+
+    // A block that isn't found at the expected position is not handed out, so
+    // that the caller reads it again and reports the error.
+    prefetcher.Prefetch({{tip->pprev->GetBlockHash(), pos},
+                         {tip->GetBlockHash(), pos}});
+    WaitForBlock(prefetcher, tip->GetBlockHash());
+    BOOST_CHECK(!prefetcher.Take(tip->pprev->GetBlockHash()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
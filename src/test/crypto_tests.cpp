@@ -24,6 +24,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(crypto_tests, BasicTestingSetup)
@@ -1772,6 +1775,63 @@ BOOST_AUTO_TEST_CASE(sha3_256_tests) {
         "d894b86261436362e64241e61f6b3e6589daf64dc641f60570c4c0bf3b1f2ca3");
 }
 
+BOOST_AUTO_TEST_CASE(muhash_accelerated_tests) {
+    if (MuHash3072AutoDetect() == "standard") {
+        BOOST_TEST_MESSAGE("No accelerated MuHash implementation, skipping");
+        return;
+    }
+
+    // 2^3072 - 1, which is larger than the modulus.
+    Num3072 max;
+    std::fill(std::begin(max.limbs), std::end(max.limbs),
+              std::numeric_limits<Num3072::limb_t>::max());
+    // The modulus minus 1 and 2, which is the largest reduced number.
+    Num3072 p_minus_1 = max;
+    p_minus_1.limbs[0] -= 1103717;
+    Num3072 p_minus_2 = p_minus_1;
+    p_minus_2.limbs[0] -= 1;
+    // 2^3071, whose square needs a final reduction.
+    Num3072 half;
+    std::fill(std::begin(half.limbs), std::end(half.limbs), 0);
+    half.limbs[Num3072::LIMBS - 1] = Num3072::limb_t{1}
+                                     << (Num3072::LIMB_SIZE - 1);
+    Num3072 zero;
+    std::fill(std::begin(zero.limbs), std::end(zero.limbs), 0);
+
+    std::vector<Num3072> inputs{max, p_minus_1, p_minus_2, half, zero,
+                                Num3072()};
+    for (int i = 0; i < 20; ++i) {
+        uint8_t data[Num3072::BYTE_SIZE];
+        GetRandBytes(data);
+        inputs.emplace_back(data);
+    }
+
+    auto check = [](const Num3072 &a, const Num3072 &b) {
+        return std::equal(std::begin(a.limbs), std::end(a.limbs),
+                          std::begin(b.limbs));
+    };
+
+    for (const Num3072 &a : inputs) {
+        for (const Num3072 &b : inputs) {
+            Num3072 accelerated = a;
+            accelerated.Multiply(b);
+            MuHash3072AutoDetect(/*use_accelerated=*/false);
+            Num3072 portable = a;
+            portable.Multiply(b);
+            MuHash3072AutoDetect();
+            BOOST_CHECK(check(accelerated, portable));
+        }
+
+        Num3072 accelerated = a;
+        accelerated.Square();
+        MuHash3072AutoDetect(/*use_accelerated=*/false);
+        Num3072 portable = a;
+        portable.Square();
+        MuHash3072AutoDetect();
+        BOOST_CHECK(check(accelerated, portable));
+    }
+}
+
 static MuHash3072 FromInt(uint8_t i) {
     uint8_t tmp[32] = {i, 0};
     return MuHash3072(tmp);
@@ -9,6 +9,7 @@
 
 #include <deque>
 #include <mutex>
+#include <set>
 #include <shared_mutex>
 #include <thread>
 #include <vector>
@@ -532,4 +533,29 @@ BOOST_AUTO_TEST_CASE(cuckoocache_map) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(cuckoocache_for_each) {
+    SeedInsecureRand(SeedRand::ZEROS);
+    CuckooCacheSet cc{};
+    cc.setup_bytes(1 << 20);
+
+    std::vector<uint256> hashes;
+    for (int x = 0; x < 1000; ++x) {
+        hashes.push_back(InsecureRand256());
+        cc.insert(hashes.back());
+    }
+    // Erase half of the elements.
+    for (size_t i = 0; i < hashes.size(); i += 2) {
+        BOOST_CHECK(cc.contains(hashes[i], true));
+    }
+
+    // The cache is large enough that nothing got evicted, so exactly the
+    // elements that were not erased are enumerated.
+    std::set<uint256> found;
+    cc.for_each([&](const uint256 &h) { BOOST_CHECK(found.insert(h).second); });
+    BOOST_CHECK_EQUAL(found.size(), hashes.size() / 2);
+    for (size_t i = 1; i < hashes.size(); i += 2) {
+        BOOST_CHECK(found.count(hashes[i]));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
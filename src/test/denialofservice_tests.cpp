@@ -409,12 +409,80 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans) {
     }
 
     // Test LimitOrphanTxSize() function:
-    orphanage.LimitOrphans(40);
+    const size_t no_bytes_limit = std::numeric_limits<size_t>::max();
+    orphanage.LimitOrphans(40, no_bytes_limit);
     BOOST_CHECK(orphanage.CountOrphans() <= 40);
-    orphanage.LimitOrphans(10);
+    orphanage.LimitOrphans(10, no_bytes_limit);
     BOOST_CHECK(orphanage.CountOrphans() <= 10);
-    orphanage.LimitOrphans(0);
+    orphanage.LimitOrphans(0, no_bytes_limit);
     BOOST_CHECK(orphanage.CountOrphans() == 0);
+    BOOST_CHECK_EQUAL(orphanage.TotalOrphanBytes(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(DoS_orphans_per_peer_eviction) {
+    TxOrphanageTest orphanage;
+    LOCK(g_cs_orphans);
+
+    auto make_orphan = [](size_t output_script_size) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(TxId(InsecureRand256()), 0);
+        tx.vin[0].scriptSig << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 1 * CENT;
+        tx.vout[0].scriptPubKey =
+            CScript() << std::vector<uint8_t>(output_script_size, 0x42);
+        return MakeTransactionRef(tx);
+    };
+
+    // Peer 0 announces a few small orphans, peer 1 floods large ones.
+    std::vector<CTransactionRef> small_orphans;
+    for (int i = 0; i < 5; i++) {
+        small_orphans.push_back(make_orphan(100));
+        BOOST_CHECK(orphanage.AddTx(small_orphans.back(), 0));
+    }
+    const size_t small_bytes = orphanage.TotalOrphanBytes();
+    for (int i = 0; i < 20; i++) {
+        BOOST_CHECK(orphanage.AddTx(make_orphan(10000), 1));
+    }
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 25U);
+
+    // Going over the size limit only evicts the orphans of the flooding peer.
+    const size_t max_bytes = small_bytes + 100000;
+    BOOST_CHECK(orphanage.LimitOrphans(100, max_bytes) > 0);
+    BOOST_CHECK(orphanage.TotalOrphanBytes() <= max_bytes);
+    for (const auto &tx : small_orphans) {
+        BOOST_CHECK(orphanage.GetTx(tx->GetId()).first);
+    }
+
+    // Going over the count limit evicts from the peer with the most orphans.
+    const size_t nLarge = orphanage.CountOrphans() - small_orphans.size();
+    BOOST_CHECK(nLarge > small_orphans.size());
+    orphanage.LimitOrphans(2 * small_orphans.size(), max_bytes);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 2 * small_orphans.size());
+    for (const auto &tx : small_orphans) {
+        BOOST_CHECK(orphanage.GetTx(tx->GetId()).first);
+    }
+
+    // The children of a transaction are found through the spent outpoints.
+    std::set<TxId> work_set;
+    CMutableTransaction parent;
+    parent.vout.resize(1);
+    CMutableTransaction child;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint(parent.GetId(), 0);
+    child.vout.resize(1);
+    BOOST_CHECK(orphanage.AddTx(MakeTransactionRef(child), 2));
+    orphanage.AddChildrenToWorkSet(CTransaction(parent), work_set);
+    BOOST_CHECK(work_set == std::set<TxId>{child.GetId()});
+
+    // Erasing a peer's orphans leaves the other peers' orphans alone.
+    orphanage.EraseForPeer(1);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), small_orphans.size() + 1);
+    orphanage.EraseForPeer(0);
+    orphanage.EraseForPeer(2);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 0U);
+    BOOST_CHECK_EQUAL(orphanage.TotalOrphanBytes(), 0U);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -446,4 +446,62 @@ BOOST_AUTO_TEST_CASE(pubkey_unserialize) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(schnorr_batch) {
+    CSchnorrBatch batch;
+    // An empty batch is valid.
+    BOOST_CHECK(batch.Verify());
+
+    std::vector<CKey> keys(16);
+    std::vector<uint256> hashes(keys.size());
+    std::vector<std::vector<uint8_t>> sigs(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].MakeNewKey(i % 2 == 0);
+        hashes[i] = InsecureRand256();
+        BOOST_CHECK(keys[i].SignSchnorr(hashes[i], sigs[i]));
+        batch.Add(keys[i].GetPubKey(), hashes[i], sigs[i]);
+        BOOST_CHECK_EQUAL(batch.size(), i + 1);
+        BOOST_CHECK(batch.Verify());
+    }
+
+    auto verify_batch_with = [&](size_t bad, const CPubKey &pubkey,
+                                 const uint256 &hash,
+                                 const std::vector<uint8_t> &sig) {
+        CSchnorrBatch bad_batch;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (i == bad) {
+                bad_batch.Add(pubkey, hash, sig);
+            } else {
+                bad_batch.Add(keys[i].GetPubKey(), hashes[i], sigs[i]);
+            }
+        }
+        return bad_batch.Verify();
+    };
+
+    for (size_t bad = 0; bad < keys.size(); bad++) {
+        const size_t other = (bad + 1) % keys.size();
+        BOOST_CHECK(verify_batch_with(bad, keys[bad].GetPubKey(), hashes[bad],
+                                      sigs[bad]));
+
+        // Any invalid signature makes the batch fail.
+        BOOST_CHECK(!verify_batch_with(bad, keys[bad].GetPubKey(),
+                                       hashes[other], sigs[bad]));
+        BOOST_CHECK(!verify_batch_with(bad, keys[other].GetPubKey(),
+                                       hashes[bad], sigs[bad]));
+        std::vector<uint8_t> bad_sig = sigs[bad];
+        bad_sig[InsecureRandRange(bad_sig.size())] ^=
+            1 + InsecureRandRange(255);
+        BOOST_CHECK(!verify_batch_with(bad, keys[bad].GetPubKey(), hashes[bad],
+                                       bad_sig));
+
+        // So does an invalid public key.
+        BOOST_CHECK(!verify_batch_with(bad, CPubKey(), hashes[bad], sigs[bad]));
+    }
+
+    // A batch of a single signature is verified as well.
+    batch.clear();
+    BOOST_CHECK(batch.empty());
+    batch.Add(keys[0].GetPubKey(), hashes[1], sigs[0]);
+    BOOST_CHECK(!batch.Verify());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
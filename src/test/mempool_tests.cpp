@@ -139,6 +139,172 @@ BOOST_AUTO_TEST_CASE(MempoolClearTest) {
     BOOST_CHECK_EQUAL(testPool.mapNextTx.size(), 0UL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolEntryLinksTest) {
+    TestMemPoolEntryHelper entry;
+    // Enough children for the links not to fit inline.
+    const size_t nChildren = 5;
+    CMutableTransaction txParent;
+    txParent.vin.resize(1);
+    txParent.vin[0].scriptSig = CScript() << OP_11;
+    txParent.vout.resize(nChildren);
+    for (size_t i = 0; i < nChildren; i++) {
+        txParent.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txParent.vout[i].nValue = 33000 * SATOSHI;
+    }
+    std::vector<CMutableTransaction> txChildren(nChildren);
+    for (size_t i = 0; i < nChildren; i++) {
+        txChildren[i].vin.resize(1);
+        txChildren[i].vin[0].scriptSig = CScript() << OP_11;
+        txChildren[i].vin[0].prevout = COutPoint(txParent.GetId(), i);
+        txChildren[i].vout.resize(1);
+        txChildren[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txChildren[i].vout[0].nValue = 11000 * SATOSHI;
+    }
+
+    CTxMemPool &testPool = *Assert(m_node.mempool);
+    LOCK2(cs_main, testPool.cs);
+
+    const size_t emptyUsage = testPool.DynamicMemoryUsage();
+    testPool.addUnchecked(entry.FromTx(txParent));
+    for (const auto &txChild : txChildren) {
+        testPool.addUnchecked(entry.FromTx(txChild));
+    }
+    BOOST_CHECK_GT(testPool.DynamicMemoryUsage(), emptyUsage);
+
+    auto checkChildren = [&](std::vector<TxId> expected)
+        EXCLUSIVE_LOCKS_REQUIRED(testPool.cs) {
+            std::sort(expected.begin(), expected.end());
+            const CTxMemPool::txiter parentIt =
+                *testPool.GetIter(txParent.GetId());
+            const auto &children = (*parentIt)->GetMemPoolChildrenConst();
+            std::vector<TxId> txids;
+            for (const auto &child : children) {
+                txids.push_back(child.get()->GetTx().GetId());
+                // The child links back to the parent.
+                const auto &parents = child.get()->GetMemPoolParentsConst();
+                BOOST_CHECK_EQUAL(parents.size(), 1U);
+                BOOST_CHECK(parents.begin()->get()->GetTx().GetId() ==
+                            txParent.GetId());
+            }
+            BOOST_CHECK(txids == expected);
+        };
+
+    std::vector<TxId> childIds;
+    for (const auto &txChild : txChildren) {
+        childIds.push_back(txChild.GetId());
+    }
+    checkChildren(childIds);
+
+    // Removing children keeps the other links sorted.
+    for (size_t i : {3, 0}) {
+        testPool.removeRecursive(CTransaction(txChildren[i]),
+                                 REMOVAL_REASON_DUMMY);
+        childIds.erase(std::find(childIds.begin(), childIds.end(),
+                                 txChildren[i].GetId()));
+        checkChildren(childIds);
+    }
+
+    CTxMemPool::setEntries ancestors;
+    BOOST_CHECK(testPool.CalculateMemPoolAncestors(
+        *testPool.GetIter(txChildren[1].GetId()).value(), ancestors, false));
+    BOOST_CHECK_EQUAL(ancestors.size(), 1U);
+
+    testPool.removeRecursive(CTransaction(txParent), REMOVAL_REASON_DUMMY);
+    BOOST_CHECK_EQUAL(testPool.size(), 0U);
+    BOOST_CHECK_EQUAL(testPool.DynamicMemoryUsage(), emptyUsage);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolSnapshotTest) {
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction txParent;
+    txParent.vin.resize(1);
+    txParent.vin[0].scriptSig = CScript() << OP_11;
+    txParent.vout.resize(2);
+    for (int i = 0; i < 2; i++) {
+        txParent.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txParent.vout[i].nValue = 33000 * SATOSHI;
+    }
+    CMutableTransaction txChild[2];
+    for (int i = 0; i < 2; i++) {
+        txChild[i].vin.resize(1);
+        txChild[i].vin[0].scriptSig = CScript() << OP_11;
+        txChild[i].vin[0].prevout = COutPoint(txParent.GetId(), i);
+        txChild[i].vout.resize(1);
+        txChild[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txChild[i].vout[0].nValue = 11000 * SATOSHI;
+    }
+    const TxId parentId = txParent.GetId();
+    const TxId childIds[2] = {txChild[0].GetId(), txChild[1].GetId()};
+
+    CTxMemPool &testPool = *Assert(m_node.mempool);
+    LOCK2(cs_main, testPool.cs);
+
+    const auto emptySnapshot = testPool.GetSnapshot();
+    BOOST_CHECK_EQUAL(emptySnapshot->size(), 0UL);
+
+    testPool.addUnchecked(
+        entry.Fee(1000 * SATOSHI).Time(42).Height(7).FromTx(txParent));
+    for (int i = 0; i < 2; i++) {
+        testPool.addUnchecked(entry.FromTx(txChild[i]));
+    }
+    // The changes are only visible once published.
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot()->size(), 0UL);
+    testPool.PublishSnapshot();
+
+    auto snapshot = testPool.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot->size(), 3UL);
+    // Published snapshots are not modified.
+    BOOST_CHECK_EQUAL(emptySnapshot->size(), 0UL);
+    BOOST_CHECK(!emptySnapshot->exists(parentId));
+
+    auto parent = snapshot->get(parentId);
+    BOOST_REQUIRE(parent);
+    BOOST_CHECK(*parent->tx == CTransaction(txParent));
+    BOOST_CHECK_EQUAL(parent->fee, 1000 * SATOSHI);
+    BOOST_CHECK_EQUAL(parent->modifiedFee, 1000 * SATOSHI);
+    BOOST_CHECK_EQUAL(count_seconds(parent->time), 42);
+    BOOST_CHECK_EQUAL(parent->height, 7U);
+    BOOST_CHECK(!parent->unbroadcast);
+    std::vector<TxId> expectedChildren(std::begin(childIds),
+                                       std::end(childIds));
+    std::sort(expectedChildren.begin(), expectedChildren.end());
+    BOOST_CHECK(parent->children == expectedChildren);
+
+    // The entries are returned in topological order.
+    std::vector<TxId> txids;
+    for (const auto &e : snapshot->GetEntries()) {
+        txids.push_back(e->tx->GetId());
+    }
+    BOOST_CHECK(txids == std::vector<TxId>({parentId, childIds[0],
+                                            childIds[1]}));
+
+    testPool.PrioritiseTransaction(parentId, 500 * SATOSHI);
+    testPool.AddUnbroadcastTx(parentId);
+    parent = testPool.GetSnapshot()->get(parentId);
+    BOOST_CHECK_EQUAL(parent->modifiedFee, 1500 * SATOSHI);
+    BOOST_CHECK(parent->unbroadcast);
+    BOOST_CHECK_EQUAL(snapshot->get(parentId)->modifiedFee, 1000 * SATOSHI);
+
+    const std::vector<TxMempoolInfo> infos = testPool.infoAll();
+    BOOST_REQUIRE_EQUAL(infos.size(), 3UL);
+    BOOST_CHECK(infos[0].tx->GetId() == parentId);
+    BOOST_CHECK_EQUAL(infos[0].nFeeDelta, 500 * SATOSHI);
+
+    // Removing a child updates the parent.
+    testPool.removeRecursive(CTransaction(txChild[0]), REMOVAL_REASON_DUMMY);
+    testPool.PublishSnapshot();
+    parent = testPool.GetSnapshot()->get(parentId);
+    BOOST_CHECK(parent->children == std::vector<TxId>{childIds[1]});
+    BOOST_CHECK(!testPool.GetSnapshot()->exists(childIds[0]));
+    BOOST_CHECK(snapshot->exists(childIds[0]));
+
+    testPool.clear();
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot()->size(), 0UL);
+    BOOST_CHECK(!testPool.GetSnapshot()->exists(parentId));
+    BOOST_CHECK_EQUAL(snapshot->size(), 3UL);
+    BOOST_CHECK(snapshot->exists(parentId));
+}
+
 template <typename name>
 static void CheckSort(CTxMemPool &pool, std::vector<std::string> &sortedOrder,
                       const std::string &testcase)
@@ -214,6 +380,39 @@ BOOST_AUTO_TEST_CASE(MempoolIndexingTest) {
     CheckSort<modified_feerate>(pool, sortedOrder, "MempoolIndexingTest1");
 }
 
+BOOST_AUTO_TEST_CASE(MempoolPoolUsageTest) {
+    CTxMemPool &pool = *Assert(m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // Enough transactions for the nodes of mapTx to take several chunks.
+    std::vector<CMutableTransaction> txs(6000);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        txs[i].vout.resize(1);
+        txs[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txs[i].vout[0].nValue = int64_t(i + 1) * SATOSHI;
+    }
+
+    const size_t emptyUsage = pool.DynamicMemoryUsage();
+    for (const auto &tx : txs) {
+        pool.addUnchecked(entry.FromTx(tx));
+    }
+    const size_t fullUsage = pool.DynamicMemoryUsage();
+
+    // The chunks of the removed nodes are kept, and still counted.
+    for (const auto &tx : txs) {
+        pool.removeRecursive(CTransaction(tx), REMOVAL_REASON_DUMMY);
+    }
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+    BOOST_CHECK_GT(pool.DynamicMemoryUsage(), emptyUsage);
+
+    // They are reused by the next transactions.
+    for (const auto &tx : txs) {
+        pool.addUnchecked(entry.FromTx(tx));
+    }
+    BOOST_CHECK_EQUAL(pool.DynamicMemoryUsage(), fullUsage);
+}
+
 BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest) {
     CTxMemPool &pool = *Assert(m_node.mempool);
     LOCK2(cs_main, pool.cs);
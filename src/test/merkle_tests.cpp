@@ -374,4 +374,44 @@ BOOST_AUTO_TEST_CASE(merkle_test_LeftSubtreeRightSubtree) {
 
     BOOST_CHECK_EQUAL(root, rootOfLR);
 }
+BOOST_AUTO_TEST_CASE(merkle_test_subtrees) {
+    for (int i = 0; i < 64; i++) {
+        const uint32_t nleaves = 1 + InsecureRandRange(300);
+        std::vector<uint256> leaves;
+        for (uint32_t j = 0; j < nleaves; j++) {
+            leaves.push_back(InsecureRand256());
+        }
+        // Half of the time, mutate the tree by duplicating its last leaves.
+        const uint32_t duplicate = 1 << ctz(nleaves);
+        if ((i & 1) && duplicate < nleaves) {
+            for (uint32_t j = nleaves - duplicate; j < nleaves; j++) {
+                leaves.push_back(leaves[j]);
+            }
+        }
+
+        bool mutated;
+        const uint256 root = ComputeMerkleRoot(leaves, &mutated);
+
+        for (int height = 0; (size_t(1) << height) < leaves.size();
+             height++) {
+            const size_t subtree_leaves = size_t(1) << height;
+            std::vector<uint256> roots;
+            bool subtrees_mutated = false;
+            for (size_t begin = 0; begin < leaves.size();
+                 begin += subtree_leaves) {
+                bool subtree_mutated;
+                roots.push_back(ComputeMerkleSubtreeRoot(
+                    {leaves.begin() + begin,
+                     leaves.begin() +
+                         std::min(begin + subtree_leaves, leaves.size())},
+                    height, &subtree_mutated));
+                subtrees_mutated |= subtree_mutated;
+            }
+            bool top_mutated;
+            BOOST_CHECK(ComputeMerkleRoot(roots, &top_mutated) == root);
+            BOOST_CHECK_EQUAL(top_mutated || subtrees_mutated, mutated);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
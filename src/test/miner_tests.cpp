@@ -23,6 +23,7 @@
 #include <util/system.h>
 #include <util/time.h>
 #include <validation.h>
+#include <validationinterface.h>
 
 #include <test/util/mining.h>
 #include <test/util/setup_common.h>
@@ -32,6 +33,7 @@
 #include <memory>
 
 using node::BlockAssembler;
+using node::BlockTemplateSelection;
 using node::CBlockTemplate;
 using node::CBlockTemplateEntry;
 
@@ -852,4 +854,96 @@ BOOST_AUTO_TEST_CASE(TestCBlockTemplateEntry) {
     BOOST_CHECK_EQUAL(txEntry.sigChecks, 10);
 }
 
+static bool TemplateContains(const CBlockTemplate &blocktemplate,
+                             const TxId &txid) {
+    return std::any_of(blocktemplate.block.vtx.begin(),
+                       blocktemplate.block.vtx.end(),
+                       [&txid](const CTransactionRef &tx) {
+                           return tx->GetId() == txid;
+                       });
+}
+
+BOOST_FIXTURE_TEST_CASE(BlockTemplateSelection_updates, TestChain100Setup) {
+    const Config &config = GetConfig();
+    CTxMemPool &mempool = *m_node.mempool;
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    // Make the coinbase outputs of the first 3 blocks spendable.
+    for (int i = 0; i < 2; ++i) {
+        CreateAndProcessBlock({}, script);
+    }
+
+    BlockTemplateSelection selection(mempool);
+    RegisterValidationInterface(&selection);
+    auto createNewBlock = [&]() {
+        SyncWithValidationInterfaceQueue();
+        return BlockAssembler{config, chainstate, &mempool, &selection}
+            .CreateNewBlock(script);
+    };
+    // Add a transaction to the mempool without notifying the selection, so it
+    // only makes it to the block template when the selection is rebuilt.
+    auto addSilently = [&](const CTransactionRef &tx) {
+        LOCK2(cs_main, mempool.cs);
+        mempool.addUnchecked(
+            TestMemPoolEntryHelper().Fee(COIN).SpendsCoinbase(true).FromTx(
+                tx));
+    };
+
+    const CTransactionRef txParent =
+        MakeTransactionRef(CreateValidMempoolTransaction(
+            m_coinbase_txns[0], 0, 0, coinbaseKey, script, 49 * COIN));
+    auto blocktemplate = createNewBlock();
+    BOOST_CHECK(TemplateContains(*blocktemplate, txParent->GetId()));
+
+    // Transactions added to the mempool are added to the selection.
+    const CTransactionRef txChild =
+        MakeTransactionRef(CreateValidMempoolTransaction(
+            txParent, 0, 101, key, script, 48 * COIN));
+    const CTransactionRef txSilent1 =
+        MakeTransactionRef(CreateValidMempoolTransaction(
+            m_coinbase_txns[1], 0, 0, coinbaseKey, script, 49 * COIN,
+            /*submit=*/false));
+    addSilently(txSilent1);
+    blocktemplate = createNewBlock();
+    BOOST_CHECK(TemplateContains(*blocktemplate, txParent->GetId()));
+    BOOST_CHECK(TemplateContains(*blocktemplate, txChild->GetId()));
+    BOOST_CHECK(!TemplateContains(*blocktemplate, txSilent1->GetId()));
+
+    // Applying a fee delta rebuilds the selection.
+    mempool.PrioritiseTransaction(txSilent1->GetId(), Amount::zero());
+    blocktemplate = createNewBlock();
+    BOOST_CHECK(TemplateContains(*blocktemplate, txChild->GetId()));
+    BOOST_CHECK(TemplateContains(*blocktemplate, txSilent1->GetId()));
+
+    // So does removing a selected transaction, along with its descendants.
+    const CTransactionRef txSilent2 =
+        MakeTransactionRef(CreateValidMempoolTransaction(
+            m_coinbase_txns[2], 0, 0, coinbaseKey, script, 49 * COIN,
+            /*submit=*/false));
+    addSilently(txSilent2);
+    WITH_LOCK(mempool.cs, mempool.removeRecursive(
+                              *txParent, MemPoolRemovalReason::CONFLICT));
+    blocktemplate = createNewBlock();
+    BOOST_CHECK(!TemplateContains(*blocktemplate, txParent->GetId()));
+    BOOST_CHECK(!TemplateContains(*blocktemplate, txChild->GetId()));
+    BOOST_CHECK(TemplateContains(*blocktemplate, txSilent1->GetId()));
+    BOOST_CHECK(TemplateContains(*blocktemplate, txSilent2->GetId()));
+
+    // And so does a new tip.
+    const CBlock block =
+        CreateAndProcessBlock({CMutableTransaction(*txSilent1)}, script);
+    BOOST_CHECK(WITH_LOCK(cs_main, return m_node.chainman->ActiveTip()
+                                              ->GetBlockHash()) ==
+                block.GetHash());
+    blocktemplate = createNewBlock();
+    BOOST_CHECK(!TemplateContains(*blocktemplate, txSilent1->GetId()));
+    BOOST_CHECK(TemplateContains(*blocktemplate, txSilent2->GetId()));
+
+    UnregisterValidationInterface(&selection);
+    SyncWithValidationInterfaceQueue();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
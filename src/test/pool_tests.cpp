@@ -0,0 +1,147 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <support/allocators/pool.h>
+
+#include <coins.h>
+#include <memusage.h>
+#include <random.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating) {
+    auto resource = PoolResource<8, 8>(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 1024U);
+
+    // Blocks of the same size are carved out of the chunk one after the other.
+    void *block = resource.Allocate(8, 8);
+    void *next = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(static_cast<std::byte *>(next) -
+                          static_cast<std::byte *>(block),
+                      8);
+
+    // A deallocated block is reused by the next allocation of that size.
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK(resource.Allocate(8, 8) == block);
+
+    // Sizes that can't be served by the pool are allocated with new.
+    void *large = resource.Allocate(16, 8);
+    resource.Deallocate(large, 16, 8);
+    void *overaligned = resource.Allocate(8, 16);
+    resource.Deallocate(overaligned, 8, 16);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    resource.Deallocate(next, 8, 8);
+}
+
+BOOST_AUTO_TEST_CASE(allocate_any_byte) {
+    auto resource = PoolResource<128, 8>(1024);
+
+    // Fill all the sizes served by the pool, then check that every block of
+    // every size is distinct and reused once deallocated.
+    std::vector<std::pair<void *, size_t>> blocks;
+    std::set<void *> addresses;
+    for (size_t bytes = 0; bytes <= 128; ++bytes) {
+        void *p = resource.Allocate(bytes, 1);
+        BOOST_CHECK(addresses.insert(p).second);
+        // Write to the whole block, so the sanitizers catch any overlap.
+        std::fill_n(static_cast<uint8_t *>(p), bytes, uint8_t(bytes));
+        blocks.emplace_back(p, bytes);
+    }
+    // 129 blocks of up to 128 bytes don't fit in a single chunk.
+    BOOST_CHECK(resource.NumAllocatedChunks() > 1);
+    const size_t num_chunks = resource.NumAllocatedChunks();
+
+    for (const auto &[p, bytes] : blocks) {
+        resource.Deallocate(p, bytes, 1);
+    }
+    for (const auto &[p, bytes] : blocks) {
+        BOOST_CHECK(addresses.count(resource.Allocate(bytes, 1)));
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), num_chunks);
+}
+
+BOOST_AUTO_TEST_CASE(random_allocations) {
+    auto resource = PoolResource<128, 8>(65536);
+    using Map = std::unordered_map<
+        uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        PoolAllocator<std::pair<const uint64_t, uint64_t>, 128, 8>>;
+
+    Map map{0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{}, &resource};
+    std::unordered_map<uint64_t, uint64_t> reference;
+    for (int i = 0; i < 100000; ++i) {
+        const uint64_t key = InsecureRandRange(10000);
+        if (InsecureRandBool()) {
+            map[key] = i;
+            reference[key] = i;
+        } else {
+            map.erase(key);
+            reference.erase(key);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(map.size(), reference.size());
+    for (const auto &[key, value] : reference) {
+        auto it = map.find(key);
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, value);
+    }
+
+    // The erased nodes are reused, so the pool holds about as many nodes as
+    // the map ever held at once.
+    BOOST_CHECK(resource.NumAllocatedChunks() * resource.ChunkSizeBytes() <
+                4 * 10000 * 128);
+}
+
+BOOST_AUTO_TEST_CASE(memusage_test) {
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{},
+                  &resource};
+
+    // The usage of an empty map is the first chunk.
+    const size_t initial_usage = memusage::DynamicUsage(map);
+    BOOST_CHECK(initial_usage >= resource.ChunkSizeBytes());
+
+    // Allocations are accounted for by chunks, so the usage doesn't change
+    // while the first chunk has room left, save for the bucket array.
+    map.emplace(COutPoint(TxId(InsecureRand256()), 0), CCoinsCacheEntry{});
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map) -
+                          memusage::MallocUsage(sizeof(void *) *
+                                                map.bucket_count()),
+                      initial_usage -
+                          memusage::MallocUsage(sizeof(void *) * 1));
+
+    // The usage accounts for all the chunks.
+    for (int i = 0; i < 100000; ++i) {
+        map.emplace(COutPoint(TxId(InsecureRand256()), i),
+                    CCoinsCacheEntry{});
+    }
+    BOOST_CHECK(memusage::DynamicUsage(map) >=
+                resource.NumAllocatedChunks() * resource.ChunkSizeBytes() +
+                    sizeof(void *) * map.bucket_count());
+
+    // Clearing the map keeps the chunks for the next entries.
+    const size_t usage = memusage::DynamicUsage(map);
+    const size_t num_chunks = resource.NumAllocatedChunks();
+    map.clear();
+    for (int i = 0; i < 100000; ++i) {
+        map.emplace(COutPoint(TxId(InsecureRand256()), i),
+                    CCoinsCacheEntry{});
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), num_chunks);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), usage);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,8 +6,10 @@
 
 #include <script/sigcache.h>
 
+#include <clientversion.h>
 #include <key.h>
 #include <key_io.h>
+#include <script/scriptcache.h>
 #include <streams.h>
 #include <tinyformat.h>
 #include <util/strencodings.h>
@@ -115,4 +117,100 @@ BOOST_AUTO_TEST_CASE(sig_pubkey_hash_variations) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(persistence) {
+    CDataStream stream(
+        ParseHex(
+            "010000000122739e70fbee987a8be1788395a2f2e6ad18ccb7ff611cd798071539"
+            "dde3c38e000000000151ffffffff010000000000000000016a00000000"),
+        SER_NETWORK, PROTOCOL_VERSION);
+    CTransaction dummyTx(deserialize, stream);
+    PrecomputedTransactionData txdata(dummyTx);
+    CachingTransactionSignatureChecker checker(&dummyTx, 0, 0 * SATOSHI, true,
+                                               txdata);
+    TestCachingTransactionSignatureChecker testChecker(checker);
+
+    CKey key = DecodeSecret(strSecret1C);
+    CPubKey pubkey = key.GetPubKey();
+    uint256 hashMsg = Hash(std::string("Sigcache persistence"));
+    std::vector<uint8_t> sig;
+    BOOST_CHECK(key.SignECDSA(hashMsg, sig));
+
+    BOOST_CHECK(testChecker.VerifyAndStore(sig, pubkey, hashMsg));
+    {
+        LOCK(cs_main);
+        AddKeyInScriptCache(ScriptCacheKey(dummyTx, 0), 42);
+    }
+    BOOST_CHECK(DumpSignatureCache());
+    BOOST_CHECK(DumpScriptExecutionCache());
+
+    // Reinitializing empties the caches, and picks a new salt for the script
+    // execution cache.
+    InitSignatureCache();
+    InitScriptExecutionCache();
+    int nSigChecks;
+    BOOST_CHECK(!testChecker.IsCached(sig, pubkey, hashMsg));
+    BOOST_CHECK(!WITH_LOCK(cs_main, return IsKeyInScriptCache(
+                                        ScriptCacheKey(dummyTx, 0), false,
+                                        nSigChecks)));
+
+    BOOST_CHECK(LoadSignatureCache());
+    BOOST_CHECK(LoadScriptExecutionCache());
+    BOOST_CHECK(testChecker.IsCached(sig, pubkey, hashMsg));
+    BOOST_CHECK(WITH_LOCK(cs_main, return IsKeyInScriptCache(
+                                       ScriptCacheKey(dummyTx, 0), false,
+                                       nSigChecks)));
+    BOOST_CHECK_EQUAL(nSigChecks, 42);
+    BOOST_CHECK(!WITH_LOCK(cs_main, return IsKeyInScriptCache(
+                                        ScriptCacheKey(dummyTx, 1), false,
+                                        nSigChecks)));
+
+    // Files written with another version are ignored.
+    for (const char *filename : {"sigcache.dat", "scriptcache.dat"}) {
+        CAutoFile file(fsbridge::fopen(gArgs.GetDataDirNet() / filename, "wb"),
+                       SER_DISK, CLIENT_VERSION);
+        file << uint64_t(SIGCACHE_DUMP_VERSION + 1);
+    }
+    BOOST_CHECK(!LoadSignatureCache());
+    BOOST_CHECK(!LoadScriptExecutionCache());
+}
+
+BOOST_AUTO_TEST_CASE(schnorr_batch) {
+    CDataStream stream(
+        ParseHex(
+            "010000000122739e70fbee987a8be1788395a2f2e6ad18ccb7ff611cd798071539"
+            "dde3c38e000000000151ffffffff010000000000000000016a00000000"),
+        SER_NETWORK, PROTOCOL_VERSION);
+    CTransaction dummyTx(deserialize, stream);
+    PrecomputedTransactionData txdata(dummyTx);
+
+    CKey key = DecodeSecret(strSecret1C);
+    CPubKey pubkey = key.GetPubKey();
+    uint256 hashMsg = Hash(std::string("Sigcache Schnorr batch"));
+    std::vector<uint8_t> sig;
+    BOOST_CHECK(key.SignSchnorr(hashMsg, sig));
+
+    // Without storing, the signature is added to the batch and not cached.
+    CSchnorrBatch batch;
+    CachingTransactionSignatureChecker checker(&dummyTx, 0, 0 * SATOSHI, false,
+                                               txdata, &batch);
+    TestCachingTransactionSignatureChecker testChecker(checker);
+    BOOST_CHECK(testChecker.VerifyAndStore(sig, pubkey, hashMsg));
+    BOOST_CHECK_EQUAL(batch.size(), 1U);
+    BOOST_CHECK(batch.Verify());
+    BOOST_CHECK(!testChecker.IsCached(sig, pubkey, hashMsg));
+
+    // When storing, the signature is verified on its own and cached.
+    batch.clear();
+    CachingTransactionSignatureChecker store_checker(
+        &dummyTx, 0, 0 * SATOSHI, true, txdata, &batch);
+    TestCachingTransactionSignatureChecker store_test_checker(store_checker);
+    std::vector<uint8_t> bad_sig{sig};
+    bad_sig[0] ^= 0x01;
+    BOOST_CHECK(!store_test_checker.VerifyAndStore(bad_sig, pubkey, hashMsg));
+    BOOST_CHECK(store_test_checker.VerifyAndStore(sig, pubkey, hashMsg));
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK(store_test_checker.IsCached(sig, pubkey, hashMsg));
+    BOOST_CHECK(!store_test_checker.IsCached(bad_sig, pubkey, hashMsg));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
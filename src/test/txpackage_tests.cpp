@@ -421,4 +421,113 @@ BOOST_FIXTURE_TEST_CASE(package_submission_tests, TestChain100Setup) {
                           "txn-already-known");
     }
 }
+BOOST_FIXTURE_TEST_CASE(independent_transactions_tests, TestChain100Setup) {
+    const Config &config{GetConfig()};
+    CKey key;
+    key.MakeNewKey(true);
+    CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    // Make the coinbase outputs of the first 5 blocks spendable.
+    for (int i{0}; i < 4; ++i) {
+        CreateAndProcessBlock({}, locking_script);
+    }
+
+    // Unrelated transactions, one of them with a child, another one with a
+    // conflicting transaction, and a transaction with an invalid signature.
+    std::vector<CTransactionRef> txns;
+    for (size_t i{0}; i < 4; ++i) {
+        txns.push_back(MakeTransactionRef(CreateValidMempoolTransaction(
+            /*input_transaction=*/m_coinbase_txns[i], /*input_vout=*/0,
+            /*input_height=*/0, /*input_signing_key=*/coinbaseKey,
+            /*output_destination=*/locking_script,
+            /*output_amount=*/Amount(49 * COIN), /*submit=*/false)));
+    }
+    txns.push_back(MakeTransactionRef(CreateValidMempoolTransaction(
+        /*input_transaction=*/txns[0], /*input_vout=*/0,
+        /*input_height=*/105, /*input_signing_key=*/key,
+        /*output_destination=*/locking_script,
+        /*output_amount=*/Amount(48 * COIN), /*submit=*/false)));
+    txns.push_back(MakeTransactionRef(CreateValidMempoolTransaction(
+        /*input_transaction=*/m_coinbase_txns[1], /*input_vout=*/0,
+        /*input_height=*/0, /*input_signing_key=*/coinbaseKey,
+        /*output_destination=*/locking_script,
+        /*output_amount=*/Amount(48 * COIN), /*submit=*/false)));
+    auto mtx_bad_sig = CreateValidMempoolTransaction(
+        /*input_transaction=*/m_coinbase_txns[4], /*input_vout=*/0,
+        /*input_height=*/0, /*input_signing_key=*/coinbaseKey,
+        /*output_destination=*/locking_script,
+        /*output_amount=*/Amount(49 * COIN), /*submit=*/false);
+    std::vector<uint8_t> vchSig(mtx_bad_sig.vin[0].scriptSig.begin() + 1,
+                                mtx_bad_sig.vin[0].scriptSig.end());
+    vchSig[vchSig.size() - 2] ^= 0x01;
+    mtx_bad_sig.vin[0].scriptSig = CScript() << vchSig;
+    txns.push_back(MakeTransactionRef(mtx_bad_sig));
+
+    LOCK(cs_main);
+    const size_t initial_pool_size{m_node.mempool->size()};
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+
+    // When testing, each transaction is validated on its own.
+    {
+        const auto results = ProcessNewTransactions(
+            config, chainstate, *m_node.mempool, txns, /*test_accept=*/true);
+        BOOST_REQUIRE_EQUAL(results.size(), txns.size());
+        for (size_t i : {0, 1, 2, 3, 5}) {
+            BOOST_CHECK_MESSAGE(results[i].m_result_type ==
+                                    MempoolAcceptResult::ResultType::VALID,
+                                results[i].m_state.GetRejectReason());
+            BOOST_CHECK(results[i].m_base_fees == COIN ||
+                        results[i].m_base_fees == 2 * COIN);
+        }
+        BOOST_CHECK_EQUAL(results[4].m_state.GetResult(),
+                          TxValidationResult::TX_MISSING_INPUTS);
+        BOOST_CHECK(results[6].m_state.IsInvalid());
+        BOOST_CHECK_EQUAL(m_node.mempool->size(), initial_pool_size);
+    }
+
+    // When submitting, the result is the same as submitting the transactions
+    // one by one.
+    {
+        const auto results = ProcessNewTransactions(
+            config, chainstate, *m_node.mempool, txns, /*test_accept=*/false);
+        BOOST_REQUIRE_EQUAL(results.size(), txns.size());
+        for (size_t i : {0, 1, 2, 3, 4}) {
+            BOOST_CHECK_MESSAGE(results[i].m_result_type ==
+                                    MempoolAcceptResult::ResultType::VALID,
+                                results[i].m_state.GetRejectReason());
+            BOOST_CHECK(m_node.mempool->exists(txns[i]->GetId()));
+        }
+        BOOST_CHECK_EQUAL(results[5].m_state.GetRejectReason(),
+                          "txn-mempool-conflict");
+        BOOST_CHECK(results[6].m_state.IsInvalid());
+        BOOST_CHECK(!m_node.mempool->exists(txns[5]->GetId()));
+        BOOST_CHECK(!m_node.mempool->exists(txns[6]->GetId()));
+        BOOST_CHECK_EQUAL(m_node.mempool->size(), initial_pool_size + 5);
+
+        // The script checks of the valid transactions were cached, and the
+        // same result is obtained one by one.
+        const MempoolAcceptResult result_bad_sig =
+            m_node.chainman->ProcessTransaction(txns[6]);
+        BOOST_CHECK_EQUAL(result_bad_sig.m_state.GetRejectReason(),
+                          results[6].m_state.GetRejectReason());
+    }
+
+    // Transactions paying more than the maximum fee rate are rejected.
+    {
+        const CTransactionRef tx_high_fee =
+            MakeTransactionRef(CreateValidMempoolTransaction(
+                /*input_transaction=*/txns[4], /*input_vout=*/0,
+                /*input_height=*/105, /*input_signing_key=*/key,
+                /*output_destination=*/locking_script,
+                /*output_amount=*/Amount(47 * COIN), /*submit=*/false));
+        const auto results = ProcessNewTransactions(
+            config, chainstate, *m_node.mempool, {tx_high_fee},
+            /*test_accept=*/false, CFeeRate(1000 * SATOSHI));
+        BOOST_REQUIRE_EQUAL(results.size(), 1U);
+        BOOST_CHECK_EQUAL(results[0].m_state.GetRejectReason(),
+                          "max-fee-exceeded");
+        BOOST_CHECK(!m_node.mempool->exists(tx_high_fee->GetId()));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <script/sighashtype.h>
 #include <script/sign.h>
 #include <script/signingprovider.h>
+#include <timedata.h>
 #include <txmempool.h>
 #include <validation.h>
 
@@ -103,6 +104,117 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_block_doublespend, TestChain100Setup) {
     BOOST_CHECK_EQUAL(m_node.mempool->size(), 0U);
 }
 
+BOOST_FIXTURE_TEST_CASE(parallel_connect_block, TestChain100Setup) {
+    // Check that ConnectBlock accepts and rejects the same blocks, for the
+    // same reasons, with and without -parallelconnect.
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey())
+                                     << OP_CHECKSIG;
+
+    const auto Sign = [&](CMutableTransaction &tx, const Amount amount) {
+        std::vector<uint8_t> vchSig;
+        uint256 hash = SignatureHash(scriptPubKey, CTransaction(tx), 0,
+                                     SigHashType().withForkId(), amount);
+        BOOST_CHECK(coinbaseKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        tx.vin[0].scriptSig = CScript() << vchSig;
+    };
+
+    // Split a mature coinbase, and spend all the resulting outputs in the same
+    // block.
+    const Amount coinbaseValue = m_coinbase_txns[0]->vout[0].nValue;
+    CMutableTransaction fanout;
+    fanout.nVersion = 1;
+    fanout.vin.resize(1);
+    fanout.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetId(), 0);
+    fanout.vout.resize(10);
+    for (CTxOut &out : fanout.vout) {
+        out.nValue = coinbaseValue / 20;
+        out.scriptPubKey = scriptPubKey;
+    }
+    Sign(fanout, coinbaseValue);
+
+    std::vector<CMutableTransaction> txns{fanout};
+    for (uint32_t i = 0; i < fanout.vout.size(); i++) {
+        CMutableTransaction spend;
+        spend.nVersion = 1;
+        spend.vin.resize(1);
+        spend.vin[0].prevout = COutPoint(fanout.GetId(), i);
+        spend.vout.resize(1);
+        spend.vout[0].nValue = fanout.vout[i].nValue - 1000 * SATOSHI;
+        spend.vout[0].scriptPubKey = scriptPubKey;
+        Sign(spend, fanout.vout[i].nValue);
+        txns.push_back(spend);
+    }
+
+    // Double spend one of the outputs.
+    std::vector<CMutableTransaction> doubleSpend = txns;
+    doubleSpend.push_back(txns[1]);
+    doubleSpend.back().vout[0].nValue -= 1000 * SATOSHI;
+    Sign(doubleSpend.back(), fanout.vout[0].nValue);
+
+    // Spend more than the input value.
+    std::vector<CMutableTransaction> overspend = txns;
+    overspend[2].vout[0].nValue = fanout.vout[1].nValue + SATOSHI;
+    Sign(overspend[2], fanout.vout[1].nValue);
+
+    // Invalid signature.
+    std::vector<CMutableTransaction> badSig = txns;
+    badSig[3].vout[0].nValue -= SATOSHI;
+
+    const auto TestConnect = [&](const std::vector<CMutableTransaction> &vtx,
+                                 bool parallel) {
+        StopScriptCheckWorkerThreads();
+        g_parallel_connect = parallel;
+        StartScriptCheckWorkerThreads(2);
+
+        Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+        const CBlock block = CreateBlock(vtx, scriptPubKey, chainstate);
+        const Config &config = GetConfig();
+        BlockValidationState state;
+        LOCK(cs_main);
+        TestBlockValidity(state, config.GetChainParams(), chainstate, block,
+                          chainstate.m_chain.Tip(), GetAdjustedTime,
+                          BlockValidationOptions(config));
+        return state;
+    };
+
+    for (const auto &vtx : {txns, doubleSpend, overspend, badSig}) {
+        const BlockValidationState serialState = TestConnect(vtx, false);
+        const BlockValidationState parallelState = TestConnect(vtx, true);
+        BOOST_CHECK_EQUAL(serialState.IsValid(), parallelState.IsValid());
+        BOOST_CHECK_EQUAL(serialState.GetRejectReason(),
+                          parallelState.GetRejectReason());
+    }
+    BOOST_CHECK(TestConnect(txns, true).IsValid());
+    BOOST_CHECK_EQUAL(TestConnect(doubleSpend, true).GetRejectReason(),
+                      "bad-txns-inputs-missingorspent");
+    BOOST_CHECK_EQUAL(TestConnect(overspend, true).GetRejectReason(),
+                      "bad-txns-in-belowout");
+    BOOST_CHECK_EQUAL(TestConnect(badSig, true).GetRejectReason(),
+                      "blk-bad-inputs");
+
+    // Connecting the block for real yields the same UTXO set.
+    const CBlock block = CreateAndProcessBlock(txns, scriptPubKey);
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(m_node.chainman->ActiveTip()->GetBlockHash() ==
+                    block.GetHash());
+        const CCoinsViewCache &tip =
+            m_node.chainman->ActiveChainstate().CoinsTip();
+        for (const auto &ptx : block.vtx) {
+            const bool spent = ptx->GetId() == fanout.GetId();
+            for (uint32_t i = 0; i < ptx->vout.size(); i++) {
+                BOOST_CHECK_EQUAL(tip.HaveCoin(COutPoint(ptx->GetId(), i)),
+                                  !spent);
+            }
+        }
+    }
+
+    StopScriptCheckWorkerThreads();
+    g_parallel_connect = DEFAULT_PARALLEL_CONNECT;
+    StartScriptCheckWorkerThreads(2);
+}
+
 static inline bool
 CheckInputScripts(const CTransaction &tx, TxValidationState &state,
                   const CCoinsViewCache &view, const uint32_t flags,
@@ -607,6 +719,80 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, TestChain100Setup) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(schnorr_batch_script_checks, TestChain100Setup) {
+    const CScript p2pk_scriptPubKey =
+        CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // Spend 4 coinbase outputs, the first one with an ECDSA signature and the
+    // others with Schnorr signatures.
+    CMutableTransaction spend_tx;
+    spend_tx.nVersion = 1;
+    spend_tx.vin.resize(4);
+    for (size_t i = 0; i < spend_tx.vin.size(); i++) {
+        spend_tx.vin[i].prevout = COutPoint(m_coinbase_txns[i]->GetId(), 0);
+    }
+    spend_tx.vout.resize(1);
+    spend_tx.vout[0].nValue = 10 * COIN;
+    spend_tx.vout[0].scriptPubKey = p2pk_scriptPubKey;
+    for (size_t i = 0; i < spend_tx.vin.size(); i++) {
+        const uint256 sighash = SignatureHash(
+            p2pk_scriptPubKey, CTransaction(spend_tx), i,
+            SigHashType().withForkId(), m_coinbase_txns[i]->vout[0].nValue);
+        std::vector<uint8_t> vchSig;
+        if (i == 0) {
+            BOOST_CHECK(coinbaseKey.SignECDSA(sighash, vchSig));
+        } else {
+            BOOST_CHECK(coinbaseKey.SignSchnorr(sighash, vchSig));
+        }
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        spend_tx.vin[i].scriptSig = CScript() << vchSig;
+    }
+
+    auto run_checks = [&](const CMutableTransaction &mtx, int64_t limit,
+                          ScriptError &error) {
+        const CTransaction tx(mtx);
+        PrecomputedTransactionData txdata(tx);
+        CheckInputsLimiter limiter(limit);
+        std::vector<CScriptCheck> checks;
+        for (size_t i = 0; i < tx.vin.size(); i++) {
+            checks.emplace_back(m_coinbase_txns[i]->vout[0], tx, i,
+                                STANDARD_SCRIPT_VERIFY_FLAGS, false, txdata,
+                                nullptr, &limiter);
+        }
+        const bool ret = RunCheckBatch(checks);
+        // The checks stop at the first failure, which is the last one run.
+        error = ScriptError::OK;
+        for (const CScriptCheck &check : checks) {
+            if (check.GetScriptError() != ScriptError::OK) {
+                error = check.GetScriptError();
+                break;
+            }
+        }
+        return ret;
+    };
+
+    ScriptError error;
+    BOOST_CHECK(run_checks(spend_tx, 4, error));
+    BOOST_CHECK_EQUAL(error, ScriptError::OK);
+
+    // The sigchecks limit still applies.
+    BOOST_CHECK(!run_checks(spend_tx, 3, error));
+    BOOST_CHECK_EQUAL(error, ScriptError::SIGCHECKS_LIMIT_EXCEEDED);
+
+    // An invalid Schnorr signature makes the batch fail, and the checks are
+    // run again to report the actual error. The sigchecks of the first run
+    // are not counted, or the limit would be exceeded first.
+    for (size_t bad = 1; bad < spend_tx.vin.size(); bad++) {
+        CMutableTransaction bad_tx = spend_tx;
+        std::vector<uint8_t> vchSig(bad_tx.vin[bad].scriptSig.begin() + 1,
+                                    bad_tx.vin[bad].scriptSig.end());
+        vchSig[0] ^= 0x01;
+        bad_tx.vin[bad].scriptSig = CScript() << vchSig;
+        BOOST_CHECK(!run_checks(bad_tx, 4, error));
+        BOOST_CHECK_EQUAL(error, ScriptError::SIG_NULLFAIL);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(scriptcache_values) {
     LOCK(cs_main);
     // Test insertion and querying of keys&values from the script cache.
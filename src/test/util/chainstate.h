@@ -29,12 +29,16 @@ const auto NoMalleation = [](AutoFile &file, node::SnapshotMetadata &meta) {};
  * a snapshot is loaded into an otherwise mostly-uninitialized datadir. It also
  * allows us to test conditions that would otherwise cause shutdowns based on
  * the IBD chainstate going past the snapshot it generated.
+ *
+ * If `chunk_coins` is non-zero, a chunked snapshot with this many coins per
+ * chunk is created.
  */
 template <typename F = decltype(NoMalleation)>
 static bool CreateAndActivateUTXOSnapshot(TestingSetup *fixture,
                                           F malleation = NoMalleation,
                                           bool reset_chainstate = false,
-                                          bool in_memory_chainstate = false) {
+                                          bool in_memory_chainstate = false,
+                                          uint32_t chunk_coins = 0) {
     node::NodeContext &node = fixture->m_node;
     fs::path root = fixture->m_path_root;
 
@@ -48,7 +52,8 @@ static bool CreateAndActivateUTXOSnapshot(TestingSetup *fixture,
 
     UniValue result =
         CreateUTXOSnapshot(node, node.chainman->ActiveChainstate(),
-                           auto_outfile, snapshot_path, snapshot_path);
+                           auto_outfile, snapshot_path, snapshot_path,
+                           chunk_coins);
     BOOST_TEST_MESSAGE("Wrote UTXO snapshot to "
                        << fs::PathToString(snapshot_path.make_preferred())
                        << ": " << result.write());
@@ -11,6 +11,7 @@
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
 #include <consensus/validation.h>
+#include <crypto/muhash.h>
 #include <crypto/sha256.h>
 #include <init.h>
 #include <interfaces/chain.h>
@@ -148,6 +149,7 @@ BasicTestingSetup::BasicTestingSetup(
     AppInitParameterInteraction(config, *m_node.args);
     LogInstance().StartLogging();
     SHA256AutoDetect();
+    MuHash3072AutoDetect();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <node/coinstats.h>
 #include <node/utxo_snapshot.h>
 #include <random.h>
 #include <rpc/blockchain.h>
@@ -21,6 +22,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+using node::CCoinsStats;
+using node::CoinStatsHashType;
+using node::SerializedCoinsHasher;
 using node::SnapshotMetadata;
 
 BOOST_FIXTURE_TEST_SUITE(validation_chainstatemanager_tests, ChainTestingSetup)
@@ -414,6 +418,157 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot,
     this->SetupSnapshot();
 }
 
+//! Test activation of a chunked snapshot.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_chunked_snapshot,
+                        SnapshotTestSetup) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+
+    // Move to the height of the regtest assumeutxo data.
+    mineBlocks(10);
+
+    // Use small chunks so that the snapshot has several of them, the last one
+    // being partial.
+    constexpr uint32_t chunk_coins{7};
+
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        this,
+        [](AutoFile &auto_infile, SnapshotMetadata &metadata) {
+            BOOST_REQUIRE(metadata.IsChunked());
+            BOOST_REQUIRE_EQUAL(metadata.m_chunks.size(), 16U);
+            // Corrupted chunk
+            metadata.m_chunks[3].m_checksum = uint256::ONE;
+        },
+        /*reset_chainstate=*/false, /*in_memory_chainstate=*/false,
+        chunk_coins));
+    BOOST_CHECK(!node::FindSnapshotChainstateDir());
+
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        this,
+        [](AutoFile &auto_infile, SnapshotMetadata &metadata) {
+            // The chunk index doesn't cover all the coins
+            metadata.m_coins_count += chunk_coins;
+        },
+        /*reset_chainstate=*/false, /*in_memory_chainstate=*/false,
+        chunk_coins));
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        this,
+        [](AutoFile &auto_infile, SnapshotMetadata &metadata) {
+            // The chunks are not contiguous
+            metadata.m_chunks[1].m_offset += 1;
+        },
+        /*reset_chainstate=*/false, /*in_memory_chainstate=*/false,
+        chunk_coins));
+
+    BOOST_REQUIRE(CreateAndActivateUTXOSnapshot(
+        this, NoMalleation, /*reset_chainstate=*/false,
+        /*in_memory_chainstate=*/false, chunk_coins));
+    BOOST_CHECK(chainman.IsSnapshotActive());
+    BOOST_CHECK_EQUAL(WITH_LOCK(::cs_main, return chainman.ActiveHeight()),
+                      110);
+}
+
+//! Test that both snapshot formats survive a serialization round trip.
+BOOST_AUTO_TEST_CASE(chainstatemanager_snapshot_metadata) {
+    const BlockHash base_blockhash{InsecureRand256()};
+
+    const SnapshotMetadata legacy{base_blockhash, 123, 0};
+    CDataStream legacy_stream(SER_DISK, PROTOCOL_VERSION);
+    legacy_stream << legacy;
+    // Legacy snapshots have no version header.
+    BOOST_CHECK_EQUAL(legacy_stream.size(), 32U + 8U);
+    SnapshotMetadata read_legacy;
+    legacy_stream >> read_legacy;
+    BOOST_CHECK(!read_legacy.IsChunked());
+    BOOST_CHECK_EQUAL(read_legacy.m_base_blockhash, base_blockhash);
+    BOOST_CHECK_EQUAL(read_legacy.m_coins_count, 123U);
+
+    SnapshotMetadata chunked =
+        SnapshotMetadata::Chunked(base_blockhash, 123, 50);
+    BOOST_REQUIRE_EQUAL(chunked.m_chunks.size(), 3U);
+    BOOST_CHECK_EQUAL(chunked.GetChunkCoins(0), 50U);
+    BOOST_CHECK_EQUAL(chunked.GetChunkCoins(2), 23U);
+    const uint64_t data_offset{GetSerializeSize(chunked, PROTOCOL_VERSION)};
+    for (size_t i = 0; i < chunked.m_chunks.size(); ++i) {
+        chunked.m_chunks[i].m_offset = data_offset + 100 * i;
+        chunked.m_chunks[i].m_size = 100;
+        chunked.m_chunks[i].m_checksum = InsecureRand256();
+    }
+    BOOST_CHECK(chunked.CheckChunks(data_offset));
+    BOOST_CHECK(!chunked.CheckChunks(data_offset + 1));
+
+    CDataStream chunked_stream(SER_DISK, PROTOCOL_VERSION);
+    chunked_stream << chunked;
+    SnapshotMetadata read_chunked;
+    chunked_stream >> read_chunked;
+    BOOST_CHECK(read_chunked.IsChunked());
+    BOOST_CHECK_EQUAL(read_chunked.m_base_blockhash, base_blockhash);
+    BOOST_CHECK_EQUAL(read_chunked.m_coins_count, 123U);
+    BOOST_CHECK_EQUAL(read_chunked.m_chunk_coins, 50U);
+    BOOST_REQUIRE_EQUAL(read_chunked.m_chunks.size(), 3U);
+    BOOST_CHECK_EQUAL(read_chunked.m_chunks[2].m_checksum,
+                      chunked.m_chunks[2].m_checksum);
+    BOOST_CHECK(read_chunked.CheckChunks(data_offset));
+
+    // Unknown versions are rejected.
+    CDataStream future_stream(SER_DISK, PROTOCOL_VERSION);
+    future_stream << node::SNAPSHOT_MAGIC_BYTES << uint16_t{3};
+    SnapshotMetadata read_future;
+    BOOST_CHECK_THROW(future_stream >> read_future, std::ios_base::failure);
+}
+
+//! Test that hashing the coins while they are streamed in database order, as
+//! done when loading a snapshot, matches hashing the coins database.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_streamed_snapshot_hash,
+                        TestChain100Setup) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    Chainstate &chainstate = chainman.ActiveChainstate();
+    const CBlockIndex *tip;
+    {
+        LOCK(::cs_main);
+        chainstate.ForceFlushStateToDisk();
+        tip = chainstate.m_chain.Tip();
+    }
+    CCoinsViewDB &coinsdb = WITH_LOCK(::cs_main, return chainstate.CoinsDB());
+
+    std::optional<CCoinsStats> expected = ComputeUTXOStats(
+        CoinStatsHashType::HASH_SERIALIZED, &coinsdb, chainman.m_blockman);
+    BOOST_REQUIRE(expected);
+
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    std::unique_ptr<CCoinsViewCursor> cursor{coinsdb.Cursor()};
+    for (; cursor->Valid(); cursor->Next()) {
+        COutPoint outpoint;
+        Coin coin;
+        BOOST_REQUIRE(cursor->GetKey(outpoint) && cursor->GetValue(coin));
+        coins.emplace_back(outpoint, coin);
+    }
+    BOOST_REQUIRE(coins.size() > 1);
+
+    SerializedCoinsHasher hasher{tip->nHeight, tip->GetBlockHash()};
+    for (const auto &[outpoint, coin] : coins) {
+        BOOST_CHECK(hasher.Add(outpoint, coin));
+    }
+    BOOST_CHECK(hasher.InOrder());
+    const CCoinsStats stats{hasher.Finalize()};
+    BOOST_CHECK_EQUAL(stats.hashSerialized, expected->hashSerialized);
+    BOOST_CHECK_EQUAL(stats.coins_count, expected->coins_count);
+    BOOST_CHECK_EQUAL(stats.nTransactions, expected->nTransactions);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, expected->nTotalAmount);
+
+    // Coins out of database order are detected so the caller can fall back
+    // to hashing the database.
+    SerializedCoinsHasher unordered{tip->nHeight, tip->GetBlockHash()};
+    BOOST_CHECK(unordered.Add(coins[1].first, coins[1].second));
+    BOOST_CHECK(!unordered.Add(coins[0].first, coins[0].second));
+    BOOST_CHECK(!unordered.InOrder());
+
+    // So are duplicated outpoints.
+    SerializedCoinsHasher duplicated{tip->nHeight, tip->GetBlockHash()};
+    BOOST_CHECK(duplicated.Add(coins[0].first, coins[0].second));
+    BOOST_CHECK(!duplicated.Add(coins[0].first, coins[0].second));
+    BOOST_CHECK(!duplicated.InOrder());
+}
+
 //! Test LoadBlockIndex behavior when multiple chainstates are in use.
 //!
 //! - First, verfiy that setBlockIndexCandidates is as expected when using a
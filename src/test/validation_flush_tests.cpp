@@ -56,101 +56,55 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate) {
             "CCoinsViewCache memory usage: " << _view.DynamicMemoryUsage());
     };
 
-    constexpr size_t MAX_COINS_CACHE_BYTES = 1024;
+    // The entries of the coins cache are allocated from chunks of 256 KiB,
+    // which are all accounted for, so its memory usage grows by steps.
+    constexpr size_t MAX_COINS_CACHE_BYTES = 8 << 20;
+    constexpr size_t MAX_MEMPOOL_SIZE_BYTES = 4 << 20;
+    //! The usage above which the cache is LARGE, without mempool headroom.
+    constexpr size_t LARGE_COINS_CACHE_BYTES = (9 * MAX_COINS_CACHE_BYTES) / 10;
 
     // Without any coins in the cache, we shouldn't need to flush.
+    print_view_mem_usage(view);
+    BOOST_CHECK(view.DynamicMemoryUsage() < LARGE_COINS_CACHE_BYTES);
     BOOST_CHECK_EQUAL(chainstate.GetCoinsCacheSizeState(
                           MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
                       CoinsCacheSizeState::OK);
 
-    // If the initial memory allocations of cacheCoins don't match these common
-    // cases, we can't really continue to make assertions about memory usage.
-    // End the test early.
-    if (view.DynamicMemoryUsage() != 32 && view.DynamicMemoryUsage() != 16) {
-        // Add a bunch of coins to see that we at least flip over to CRITICAL.
-
-        for (int i{0}; i < 1000; ++i) {
-            COutPoint res = add_coin(view);
-            BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(),
-                              COIN_SIZE);
-        }
-
-        BOOST_CHECK_EQUAL(
+    // We should be able to add coins until the usage exceeds 90% of the
+    // cache size.
+    int coins_added{0};
+    while (view.DynamicMemoryUsage() <= LARGE_COINS_CACHE_BYTES) {
+        BOOST_REQUIRE_EQUAL(
             chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES,
                                               /*max_mempool_size_bytes*/ 0),
-            CoinsCacheSizeState::CRITICAL);
-
-        BOOST_TEST_MESSAGE(
-            "Exiting cache flush tests early due to unsupported arch");
-        return;
+            CoinsCacheSizeState::OK);
+        COutPoint res = add_coin(view);
+        BOOST_REQUIRE_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(),
+                            COIN_SIZE);
+        ++coins_added;
     }
-
     print_view_mem_usage(view);
-    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), is_64_bit ? 32U : 16U);
-
-    // We should be able to add COINS_UNTIL_CRITICAL coins to the cache before
-    // going CRITICAL. This is contingent not only on the dynamic memory usage
-    // of the Coins that we're adding (COIN_SIZE bytes per), but also on how
-    // much memory the cacheCoins (unordered_map) preallocates.
-    constexpr int COINS_UNTIL_CRITICAL{3};
+    BOOST_TEST_MESSAGE("Coins added before the cache is large: "
+                       << coins_added);
 
-    for (int i{0}; i < COINS_UNTIL_CRITICAL; ++i) {
-        COutPoint res = add_coin(view);
-        print_view_mem_usage(view);
-        BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
-        BOOST_CHECK_EQUAL(
+    // Adding some additional coins will push us over the edge to CRITICAL.
+    while (view.DynamicMemoryUsage() <= MAX_COINS_CACHE_BYTES) {
+        BOOST_REQUIRE_EQUAL(
             chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES,
                                               /*max_mempool_size_bytes*/ 0),
-            CoinsCacheSizeState::OK);
-    }
-
-    // Adding some additional coins will push us over the edge to CRITICAL.
-    for (int i{0}; i < 4; ++i) {
+            CoinsCacheSizeState::LARGE);
         add_coin(view);
-        print_view_mem_usage(view);
-        if (chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES,
-                                              /*max_mempool_size_bytes*/ 0) ==
-            CoinsCacheSizeState::CRITICAL) {
-            break;
-        }
     }
+    print_view_mem_usage(view);
 
     BOOST_CHECK_EQUAL(chainstate.GetCoinsCacheSizeState(
                           MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
                       CoinsCacheSizeState::CRITICAL);
 
     // Passing non-zero max mempool usage should allow us more headroom.
-    BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES,
-                                          /*max_mempool_size_bytes*/ 1 << 10),
-        CoinsCacheSizeState::OK);
-
-    for (int i{0}; i < 3; ++i) {
-        add_coin(view);
-        print_view_mem_usage(view);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(
-                MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 1 << 10),
-            CoinsCacheSizeState::OK);
-    }
-
-    // Adding another coin with the additional mempool room will put us >90%
-    // but not yet critical.
-    add_coin(view);
-    print_view_mem_usage(view);
-
-    // Only perform these checks on 64 bit hosts; I haven't done the math
-    // for 32.
-    if (is_64_bit) {
-        float usage_percentage = (float)view.DynamicMemoryUsage() /
-                                 (MAX_COINS_CACHE_BYTES + (1 << 10));
-        BOOST_TEST_MESSAGE("CoinsTip usage percentage: " << usage_percentage);
-        BOOST_CHECK(usage_percentage >= 0.9);
-        BOOST_CHECK(usage_percentage < 1);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 1 << 10),
-            CoinsCacheSizeState::LARGE);
-    }
+    BOOST_CHECK_EQUAL(chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES,
+                                                        MAX_MEMPOOL_SIZE_BYTES),
+                      CoinsCacheSizeState::OK);
 
     // Using the default max_* values permits way more coins to be added.
     for (int i{0}; i < 1000; ++i) {
@@ -159,20 +113,20 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate) {
                           CoinsCacheSizeState::OK);
     }
 
-    // Flushing the view doesn't take us back to OK because cacheCoins has
-    // preallocated memory that doesn't get reclaimed even after flush.
+    // Flushing the view takes us back to OK, because it releases the memory
+    // of the flushed entries.
 
-    BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
-        CoinsCacheSizeState::CRITICAL);
+    BOOST_CHECK_EQUAL(chainstate.GetCoinsCacheSizeState(
+                          MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
+                      CoinsCacheSizeState::CRITICAL);
 
     view.SetBestBlock(BlockHash(InsecureRand256()));
     BOOST_CHECK(view.Flush());
     print_view_mem_usage(view);
 
-    BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
-        CoinsCacheSizeState::CRITICAL);
+    BOOST_CHECK_EQUAL(chainstate.GetCoinsCacheSizeState(
+                          MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes*/ 0),
+                      CoinsCacheSizeState::OK);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
 #include <net.h>
+#include <node/blockstorage.h>
 #include <primitives/transaction.h>
 #include <streams.h>
 #include <uint256.h>
@@ -135,6 +136,62 @@ BOOST_AUTO_TEST_CASE(validation_load_external_block_file) {
     });
 }
 
+BOOST_FIXTURE_TEST_CASE(validation_read_block_file, TestChain100Setup) {
+    const Config &config = GetConfig();
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+
+    std::vector<ExternalBlock> blocks =
+        ReadBlockFile(config, node::OpenBlockFile(FlatFilePos(0, 0), true), 0);
+
+    // The genesis block and the 100 blocks of the chain, in file order, which
+    // passed the context-free checks.
+    LOCK(cs_main);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 101U);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const auto &[pblock, pos] = blocks[i];
+        const CBlockIndex *pindex = chainstate.m_chain[i];
+        BOOST_CHECK(pblock->GetHash() == pindex->GetBlockHash());
+        BOOST_CHECK(pos == pindex->GetBlockPos());
+        BOOST_CHECK(pblock->fChecked);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(validation_verifydb_threads, TestChain100Setup) {
+    const Config &config = GetConfig();
+    Chainstate &chainstate = m_node.chainman->ActiveChainstate();
+
+    LOCK(cs_main);
+    for (int threads_num : {0, 1, 4, 200}) {
+        BOOST_CHECK(CVerifyDB().VerifyDB(chainstate, config,
+                                         chainstate.CoinsTip(), 4, 0,
+                                         threads_num) ==
+                    VerifyDBResult::SUCCESS);
+    }
+
+    // Corrupt the transactions of a block in the middle of the chain.
+    FlatFilePos pos = chainstate.m_chain[50]->GetBlockPos();
+    pos.nPos += 100;
+    FILE *file = node::OpenBlockFile(pos);
+    BOOST_REQUIRE(file);
+    const std::vector<uint8_t> garbage(16, 0xff);
+    BOOST_REQUIRE_EQUAL(fwrite(garbage.data(), 1, garbage.size(), file),
+                        garbage.size());
+    fclose(file);
+
+    for (int threads_num : {0, 1, 4, 200}) {
+        // The corrupted block is checked...
+        BOOST_CHECK(CVerifyDB().VerifyDB(chainstate, config,
+                                         chainstate.CoinsTip(), 4, 60,
+                                         threads_num) ==
+                    VerifyDBResult::CORRUPTED_BLOCK_DB);
+        // ... or not.
+        BOOST_CHECK(CVerifyDB().VerifyDB(chainstate, config,
+                                         chainstate.CoinsTip(), 4, 40,
+                                         threads_num) ==
+                    VerifyDBResult::SUCCESS);
+    }
+}
+
 //! Test retrieval of valid assumeutxo values.
 BOOST_AUTO_TEST_CASE(test_assumeutxo) {
     const auto params = CreateChainParams(CBaseChainParams::REGTEST);
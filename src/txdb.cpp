@@ -11,11 +11,13 @@
 #include <random.h>
 #include <shutdown.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <util/translation.h>
 #include <util/vector.h>
 #include <version.h>
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 static const char DB_COIN = 'C';
@@ -80,7 +82,12 @@ CCoinsViewDB::CCoinsViewDB(fs::path ldb_path, size_t nCacheSize, bool fMemory,
                                         true)),
       m_ldb_path(ldb_path), m_is_memory(fMemory) {}
 
+CCoinsViewDB::~CCoinsViewDB() {
+    WaitForFlush();
+}
+
 void CCoinsViewDB::ResizeCache(size_t new_cache_size) {
+    WaitForFlush();
     // We can't do this operation with an in-memory DB since we'll lose all the
     // coins upon reset.
     if (!m_is_memory) {
@@ -93,15 +100,61 @@ void CCoinsViewDB::ResizeCache(size_t new_cache_size) {
     }
 }
 
+/**
+ * Once a background flush failed, the database may be half-written and reading
+ * from it could return wrong coins. Treat it like a database read error.
+ */
+static void ThrowIfFlushFailed(bool flush_failed) {
+    if (flush_failed) {
+        throw dbwrapper_error("Background flush of the coin database failed");
+    }
+}
+
 bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    {
+        LOCK(m_flush_mutex);
+        ThrowIfFlushFailed(m_flush_failed);
+        if (m_flushing) {
+            auto it = m_flushing->coins.find(outpoint);
+            if (it != m_flushing->coins.end()) {
+                if (it->second.coin.IsSpent()) {
+                    return false;
+                }
+                coin = it->second.coin;
+                return true;
+            }
+        }
+    }
+    // The entries that are not being flushed are not modified by the flush.
     return m_db->Read(CoinEntry(&outpoint), coin);
 }
 
 bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
+    {
+        LOCK(m_flush_mutex);
+        ThrowIfFlushFailed(m_flush_failed);
+        if (m_flushing) {
+            auto it = m_flushing->coins.find(outpoint);
+            if (it != m_flushing->coins.end()) {
+                return !it->second.coin.IsSpent();
+            }
+        }
+    }
     return m_db->Exists(CoinEntry(&outpoint));
 }
 
 BlockHash CCoinsViewDB::GetBestBlock() const {
+    {
+        LOCK(m_flush_mutex);
+        ThrowIfFlushFailed(m_flush_failed);
+        if (m_flushing) {
+            return m_flushing->hashBlock;
+        }
+    }
+    return ReadBestBlock();
+}
+
+BlockHash CCoinsViewDB::ReadBestBlock() const {
     BlockHash hashBestChain;
     if (!m_db->Read(DB_BEST_BLOCK, hashBestChain)) {
         return BlockHash();
@@ -117,7 +170,92 @@ std::vector<BlockHash> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                              bool erase) {
+    if (!WaitForFlush()) {
+        return false;
+    }
+    return WriteCoins(mapCoins, hashBlock, erase);
+}
+
+bool CCoinsViewDB::BatchWriteInBackground(CCoinsMapContent &&content) {
+    if (!WaitForFlush()) {
+        return false;
+    }
+    CCoinsMapContent *flushing;
+    {
+        LOCK(m_flush_mutex);
+        m_flushing = std::make_unique<CCoinsMapContent>(std::move(content));
+        flushing = m_flushing.get();
+    }
+    m_flush_thread = std::thread([this, flushing]() {
+        util::ThreadRename("coinsflush");
+        bool ok;
+        try {
+            // The entries are not erased, so they can be read concurrently.
+            ok = WriteCoins(flushing->coins, flushing->hashBlock,
+                            /*erase=*/false);
+        } catch (const std::exception &e) {
+            LogPrintf("Error writing coins in the background: %s\n",
+                      e.what());
+            ok = false;
+        }
+        // Destroy the written coins outside of the lock.
+        std::unique_ptr<CCoinsMapContent> written;
+        {
+            LOCK(m_flush_mutex);
+            if (ok) {
+                written = std::move(m_flushing);
+            } else {
+                // Keep serving the coins from memory rather than from the
+                // half-written database.
+                m_flush_failed = true;
+            }
+        }
+        m_flush_cv.notify_all();
+    });
+    return true;
+}
+
+bool CCoinsViewDB::WaitForFlush() {
+    if (m_flush_thread.joinable()) {
+        m_flush_thread.join();
+    }
+    return !FlushFailed();
+}
+
+bool CCoinsViewDB::FlushFailed() const {
+    return WITH_LOCK(m_flush_mutex, return m_flush_failed);
+}
+
+bool CCoinsViewDB::IsFlushing() const {
+    return WITH_LOCK(m_flush_mutex, return m_flushing != nullptr);
+}
+
+void CCoinsViewDB::WaitForFlushWritten(UniqueLock<Mutex> &lock) const {
+    m_flush_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_flush_mutex) {
+        return !m_flushing || m_flush_failed;
+    });
+    ThrowIfFlushFailed(m_flush_failed);
+}
+
+/**
+ * Read the best block from the database snapshot of the iterator, so that it
+ * matches the coins it iterates over.
+ */
+static BlockHash ReadIteratorBestBlock(CDBIterator &it) {
+    it.Seek(DB_BEST_BLOCK);
+    char key;
+    BlockHash hash;
+    if (!it.Valid() || !it.GetKey(key) || key != DB_BEST_BLOCK ||
+        !it.GetValue(hash)) {
+        return BlockHash();
+    }
+    return hash;
+}
+
+bool CCoinsViewDB::WriteCoins(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                              bool erase) {
     CDBBatch batch(*m_db);
     size_t count = 0;
     size_t changed = 0;
@@ -126,7 +264,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
     int crash_simulate = gArgs.GetIntArg("-dbcrashratio", 0);
     assert(!hashBlock.IsNull());
 
-    BlockHash old_tip = GetBestBlock();
+    BlockHash old_tip = ReadBestBlock();
     if (old_tip.IsNull()) {
         // We may be in the middle of replaying.
         std::vector<BlockHash> old_heads = GetHeadBlocks();
@@ -155,7 +293,9 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
         }
         count++;
         CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
+        if (erase) {
+            mapCoins.erase(itOld);
+        }
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n",
                      batch.SizeEstimate() * (1.0 / 1048576.0));
@@ -171,6 +311,10 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
         }
     }
 
+    if (m_simulate_write_failure.exchange(false)) {
+        throw dbwrapper_error("Simulated write failure");
+    }
+
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
@@ -213,27 +357,87 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
     return Read(DB_LAST_BLOCK, nFile);
 }
 
+bool CBlockTreeDB::WriteBlockIndexSnapshotHash(const uint256 &hash) {
+    // The readers of the last block file number ignore the trailing hash.
+    int last_file;
+    if (!ReadLastBlockFile(last_file)) {
+        return false;
+    }
+    return Write(DB_LAST_BLOCK, std::make_pair(last_file, hash),
+                 /*fSync=*/true);
+}
+
+bool CBlockTreeDB::ReadBlockIndexSnapshotHash(uint256 &hash) {
+    std::pair<int, uint256> last_block;
+    if (!Read(DB_LAST_BLOCK, last_block)) {
+        return false;
+    }
+    hash = last_block.second;
+    return true;
+}
+
+bool CBlockTreeDB::EraseBlockIndexSnapshotHash() {
+    int last_file;
+    if (!ReadLastBlockFile(last_file)) {
+        return false;
+    }
+    return Write(DB_LAST_BLOCK, last_file, /*fSync=*/true);
+}
+
 CCoinsViewCursor *CCoinsViewDB::Cursor() const {
-    CCoinsViewDBCursor *i = new CCoinsViewDBCursor(
-        const_cast<CDBWrapper &>(*m_db).NewIterator(), GetBestBlock());
+    WAIT_LOCK(m_flush_mutex, lock);
+    WaitForFlushWritten(lock);
     /**
      * It seems that there are no "const iterators" for LevelDB. Since we only
      * need read operations on it, use a const-cast to get around that
      * restriction.
      */
+    std::unique_ptr<CDBIterator> it{
+        const_cast<CDBWrapper &>(*m_db).NewIterator()};
+    const BlockHash best_block = ReadIteratorBestBlock(*it);
+    CCoinsViewDBCursor *i = new CCoinsViewDBCursor(it.release(), best_block);
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
-    } else {
-        // Make sure Valid() and GetKey() return false
-        i->keyTmp.first = 0;
-    }
+    i->ReadKey();
     return i;
 }
 
+/** The first txid of the given range, when splitting them in `count`. */
+static TxId GetTxIdRangeStart(size_t range, size_t count) {
+    const uint32_t prefix = range * 0x10000 / count;
+    uint256 txid;
+    *txid.begin() = prefix >> 8;
+    *(txid.begin() + 1) = prefix & 0xff;
+    return TxId{txid};
+}
+
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsViewDB::RangeCursors(size_t count) const {
+    assert(count > 0);
+    WAIT_LOCK(m_flush_mutex, lock);
+    WaitForFlushWritten(lock);
+    std::vector<std::unique_ptr<CDBIterator>> iterators =
+        const_cast<CDBWrapper &>(*m_db).NewIterators(count);
+    // The iterators share the same database snapshot.
+    const BlockHash best_block = ReadIteratorBestBlock(*iterators[0]);
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.reserve(count);
+    for (size_t range = 0; range < count; ++range) {
+        std::optional<TxId> end;
+        if (range + 1 < count) {
+            end = GetTxIdRangeStart(range + 1, count);
+        }
+        std::unique_ptr<CCoinsViewDBCursor> cursor{new CCoinsViewDBCursor(
+            iterators[range].release(), best_block, end)};
+        cursor->pcursor->Seek(
+            std::make_pair(DB_COIN, GetTxIdRangeStart(range, count)));
+        cursor->ReadKey();
+        cursors.push_back(std::move(cursor));
+    }
+    return cursors;
+}
+
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const {
     // Return cached key
     if (keyTmp.first == DB_COIN) {
@@ -257,8 +461,17 @@ bool CCoinsViewDBCursor::Valid() const {
 
 void CCoinsViewDBCursor::Next() {
     pcursor->Next();
+    ReadKey();
+}
+
+void CCoinsViewDBCursor::ReadKey() {
     CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
+    // The range end is compared in database key order, which is bytewise and
+    // differs from the numeric order of uint256::operator<.
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) ||
+        (m_end && entry.key == DB_COIN &&
+         std::memcmp(keyTmp.second.GetTxId().data(), m_end->data(),
+                     m_end->size()) >= 0)) {
         // Invalidate cached key after last record so that Valid() and GetKey()
         // return false
         keyTmp.first = 0;
@@ -11,14 +11,19 @@
 #include <dbwrapper.h>
 #include <flatfile.h>
 #include <fs.h>
+#include <sync.h>
+#include <threadsafety.h>
 #include <util/result.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -62,6 +67,31 @@ protected:
     fs::path m_ldb_path;
     bool m_is_memory;
 
+    mutable Mutex m_flush_mutex;
+    //! The coins being written by the background flush thread. They are more
+    //! recent than the content of the database, and are kept if the flush
+    //! fails.
+    std::unique_ptr<CCoinsMapContent> m_flushing GUARDED_BY(m_flush_mutex);
+    //! Whether a background flush failed. The database is then left in the
+    //! middle of a transition and must not be read from or written to anymore.
+    bool m_flush_failed GUARDED_BY(m_flush_mutex){false};
+    //! Notified when the background flush completes.
+    mutable std::condition_variable m_flush_cv;
+    std::thread m_flush_thread;
+    //! Make the next write fail before its last batch, for testing.
+    std::atomic<bool> m_simulate_write_failure{false};
+
+    BlockHash ReadBestBlock() const;
+    //! Wait for the background flush in progress, if any, to be written, so
+    //! that the database can be iterated over. Unlike WaitForFlush(), this
+    //! keeps the lock so that no other flush starts in the meantime.
+    void WaitForFlushWritten(UniqueLock<Mutex> &lock) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_flush_mutex);
+    //! Write the dirty entries of mapCoins, erasing the entries from the map
+    //! as they are written if erase is true.
+    bool WriteCoins(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase);
+
 public:
     /**
      * @param[in] ldb_path    Location in the filesystem where leveldb data will
@@ -69,13 +99,56 @@ public:
      */
     explicit CCoinsViewDB(fs::path ldb_path, size_t nCacheSize, bool fMemory,
                           bool fWipe);
+    ~CCoinsViewDB();
 
     bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
     BlockHash GetBestBlock() const override;
     std::vector<BlockHash> GetHeadBlocks() const override;
-    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
-    CCoinsViewCursor *Cursor() const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase = true) override;
+    //! Wait for the background flush in progress, if any, to be written, so
+    //! that the cursor sees the coins and the best block it reports.
+    CCoinsViewCursor *Cursor() const override
+        EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+    //! Split the txids in `count` ranges of the same size, on their first two
+    //! bytes. All the cursors see the same state of the database. Like
+    //! Cursor(), this waits for the background flush in progress.
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    RangeCursors(size_t count) const override
+        EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+
+    /**
+     * Write the coins taken out of the cache on a background thread, after
+     * waiting for the previous background flush to complete. Until they are
+     * written, the coins are served from memory as if they were in the
+     * database. The database keeps marking the transition between the old and
+     * the new best block in the meantime, so an interrupted flush is replayed
+     * on the next start like a synchronous one.
+     *
+     * @returns false if the previous background flush failed, in which case
+     * the coins are not written.
+     */
+    bool BatchWriteInBackground(CCoinsMapContent &&content)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+
+    /**
+     * Wait for the background flush in progress, if any, to complete.
+     * @returns false if a background flush failed.
+     */
+    bool WaitForFlush() EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+
+    //! Whether a background flush failed, without waiting for the one in
+    //! progress.
+    bool FlushFailed() const EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+
+    //! Whether the coins of a background flush are not written yet, because
+    //! it is in progress or failed.
+    bool IsFlushing() const EXCLUSIVE_LOCKS_REQUIRED(!m_flush_mutex);
+
+    //! Make the next write to the database fail after its partial batches
+    //! are written.
+    void TestOnlySimulateWriteFailure() { m_simulate_write_failure = true; }
 
     //! Attempt to update from an older database format.
     //! Returns whether an error occurred.
@@ -103,10 +176,16 @@ public:
     void Next() override;
 
 private:
-    CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn)
-        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn,
+                       std::optional<TxId> end = std::nullopt)
+        : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn), m_end(end) {}
+    //! Cache the key of the current record, if it is a coin in range.
+    void ReadKey();
+
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! The txid at which the iteration stops, if any.
+    std::optional<TxId> m_end;
 
     friend class CCoinsViewDB;
 };
@@ -122,6 +201,17 @@ public:
         int nLastFile, const std::vector<const CBlockIndex *> &blockinfo);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &info);
     bool ReadLastBlockFile(int &nFile);
+    /**
+     * The hash of the block index snapshot that matches the content of the
+     * database. It is stored after the last block file number, in the record
+     * that WriteBatchSync() rewrites on every write of the block index, in
+     * this version as in the older ones. So the hash is dropped as soon as
+     * the block index is modified, even by a version that doesn't know about
+     * the snapshot. It is also erased when the snapshot is loaded.
+     */
+    bool WriteBlockIndexSnapshotHash(const uint256 &hash);
+    bool ReadBlockIndexSnapshotHash(uint256 &hash);
+    bool EraseBlockIndexSnapshotHash();
     bool WriteReindexing(bool fReindexing);
     bool IsReindexing() const;
     bool WriteFlag(const std::string &name, bool fValue);
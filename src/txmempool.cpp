@@ -54,10 +54,35 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTransactionRef &_tx, const Amount fee,
                                  bool spends_coinbase, int64_t _sigChecks,
                                  LockPoints lp)
     : tx{_tx}, nFee{fee},
-      nTxSize(tx->GetTotalSize()), nUsageSize{RecursiveDynamicUsage(tx)},
+      nTxSize(tx->GetTotalSize()), nUsageSize(RecursiveDynamicUsage(tx)),
       nTime(time), entryHeight{entry_height}, spendsCoinbase(spends_coinbase),
       sigChecks(_sigChecks), lockPoints(lp) {}
 
+bool CTxMemPoolEntryLinks::CompareById(const CTxMemPoolEntryLink &a,
+                                       const CTxMemPoolEntryLink &b) {
+    return a.get()->GetTx().GetId() < b.get()->GetTx().GetId();
+}
+
+std::pair<CTxMemPoolEntryLinks::const_iterator, bool>
+CTxMemPoolEntryLinks::insert(const CTxMemPoolEntryLink &link) {
+    auto it = std::lower_bound(links.begin(), links.end(), link, CompareById);
+    if (it != links.end() && !CompareById(link, *it)) {
+        return {it, false};
+    }
+
+    return {links.insert(it, link), true};
+}
+
+size_t CTxMemPoolEntryLinks::erase(const CTxMemPoolEntryLink &link) {
+    auto it = std::lower_bound(links.begin(), links.end(), link, CompareById);
+    if (it == links.end() || CompareById(link, *it)) {
+        return 0;
+    }
+
+    links.erase(it);
+    return 1;
+}
+
 size_t CTxMemPoolEntry::GetTxVirtualSize() const {
     return GetVirtualTransactionSize(nTxSize, sigChecks);
 }
@@ -74,12 +99,13 @@ bool CTxMemPool::CalculateAncestors(
     setEntries &setAncestors,
     CTxMemPoolEntry::Parents &staged_ancestors) const {
     while (!staged_ancestors.empty()) {
-        const auto stage = staged_ancestors.begin()->get();
+        // Pop from the back, which doesn't move the other staged ancestors.
+        const auto stage = staged_ancestors.back().get();
 
         txiter stageit = mapTx.find(stage->GetTx().GetId());
         assert(stageit != mapTx.end());
         setAncestors.insert(stageit);
-        staged_ancestors.erase(staged_ancestors.begin());
+        staged_ancestors.pop_back();
 
         const CTxMemPoolEntry::Parents &parents =
             (*stageit)->GetMemPoolParentsConst();
@@ -165,7 +191,66 @@ CTxMemPool::CTxMemPool(const Options &opts)
     _clear();
 }
 
-CTxMemPool::~CTxMemPool() {}
+CTxMemPool::~CTxMemPool() {
+    const CTxMemPoolSnapshot *snapshot = m_snapshot.exchange(nullptr);
+    RCUPtr<const CTxMemPoolSnapshot>::acquire(snapshot);
+}
+
+CTxMemPoolSnapshotEntry::CTxMemPoolSnapshotEntry(const CTxMemPoolEntry &entry,
+                                                 bool unbroadcastIn)
+    : tx(entry.GetSharedTx()), entryId(entry.GetEntryId()),
+      fee(entry.GetFee()), modifiedFee(entry.GetModifiedFee()),
+      txSize(entry.GetTxSize()), time(entry.GetTime()),
+      height(entry.GetHeight()), unbroadcast(unbroadcastIn),
+      children([&entry] {
+          // The children are already ordered by txid.
+          std::vector<TxId> txids;
+          txids.reserve(entry.GetMemPoolChildrenConst().size());
+          for (const auto &child : entry.GetMemPoolChildrenConst()) {
+              txids.push_back(child.get()->GetTx().GetId());
+          }
+          return txids;
+      }()) {}
+
+std::vector<CTxMemPoolSnapshot::EntryRef>
+CTxMemPoolSnapshot::GetEntries() const {
+    std::vector<EntryRef> ret;
+    ret.reserve(nEntries);
+    entries.forEachLeaf([&](const EntryRef &entry) {
+        ret.push_back(entry);
+        return true;
+    });
+
+    std::sort(ret.begin(), ret.end(),
+              [](const EntryRef &a, const EntryRef &b) {
+                  return a->entryId < b->entryId;
+              });
+    return ret;
+}
+
+RCUPtr<const CTxMemPoolSnapshot> CTxMemPool::GetSnapshot() const {
+    RCULock lock;
+    return RCUPtr<const CTxMemPoolSnapshot>::copy(m_snapshot.load());
+}
+
+void CTxMemPool::UpdateSnapshotEntry(const CTxMemPoolEntry &entry) {
+    const TxId &txid = entry.GetTx().GetId();
+    m_snapshot_entries.remove(txid);
+    m_snapshot_entries.insert(RCUPtr<const CTxMemPoolSnapshotEntry>::make(
+        entry, m_unbroadcast_txids.count(txid) != 0));
+}
+
+void CTxMemPool::PublishSnapshot() {
+    // The snapshot shares the tree nodes with m_snapshot_entries until they
+    // are modified, so this doesn't copy the entries. The previous snapshot
+    // is only freed once the readers that copied it are done with it.
+    const CTxMemPoolSnapshot *snapshot =
+        RCUPtr<const CTxMemPoolSnapshot>::make(
+            m_snapshot_entries.copyFromWriter(), mapTx.size())
+            .release();
+    snapshot = m_snapshot.exchange(snapshot);
+    RCUPtr<const CTxMemPoolSnapshot>::acquire(snapshot);
+}
 
 bool CTxMemPool::isSpent(const COutPoint &outpoint) const {
     LOCK(cs);
@@ -223,6 +308,12 @@ void CTxMemPool::addUnchecked(CTxMemPoolEntryRef entry) {
 
     UpdateParentsOf(true, newit);
 
+    // The parents have a new child.
+    UpdateSnapshotEntry(**newit);
+    for (const auto &parent : (*newit)->GetMemPoolParentsConst()) {
+        UpdateSnapshotEntry(*parent.get());
+    }
+
     nTransactionsUpdated++;
     totalTxSize += entry->GetTxSize();
     m_total_fee += entry->GetFee();
@@ -246,20 +337,21 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
         mapNextTx.erase(txin.prevout);
     }
 
-    /* add logging because unchecked */
-    const TxId &txid = (*it)->GetTx().GetId();
-    RemoveUnbroadcastTx(txid, true);
-
+    const TxId txid = (*it)->GetTx().GetId();
     finalizedTxs.remove(txid);
+    m_snapshot_entries.remove(txid);
 
     totalTxSize -= (*it)->GetTxSize();
     m_total_fee -= (*it)->GetFee();
     cachedInnerUsage -= (*it)->DynamicMemoryUsage();
     cachedInnerUsage -=
-        memusage::DynamicUsage((*it)->GetMemPoolParentsConst()) +
-        memusage::DynamicUsage((*it)->GetMemPoolChildrenConst());
+        (*it)->GetMemPoolParentsConst().DynamicMemoryUsage() +
+        (*it)->GetMemPoolChildrenConst().DynamicMemoryUsage();
     mapTx.erase(it);
     nTransactionsUpdated++;
+
+    /* add logging because unchecked */
+    RemoveUnbroadcastTx(txid, true);
 }
 
 // Calculates descendants of entry that are not already in setDescendants, and
@@ -378,6 +470,9 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef> &vtx) {
 
     lastRollingFeeUpdate = GetTime();
     blockSinceLastRollingFeeBump = true;
+
+    // The readers see the block removed at once.
+    PublishSnapshot();
 }
 
 void CTxMemPool::_clear() {
@@ -390,6 +485,8 @@ void CTxMemPool::_clear() {
     blockSinceLastRollingFeeBump = false;
     rollingMinimumFeeRate = 0;
     ++nTransactionsUpdated;
+    m_snapshot_entries = CTxMemPoolSnapshot::Entries();
+    PublishSnapshot();
 }
 
 void CTxMemPool::clear() {
@@ -425,8 +522,8 @@ void CTxMemPool::check(const CCoinsViewCache &active_coins_tip,
         check_total_fee += entry->GetFee();
         innerUsage += entry->DynamicMemoryUsage();
         const CTransaction &tx = entry->GetTx();
-        innerUsage += memusage::DynamicUsage(entry->GetMemPoolParentsConst()) +
-                      memusage::DynamicUsage(entry->GetMemPoolChildrenConst());
+        innerUsage += entry->GetMemPoolParentsConst().DynamicMemoryUsage() +
+                      entry->GetMemPoolChildrenConst().DynamicMemoryUsage();
 
         CTxMemPoolEntry::Parents setParentCheck;
         for (const CTxIn &txin : tx.vin) {
@@ -544,14 +641,14 @@ GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
 }
 
 std::vector<TxMempoolInfo> CTxMemPool::infoAll() const {
-    LOCK(cs);
+    const auto snapshot = GetSnapshot();
 
     std::vector<TxMempoolInfo> ret;
-    ret.reserve(mapTx.size());
-
-    const auto &index = mapTx.get<entry_id>();
-    for (auto it = index.begin(); it != index.end(); ++it) {
-        ret.push_back(GetInfo(mapTx.project<0>(it)));
+    ret.reserve(snapshot->size());
+    for (const auto &entry : snapshot->GetEntries()) {
+        ret.push_back(TxMempoolInfo{entry->tx, entry->time, entry->fee,
+                                    entry->txSize,
+                                    entry->modifiedFee - entry->fee});
     }
 
     return ret;
@@ -599,6 +696,9 @@ void CTxMemPool::PrioritiseTransaction(const TxId &txid,
                 e->UpdateFeeDelta(delta);
             });
             ++nTransactionsUpdated;
+            ++m_fee_deltas_updated;
+            UpdateSnapshotEntry(**it);
+            PublishSnapshot();
         }
     }
     LogPrintf("PrioritiseTransaction: %s fee += %s\n", txid.ToString(),
@@ -691,11 +791,22 @@ void CCoinsViewMemPool::PackageAddTransaction(const CTransactionRef &tx) {
 
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no
-    // exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) +
-                                 12 * sizeof(void *)) *
-               mapTx.size() +
+    // Estimate the overhead of mapTx to be 12 pointers per node, as no exact
+    // formula for boost::multi_index_contained is implemented. The nodes are
+    // allocated from the chunks of a pool, which keeps the nodes of the
+    // removed transactions for the next ones rather than freeing them. Count
+    // the chunks that are filled instead when they use more memory, so the
+    // pool memory left after evictions is not ignored. The chunk being filled
+    // is not counted, so a small mempool is not charged a whole chunk.
+    const size_t num_chunks = m_map_tx_resource.NumAllocatedChunks();
+    const size_t filled_chunks_usage =
+        num_chunks > 1
+            ? (num_chunks - 1) *
+                  (memusage::MallocUsage(m_map_tx_resource.ChunkSizeBytes()) +
+                   memusage::MallocUsage(3 * sizeof(void *)))
+            : 0;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry)) * mapTx.size() +
+           std::max(12 * sizeof(void *) * mapTx.size(), filled_chunks_usage) +
            memusage::DynamicUsage(mapNextTx) +
            memusage::DynamicUsage(mapDeltas) + cachedInnerUsage;
 }
@@ -708,12 +819,27 @@ void CTxMemPool::RemoveUnbroadcastTx(const TxId &txid, const bool unchecked) {
             BCLog::MEMPOOL, "Removed %i from set of unbroadcast txns%s\n",
             txid.GetHex(),
             (unchecked ? " before confirmation that txn was sent out" : ""));
+
+        auto it = mapTx.find(txid);
+        if (it != mapTx.end()) {
+            UpdateSnapshotEntry(**it);
+            PublishSnapshot();
+        }
     }
 }
 
 void CTxMemPool::RemoveStaged(const setEntries &stage,
                               MemPoolRemovalReason reason) {
     AssertLockHeld(cs);
+
+    // The parents staying in the mempool lose some children.
+    std::set<TxId> remainingParents;
+    for (txiter it : stage) {
+        for (const auto &parent : (*it)->GetMemPoolParentsConst()) {
+            remainingParents.insert(parent.get()->GetTx().GetId());
+        }
+    }
+
     UpdateForRemoveFromMempool(stage);
 
     // Remove txs in reverse-topological order
@@ -721,6 +847,13 @@ void CTxMemPool::RemoveStaged(const setEntries &stage,
     for (txiter it : stageRevTopo) {
         removeUnchecked(it, reason);
     }
+
+    for (const TxId &txid : remainingParents) {
+        auto it = mapTx.find(txid);
+        if (it != mapTx.end()) {
+            UpdateSnapshotEntry(**it);
+        }
+    }
 }
 
 int CTxMemPool::Expire(std::chrono::seconds time) {
@@ -756,26 +889,33 @@ void CTxMemPool::LimitSize(CCoinsViewCache &coins_cache) {
     for (const COutPoint &removed : vNoSpendsRemaining) {
         coins_cache.Uncache(removed);
     }
+
+    // This ends the transaction submissions and the reorgs.
+    PublishSnapshot();
 }
 
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add) {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Children s;
-    if (add && (*entry)->GetMemPoolChildren().insert(*child).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && (*entry)->GetMemPoolChildren().erase(*child)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Children &children = (*entry)->GetMemPoolChildren();
+    cachedInnerUsage -= children.DynamicMemoryUsage();
+    if (add) {
+        children.insert(*child);
+    } else {
+        children.erase(*child);
     }
+    cachedInnerUsage += children.DynamicMemoryUsage();
 }
 
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add) {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Parents s;
-    if (add && (*entry)->GetMemPoolParents().insert(*parent).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && (*entry)->GetMemPoolParents().erase(*parent)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Parents &parents = (*entry)->GetMemPoolParents();
+    cachedInnerUsage -= parents.DynamicMemoryUsage();
+    if (add) {
+        parents.insert(*parent);
+    } else {
+        parents.erase(*parent);
     }
+    cachedInnerUsage += parents.DynamicMemoryUsage();
 }
 
 CFeeRate CTxMemPool::GetMinFee(size_t sizelimit) const {
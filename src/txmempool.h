@@ -12,9 +12,11 @@
 #include <indirectmap.h>
 #include <kernel/mempool_options.h>
 #include <policy/packages.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <radix.h>
 #include <rcu.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <uint256radixkey.h>
 #include <util/hasher.h>
@@ -29,6 +31,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -93,6 +96,64 @@ struct CompareIteratorByRevEntryId {
 class CTxMemPoolEntry;
 using CTxMemPoolEntryRef = RCUPtr<CTxMemPoolEntry>;
 
+/**
+ * Reference to a mempool entry, as stored in the parents and children of
+ * another entry. It points to the CTxMemPoolEntryRef held by mapTx, like a
+ * std::reference_wrapper would, but is default constructible and trivially
+ * copyable so it can be stored in a prevector.
+ */
+class CTxMemPoolEntryLink {
+    const CTxMemPoolEntryRef *ref = nullptr;
+
+public:
+    CTxMemPoolEntryLink() = default;
+    CTxMemPoolEntryLink(const CTxMemPoolEntryRef &refIn) : ref(&refIn) {}
+
+    const CTxMemPoolEntryRef &get() const { return *ref; }
+    operator const CTxMemPoolEntryRef &() const { return *ref; }
+};
+static_assert(std::is_trivially_copyable_v<CTxMemPoolEntryLink>,
+              "prevector moves its elements with memmove");
+
+/**
+ * Set of links to other mempool entries, sorted by txid.
+ *
+ * Most transactions only have one or two in-mempool parents or children, which
+ * are stored inline. This avoids the allocation of a tree node per link, which
+ * a std::set would need.
+ */
+class CTxMemPoolEntryLinks {
+    using Links = prevector<2, CTxMemPoolEntryLink>;
+    Links links;
+
+    static bool CompareById(const CTxMemPoolEntryLink &a,
+                            const CTxMemPoolEntryLink &b);
+
+public:
+    using value_type = CTxMemPoolEntryLink;
+    using const_iterator = Links::const_iterator;
+
+    const_iterator begin() const { return links.begin(); }
+    const_iterator end() const { return links.end(); }
+    size_t size() const { return links.size(); }
+    bool empty() const { return links.empty(); }
+
+    const CTxMemPoolEntryLink &back() const { return links.back(); }
+    void pop_back() { links.pop_back(); }
+
+    /**
+     * Insert a link. Returns an iterator to the link and whether it was
+     * inserted, like std::set::insert.
+     */
+    std::pair<const_iterator, bool> insert(const CTxMemPoolEntryLink &link);
+    /** Remove a link. Returns the number of removed links. */
+    size_t erase(const CTxMemPoolEntryLink &link);
+
+    size_t DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(links);
+    }
+};
+
 /** \class CTxMemPoolEntry
  *
  * CTxMemPoolEntry stores data about the corresponding transaction, as well as
@@ -103,12 +164,8 @@ using CTxMemPoolEntryRef = RCUPtr<CTxMemPoolEntry>;
 class CTxMemPoolEntry {
 public:
     // two aliases, should the types ever diverge
-    typedef std::set<std::reference_wrapper<const CTxMemPoolEntryRef>,
-                     CompareIteratorById>
-        Parents;
-    typedef std::set<std::reference_wrapper<const CTxMemPoolEntryRef>,
-                     CompareIteratorById>
-        Children;
+    typedef CTxMemPoolEntryLinks Parents;
+    typedef CTxMemPoolEntryLinks Children;
 
 private:
     //! Unique identifier -- used for topological sorting
@@ -120,9 +177,9 @@ private:
     //! Cached to avoid expensive parent-transaction lookups
     const Amount nFee;
     //! ... and avoid recomputing tx size
-    const size_t nTxSize;
+    const uint32_t nTxSize;
     //! ... and total memory usage
-    const size_t nUsageSize;
+    const uint32_t nUsageSize;
     //! Local time when entering the mempool
     const int64_t nTime;
     //! Chain height when entering the mempool
@@ -286,6 +343,67 @@ struct TxMempoolInfo {
     Amount nFeeDelta;
 };
 
+/**
+ * Immutable copy of the data of a mempool entry, as exposed by
+ * CTxMemPoolSnapshot.
+ */
+class CTxMemPoolSnapshotEntry {
+public:
+    CTxMemPoolSnapshotEntry(const CTxMemPoolEntry &entry, bool unbroadcastIn);
+
+    const CTransactionRef tx;
+    const uint64_t entryId;
+    const Amount fee;
+    const Amount modifiedFee;
+    const size_t txSize;
+    const std::chrono::seconds time;
+    const unsigned int height;
+    const bool unbroadcast;
+    //! In-mempool children, sorted by txid
+    const std::vector<TxId> children;
+
+    IMPLEMENT_RCU_REFCOUNT(uint64_t);
+};
+
+struct MemPoolSnapshotEntryRadixTreeAdapter {
+    Uint256RadixKey getId(const CTxMemPoolSnapshotEntry &entry) const {
+        return entry.tx->GetId();
+    }
+};
+
+/**
+ * Read-only view of the mempool at some point in time.
+ *
+ * The mempool publishes a new snapshot after each batch of changes, and the
+ * snapshots can be read without locking mempool.cs. This lets the RPC and REST
+ * queries that only read the mempool content run without contending with the
+ * transaction acceptance and block connection.
+ */
+class CTxMemPoolSnapshot {
+public:
+    using EntryRef = RCUPtr<const CTxMemPoolSnapshotEntry>;
+    using Entries = RadixTree<const CTxMemPoolSnapshotEntry,
+                              MemPoolSnapshotEntryRadixTreeAdapter>;
+
+    CTxMemPoolSnapshot(Entries entriesIn, size_t sizeIn)
+        : entries(std::move(entriesIn)), nEntries(sizeIn) {}
+
+    size_t size() const { return nEntries; }
+
+    /** Returns the entry for the given txid, or nullptr if there is none. */
+    EntryRef get(const TxId &txid) const { return entries.get(txid); }
+    bool exists(const TxId &txid) const { return get(txid) != nullptr; }
+
+    /** Returns all the entries, in topological order. */
+    std::vector<EntryRef> GetEntries() const;
+
+private:
+    const Entries entries;
+    const size_t nEntries;
+
+    IMPLEMENT_RCU_REFCOUNT(uint64_t);
+};
+
 /**
  * Reason why a transaction was removed from the mempool, this is passed to the
  * notification signal.
@@ -357,6 +475,8 @@ private:
     const int m_check_ratio;
     //! Used by getblocktemplate to trigger CreateNewBlock() invocation
     std::atomic<uint32_t> nTransactionsUpdated{0};
+    //! Number of fee deltas applied to transactions in the mempool
+    uint64_t m_fee_deltas_updated GUARDED_BY(cs){0};
 
     //! sum of all mempool tx's sizes.
     uint64_t totalTxSize GUARDED_BY(cs);
@@ -408,9 +528,19 @@ public:
             boost::multi_index::ordered_unique<
                 boost::multi_index::tag<entry_id>,
                 boost::multi_index::identity<CTxMemPoolEntryRef>,
-                CompareTxMemPoolEntryByEntryId>>>
+                CompareTxMemPoolEntryByEntryId>>,
+        // The nodes hold the entry pointer and the hooks of the four indices,
+        // about 12 pointers. They are allocated from a pool so they are
+        // packed in large chunks without a per-node malloc overhead.
+        PoolAllocator<CTxMemPoolEntryRef,
+                      sizeof(CTxMemPoolEntryRef) + 16 * sizeof(void *)>>
         indexed_transaction_set;
 
+private:
+    //! Must outlive mapTx, so it is declared first.
+    indexed_transaction_set::allocator_type::ResourceType m_map_tx_resource;
+
+public:
     /**
      * This mutex needs to be locked when accessing `mapTx` or other members
      * that are guarded by it.
@@ -439,7 +569,8 @@ public:
      * the mempool is consistent with the new chain tip and fully populated.
      */
     mutable RecursiveMutex cs;
-    indexed_transaction_set mapTx GUARDED_BY(cs);
+    indexed_transaction_set mapTx GUARDED_BY(cs){
+        indexed_transaction_set::ctor_args_list(), &m_map_tx_resource};
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
     typedef std::set<txiter, CompareIteratorById> setEntries;
@@ -497,7 +628,9 @@ public:
                int64_t spendheight) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     // addUnchecked must update state for all parents of a given transaction,
-    // updating child links as necessary.
+    // updating child links as necessary. Like removeRecursive, removeConflicts,
+    // TrimToSize and Expire, it doesn't publish the change to the snapshot
+    // readers, see PublishSnapshot().
     void addUnchecked(CTxMemPoolEntryRef entry)
         EXCLUSIVE_LOCKS_REQUIRED(cs, cs_main);
 
@@ -528,6 +661,13 @@ public:
     void ApplyDelta(const TxId &txid, Amount &nFeeDelta) const
         EXCLUSIVE_LOCKS_REQUIRED(cs);
     void ClearPrioritisation(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /**
+     * Number of times the modified fee of a transaction in the mempool was
+     * changed by PrioritiseTransaction.
+     */
+    uint64_t GetFeeDeltasUpdated() const EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        return m_fee_deltas_updated;
+    }
 
     /** Get the transaction in the pool that spends the same prevout */
     const CTransaction *GetConflictTx(const COutPoint &prevout) const
@@ -648,13 +788,30 @@ public:
 
     size_t DynamicMemoryUsage() const;
 
+    /**
+     * Returns the latest snapshot of the mempool content. This doesn't lock
+     * mempool.cs, and doesn't see the changes of a batch in progress.
+     */
+    RCUPtr<const CTxMemPoolSnapshot> GetSnapshot() const;
+
+    /**
+     * Publish the current mempool content as the latest snapshot. This is done
+     * once per batch of changes rather than after each of them, so the readers
+     * never see a block or a package partially applied: at the end of
+     * removeForBlock and LimitSize, which ends the transaction submissions and
+     * the reorgs, and by the callers that change the mempool otherwise.
+     */
+    void PublishSnapshot() EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Adds a transaction to the unbroadcast set */
     void AddUnbroadcastTx(const TxId &txid) {
         LOCK(cs);
         // Sanity check the transaction is in the mempool & insert into
         // unbroadcast set.
-        if (exists(txid)) {
-            m_unbroadcast_txids.insert(txid);
+        auto it = mapTx.find(txid);
+        if (it != mapTx.end() && m_unbroadcast_txids.insert(txid).second) {
+            UpdateSnapshotEntry(**it);
+            PublishSnapshot();
         }
     }
 
@@ -709,6 +866,15 @@ private:
      */
     void removeUnchecked(txiter entry, MemPoolRemovalReason reason)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** Entries of the next snapshot to be published. */
+    CTxMemPoolSnapshot::Entries m_snapshot_entries GUARDED_BY(cs);
+    /** Latest published snapshot, owning a reference. */
+    std::atomic<const CTxMemPoolSnapshot *> m_snapshot{nullptr};
+
+    /** Refresh the snapshot entry of a transaction after it changed. */
+    void UpdateSnapshotEntry(const CTxMemPoolEntry &entry)
+        EXCLUSIVE_LOCKS_REQUIRED(cs);
 };
 
 /**
@@ -8,6 +8,7 @@
 #include <logging.h>
 #include <policy/policy.h>
 
+#include <algorithm>
 #include <cassert>
 
 /** Expiration time for orphan transactions in seconds */
@@ -39,17 +40,22 @@ bool TxOrphanage::AddTx(const CTransactionRef &tx, NodeId peer) {
         return false;
     }
 
+    PeerOrphans &peer_orphans = m_peer_orphans[peer];
     auto ret = m_orphans.emplace(
         txid, OrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME,
-                       m_orphan_list.size()});
+                       peer_orphans.orphans.size()});
     assert(ret.second);
-    m_orphan_list.push_back(ret.first);
+    peer_orphans.orphans.push_back(ret.first);
+    peer_orphans.bytes += sz;
+    m_total_orphan_bytes += sz;
     for (const CTxIn &txin : tx->vin) {
         m_outpoint_to_orphan_it[txin.prevout].insert(ret.first);
     }
 
-    LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u)\n",
-             txid.ToString(), m_orphans.size(), m_outpoint_to_orphan_it.size());
+    LogPrint(BCLog::MEMPOOL,
+             "stored orphan tx %s (mapsz %u outsz %u bytes %u)\n",
+             txid.ToString(), m_orphans.size(), m_outpoint_to_orphan_it.size(),
+             m_total_orphan_bytes);
     return true;
 }
 
@@ -70,16 +76,26 @@ int TxOrphanage::EraseTx(const TxId &txid) {
         }
     }
 
-    size_t old_pos = it->second.list_pos;
-    assert(m_orphan_list[old_pos] == it);
-    if (old_pos + 1 != m_orphan_list.size()) {
-        // Unless we're deleting the last entry in m_orphan_list, move the last
-        // entry to the position we're deleting.
-        auto it_last = m_orphan_list.back();
-        m_orphan_list[old_pos] = it_last;
-        it_last->second.list_pos = old_pos;
+    auto peer_it = m_peer_orphans.find(it->second.fromPeer);
+    assert(peer_it != m_peer_orphans.end());
+    std::vector<OrphanMap::iterator> &peer_list = peer_it->second.orphans;
+    size_t old_pos = it->second.peer_list_pos;
+    assert(peer_list[old_pos] == it);
+    if (old_pos + 1 != peer_list.size()) {
+        // Unless we're deleting the last entry in the peer's list, move the
+        // last entry to the position we're deleting.
+        auto it_last = peer_list.back();
+        peer_list[old_pos] = it_last;
+        it_last->second.peer_list_pos = old_pos;
+    }
+    peer_list.pop_back();
+
+    const size_t sz = it->second.tx->GetTotalSize();
+    peer_it->second.bytes -= sz;
+    m_total_orphan_bytes -= sz;
+    if (peer_list.empty()) {
+        m_peer_orphans.erase(peer_it);
     }
-    m_orphan_list.pop_back();
 
     m_orphans.erase(it);
     return 1;
@@ -88,14 +104,16 @@ int TxOrphanage::EraseTx(const TxId &txid) {
 void TxOrphanage::EraseForPeer(NodeId peer) {
     AssertLockHeld(g_cs_orphans);
 
+    auto peer_it = m_peer_orphans.find(peer);
+    if (peer_it == m_peer_orphans.end()) {
+        return;
+    }
+
+    // The peer's entry is erased along with its last orphan.
     int nErased = 0;
-    std::map<TxId, OrphanTx>::iterator iter = m_orphans.begin();
-    while (iter != m_orphans.end()) {
-        std::map<TxId, OrphanTx>::iterator maybeErase =
-            iter++; // increment to avoid iterator becoming invalid
-        if (maybeErase->second.fromPeer == peer) {
-            nErased += EraseTx(maybeErase->second.tx->GetId());
-        }
+    size_t nRemaining = peer_it->second.orphans.size();
+    while (nRemaining-- > 0) {
+        nErased += EraseTx(peer_it->second.orphans.back()->first);
     }
     if (nErased > 0) {
         LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx from peer=%d\n", nErased,
@@ -103,7 +121,8 @@ void TxOrphanage::EraseForPeer(NodeId peer) {
     }
 }
 
-unsigned int TxOrphanage::LimitOrphans(unsigned int max_orphans) {
+unsigned int TxOrphanage::LimitOrphans(unsigned int max_orphans,
+                                       size_t max_orphans_bytes) {
     AssertLockHeld(g_cs_orphans);
 
     unsigned int nEvicted = 0;
@@ -133,10 +152,28 @@ unsigned int TxOrphanage::LimitOrphans(unsigned int max_orphans) {
         }
     }
     FastRandomContext rng;
-    while (m_orphans.size() > max_orphans) {
-        // Evict a random orphan:
-        size_t randompos = rng.randrange(m_orphan_list.size());
-        EraseTx(m_orphan_list[randompos]->first);
+    while (m_orphans.size() > max_orphans ||
+           m_total_orphan_bytes > max_orphans_bytes) {
+        // Pick the peer using the most of the exceeded limit. This is linear
+        // in the number of peers with orphans, which is bounded by the number
+        // of connections.
+        const bool over_bytes = m_total_orphan_bytes > max_orphans_bytes;
+        auto usage = [over_bytes](const PeerOrphans &peer_orphans) {
+            return over_bytes ? peer_orphans.bytes
+                              : peer_orphans.orphans.size();
+        };
+        auto victim = std::max_element(
+            m_peer_orphans.begin(), m_peer_orphans.end(),
+            [&usage](const auto &a, const auto &b) {
+                return usage(a.second) < usage(b.second);
+            });
+        assert(victim != m_peer_orphans.end());
+
+        // Evict a random orphan from that peer:
+        const std::vector<OrphanMap::iterator> &victim_list =
+            victim->second.orphans;
+        size_t randompos = rng.randrange(victim_list.size());
+        EraseTx(victim_list[randompos]->first);
         ++nEvicted;
     }
     return nEvicted;
@@ -9,6 +9,12 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <sync.h>
+#include <util/hasher.h>
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 /** Guards orphan transactions and extra txs for compact blocks */
 extern RecursiveMutex g_cs_orphans;
@@ -16,8 +22,8 @@ extern RecursiveMutex g_cs_orphans;
 /**
  * A class to track orphan transactions (failed on TX_MISSING_INPUTS)
  * Since we cannot distinguish orphans from bad transactions with
- * non-existent inputs, we heavily limit the number of orphans
- * we keep and the duration we keep them for.
+ * non-existent inputs, we heavily limit the number and total size of the
+ * orphans we keep and the duration we keep them for.
  */
 class TxOrphanage {
 public:
@@ -46,8 +52,15 @@ public:
     /** Erase all orphans included in or invalidated by a new block */
     void EraseForBlock(const CBlock &block) LOCKS_EXCLUDED(g_cs_orphans);
 
-    /** Limit the orphanage to the given maximum */
-    unsigned int LimitOrphans(unsigned int max_orphans)
+    /**
+     * Limit the orphanage to the given maximum number of orphans and total
+     * size in bytes. Orphans are evicted from the peer that announced the most
+     * orphans, or the most bytes of orphans when over the size limit, so that
+     * a peer flooding the orphanage evicts its own orphans rather than those
+     * of other peers.
+     */
+    unsigned int LimitOrphans(unsigned int max_orphans,
+                              size_t max_orphans_bytes)
         EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans);
 
     /**
@@ -65,17 +78,24 @@ public:
         return m_orphans.size();
     }
 
+    /** Return the total size in bytes of the orphans */
+    size_t TotalOrphanBytes() const EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans) {
+        return m_total_orphan_bytes;
+    }
+
 protected:
     struct OrphanTx {
         CTransactionRef tx;
         NodeId fromPeer;
         int64_t nTimeExpire;
-        size_t list_pos;
+        //! Position in the orphans of the announcing peer
+        size_t peer_list_pos;
     };
 
     /**
      * Map from txid to orphan transaction record. Limited by
-     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS
+     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS and
+     *  -maxorphantxsize/DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE
      */
     std::map<TxId, OrphanTx> m_orphans GUARDED_BY(g_cs_orphans);
 
@@ -91,11 +111,23 @@ protected:
      * Index from the parents' COutPoint into the m_orphans. Used
      *  to remove orphan transactions from the m_orphans
      */
-    std::map<COutPoint, std::set<OrphanMap ::iterator, IteratorComparator>>
+    std::unordered_map<COutPoint,
+                       std::set<OrphanMap::iterator, IteratorComparator>,
+                       SaltedOutpointHasher>
         m_outpoint_to_orphan_it GUARDED_BY(g_cs_orphans);
 
-    /** Orphan transactions in vector for quick random eviction */
-    std::vector<OrphanMap::iterator> m_orphan_list GUARDED_BY(g_cs_orphans);
+    struct PeerOrphans {
+        /** Orphan transactions in vector for quick random eviction */
+        std::vector<OrphanMap::iterator> orphans;
+        /** Total size in bytes of these orphans */
+        size_t bytes{0};
+    };
+
+    /** The orphans announced by each peer that has any */
+    std::map<NodeId, PeerOrphans> m_peer_orphans GUARDED_BY(g_cs_orphans);
+
+    /** Total size in bytes of the orphans */
+    size_t m_total_orphan_bytes GUARDED_BY(g_cs_orphans){0};
 };
 
 #endif // BITCOIN_TXORPHANAGE_H
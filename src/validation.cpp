@@ -37,6 +37,7 @@
 #include <pow/pow.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <pubkey.h>
 #include <random.h>
 #include <reverse_iterator.h>
 #include <script/script.h>
@@ -51,6 +52,7 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <util/trace.h>
 #include <util/translation.h>
 #include <validationinterface.h>
@@ -59,11 +61,15 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <deque>
+#include <future>
 #include <numeric>
 #include <optional>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
 
 using node::BLOCKFILE_CHUNK_SIZE;
 using node::BlockManager;
@@ -75,6 +81,7 @@ using node::fReindex;
 using node::nPruneTarget;
 using node::OpenBlockFile;
 using node::ReadBlockFromDisk;
+using node::SerializedCoinsHasher;
 using node::SnapshotMetadata;
 using node::UNDOFILE_CHUNK_SIZE;
 using node::UndoReadFromDisk;
@@ -87,6 +94,11 @@ using node::UnlinkPrunedFiles;
 static constexpr std::chrono::hours DATABASE_WRITE_INTERVAL{1};
 /** Time to wait between flushing chainstate to disk. */
 static constexpr std::chrono::hours DATABASE_FLUSH_INTERVAL{24};
+/**
+ * Percentage of the coins cache size that the coins cache is trimmed to when
+ * it is flushed because it is full.
+ */
+static constexpr int COINS_CACHE_TRIM_PERCENT{50};
 const std::vector<std::string> CHECKLEVEL_DOC{
     "level 0 reads the blocks from disk",
     "level 1 verifies block validity",
@@ -116,6 +128,9 @@ uint256 g_best_block;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool g_parallel_connect = DEFAULT_PARALLEL_CONNECT;
+int g_prefetch_blocks = node::DEFAULT_PREFETCH_BLOCKS;
+bool g_background_flush = DEFAULT_BACKGROUND_FLUSH;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 
 BlockHash hashAssumeValid;
@@ -285,6 +300,37 @@ static bool CheckInputsFromMempoolAndCache(
                              /*scriptCacheStore=*/true, txdata, nSigChecksOut);
 }
 
+namespace {
+/**
+ * Runs the script checks of a transaction submitted to the mempool along with
+ * other ones. Failures are recorded rather than returned, so the other
+ * transactions are still checked, and each one gets its own outcome.
+ */
+class CTxScriptsCheck {
+private:
+    std::vector<CScriptCheck> *pChecks{nullptr};
+    bool *pfOk{nullptr};
+
+public:
+    CTxScriptsCheck() = default;
+
+    CTxScriptsCheck(std::vector<CScriptCheck> &checksIn, bool &fOkIn)
+        : pChecks(&checksIn), pfOk(&fOkIn) {}
+
+    bool operator()() {
+        *pfOk = RunCheckBatch(*pChecks);
+        return true;
+    }
+
+    void swap(CTxScriptsCheck &check) noexcept {
+        std::swap(pChecks, check.pChecks);
+        std::swap(pfOk, check.pfOk);
+    }
+};
+} // namespace
+
+static CCheckQueue<CTxScriptsCheck> txscriptscheckqueue(4, "mempch");
+
 namespace {
 
 class MemPoolAccept {
@@ -316,20 +362,27 @@ public:
          * enforced at the end to ensure the package is not partially submitted.
          */
         const bool m_package_submission;
+        /**
+         * Transactions paying a higher fee rate than this are rejected, unless
+         * it is zero.
+         */
+        const CFeeRate m_max_fee_rate;
 
         /** Parameters for single transaction mempool validation. */
-        static ATMPArgs SingleAccept(const Config &config, int64_t accept_time,
-                                     bool bypass_limits,
-                                     std::vector<COutPoint> &coins_to_uncache,
-                                     bool test_accept,
-                                     unsigned int heightOverride) {
+        static ATMPArgs
+        SingleAccept(const Config &config, int64_t accept_time,
+                     bool bypass_limits,
+                     std::vector<COutPoint> &coins_to_uncache, bool test_accept,
+                     unsigned int heightOverride,
+                     const CFeeRate &max_fee_rate = CFeeRate()) {
             return ATMPArgs{config,
                             accept_time,
                             bypass_limits,
                             coins_to_uncache,
                             test_accept,
                             heightOverride,
-                            /*package_submission=*/false};
+                            /*package_submission=*/false,
+                            max_fee_rate};
         }
 
         /**
@@ -344,7 +397,8 @@ public:
                             /*test_accept=*/true,
                             /*height_override=*/0,
                             // not submitting to mempool
-                            /*package_submission=*/false};
+                            /*package_submission=*/false,
+                            /*max_fee_rate=*/CFeeRate()};
         }
 
         /** Parameters for child-with-unconfirmed-parents package validation. */
@@ -357,7 +411,28 @@ public:
                             coins_to_uncache,
                             /*test_accept=*/false,
                             /*height_override=*/0,
-                            /*package_submission=*/true};
+                            /*package_submission=*/true,
+                            /*max_fee_rate=*/CFeeRate()};
+        }
+
+        /**
+         * Parameters for the validation of independent transactions submitted
+         * together.
+         */
+        static ATMPArgs BatchAccept(const Config &config, int64_t accept_time,
+                                    std::vector<COutPoint> &coins_to_uncache,
+                                    bool test_accept,
+                                    const CFeeRate &max_fee_rate) {
+            return ATMPArgs{config,
+                            accept_time,
+                            /*bypass_limits=*/false,
+                            coins_to_uncache,
+                            test_accept,
+                            /*height_override=*/0,
+                            // the mempool is trimmed once all the
+                            // transactions are submitted
+                            /*package_submission=*/true,
+                            max_fee_rate};
         }
 
     private:
@@ -366,12 +441,14 @@ public:
         // functions above instead.
         ATMPArgs(const Config &config, int64_t accept_time, bool bypass_limits,
                  std::vector<COutPoint> &coins_to_uncache, bool test_accept,
-                 unsigned int height_override, bool package_submission)
+                 unsigned int height_override, bool package_submission,
+                 const CFeeRate &max_fee_rate)
             : m_config{config}, m_accept_time{accept_time},
               m_bypass_limits{bypass_limits},
               m_coins_to_uncache{coins_to_uncache}, m_test_accept{test_accept},
-              m_heightOverride{height_override}, m_package_submission{
-                                                     package_submission} {}
+              m_heightOverride{height_override},
+              m_package_submission{package_submission}, m_max_fee_rate{
+                                                            max_fee_rate} {}
     };
 
     // Single transaction acceptance
@@ -399,6 +476,21 @@ public:
                                              ATMPArgs &args)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Acceptance of transactions submitted together, whose script checks are
+     * run in parallel. The transactions are submitted in order.
+     *
+     * A transaction that spends an output of an earlier transaction, or an
+     * outpoint that an earlier transaction spends, is not validated. Neither
+     * is one whose script checks fail, so that it gets the detailed result of
+     * AcceptSingleTransaction. The caller is expected to validate these one by
+     * one afterwards, for which their result is left empty.
+     */
+    std::vector<std::optional<MempoolAcceptResult>>
+    AcceptIndependentTransactions(const std::vector<CTransactionRef> &txns,
+                                  ATMPArgs &args)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 private:
     // All the intermediate state that gets passed between the various levels
     // of checking a given transaction.
@@ -445,6 +537,18 @@ private:
         // ConsensusScriptChecks
         const uint32_t m_next_block_script_verify_flags;
         int m_sig_checks_standard;
+
+        // Found by PreChecks, for the mempool entry.
+        LockPoints m_lock_points;
+        bool m_spends_coinbase{false};
+
+        TxSigCheckLimiter m_sig_check_limiter;
+        /**
+         * The policy script checks deferred by PolicyScriptChecks, and whether
+         * they succeeded once they are run.
+         */
+        std::vector<CScriptCheck> m_script_checks;
+        bool m_script_checks_ok{true};
     };
 
     // Run the policy checks on a given transaction, excluding any script
@@ -455,6 +559,20 @@ private:
     bool PreChecks(ATMPArgs &args, Workspace &ws)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
+    // Run the script checks using policy flags. As this can be slow, we should
+    // only invoke this on transactions that have passed PreChecks. When
+    // defer_checks is true, the checks that are not cached are added to
+    // ws.m_script_checks instead of being run, and the caller must run them
+    // and set ws.m_sig_checks_standard.
+    bool PolicyScriptChecks(const ATMPArgs &args, Workspace &ws,
+                            bool defer_checks = false)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
+    // Create the mempool entry once the sigchecks count of the transaction is
+    // known, and check that it pays the mempool minimum fee.
+    bool CreateEntry(const ATMPArgs &args, Workspace &ws)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
     // Re-run the script checks, using consensus flags, and try to cache the
     // result in the scriptcache. This should be done after
     // PolicyScriptChecks(). This requires that all inputs either be in our
@@ -491,15 +609,12 @@ private:
 bool MemPoolAccept::PreChecks(ATMPArgs &args, Workspace &ws) {
     AssertLockHeld(cs_main);
     AssertLockHeld(m_pool.cs);
-    const CTransactionRef &ptx = ws.m_ptx;
     const CTransaction &tx = *ws.m_ptx;
     const TxId &txid = ws.m_ptx->GetId();
 
     // Copy/alias what we need out of args
-    const int64_t nAcceptTime = args.m_accept_time;
     const bool bypass_limits = args.m_bypass_limits;
     std::vector<COutPoint> &coins_to_uncache = args.m_coins_to_uncache;
-    const unsigned int heightOverride = args.m_heightOverride;
 
     // Alias what we need out of ws
     TxValidationState &state = ws.m_state;
@@ -545,7 +660,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs &args, Workspace &ws) {
         }
     }
 
-    LockPoints lp;
+    LockPoints &lp = ws.m_lock_points;
     m_view.SetBackend(m_viewmempool);
 
     const CCoinsViewCache &coins_cache = m_active_chainstate.CoinsTip();
@@ -628,17 +743,27 @@ bool MemPoolAccept::PreChecks(ATMPArgs &args, Workspace &ws) {
 
     // Keep track of transactions that spend a coinbase, which we re-scan
     // during reorgs to ensure COINBASE_MATURITY is still met.
-    bool fSpendsCoinbase = false;
     for (const CTxIn &txin : tx.vin) {
         const Coin &coin = m_view.AccessCoin(txin.prevout);
         if (coin.IsCoinBase()) {
-            fSpendsCoinbase = true;
+            ws.m_spends_coinbase = true;
             break;
         }
     }
 
     unsigned int nSize = tx.GetTotalSize();
 
+    // Don't accept transactions paying more than the caller is willing to.
+    if (args.m_max_fee_rate.GetFeePerK() > Amount::zero()) {
+        const Amount max_fee =
+            args.m_max_fee_rate.GetFee(GetVirtualTransactionSize(tx));
+        if (ws.m_base_fees > max_fee) {
+            return state.Invalid(
+                TxValidationResult::TX_MEMPOOL_POLICY, "max-fee-exceeded",
+                strprintf("%d > %d", ws.m_base_fees, max_fee));
+        }
+    }
+
     // No transactions are allowed below minRelayTxFee except from disconnected
     // blocks.
     // Do not change this to use virtualsize without coordinating a network
@@ -650,25 +775,46 @@ bool MemPoolAccept::PreChecks(ATMPArgs &args, Workspace &ws) {
                                        ::minRelayTxFee.GetFee(nSize)));
     }
 
+    return true;
+}
+
+bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs &args, Workspace &ws,
+                                       bool defer_checks) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+    const CTransaction &tx = *ws.m_ptx;
+    TxValidationState &state = ws.m_state;
+
     // Validate input scripts against standard script flags.
     const uint32_t scriptVerifyFlags =
         ws.m_next_block_script_verify_flags | STANDARD_SCRIPT_VERIFY_FLAGS;
     ws.m_precomputed_txdata = PrecomputedTransactionData{tx};
     if (!CheckInputScripts(tx, state, m_view, scriptVerifyFlags, true, false,
-                           ws.m_precomputed_txdata, ws.m_sig_checks_standard)) {
+                           ws.m_precomputed_txdata, ws.m_sig_checks_standard,
+                           ws.m_sig_check_limiter, nullptr,
+                           defer_checks ? &ws.m_script_checks : nullptr)) {
         // State filled in by CheckInputScripts
         return false;
     }
 
+    return true;
+}
+
+bool MemPoolAccept::CreateEntry(const ATMPArgs &args, Workspace &ws) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+    const unsigned int heightOverride = args.m_heightOverride;
+    TxValidationState &state = ws.m_state;
+
     ws.m_entry = std::make_unique<CTxMemPoolEntry>(
-        ptx, ws.m_base_fees, nAcceptTime,
+        ws.m_ptx, ws.m_base_fees, args.m_accept_time,
         heightOverride ? heightOverride : m_active_chainstate.m_chain.Height(),
-        fSpendsCoinbase, ws.m_sig_checks_standard, lp);
+        ws.m_spends_coinbase, ws.m_sig_checks_standard, ws.m_lock_points);
 
     ws.m_vsize = ws.m_entry->GetTxVirtualSize();
 
     Amount mempoolRejectFee = m_pool.GetMinFee().GetFee(ws.m_vsize);
-    if (!bypass_limits && mempoolRejectFee > Amount::zero() &&
+    if (!args.m_bypass_limits && mempoolRejectFee > Amount::zero() &&
         ws.m_modified_fees < mempoolRejectFee) {
         return state.Invalid(
             TxValidationResult::TX_MEMPOOL_POLICY, "mempool min fee not met",
@@ -855,6 +1001,10 @@ MemPoolAccept::AcceptSingleTransaction(const CTransactionRef &ptx,
         return MempoolAcceptResult::Failure(ws.m_state);
     }
 
+    if (!PolicyScriptChecks(args, ws) || !CreateEntry(args, ws)) {
+        return MempoolAcceptResult::Failure(ws.m_state);
+    }
+
     if (!ConsensusScriptChecks(args, ws)) {
         return MempoolAcceptResult::Failure(ws.m_state);
     }
@@ -925,7 +1075,8 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(
     // Do all PreChecks first and fail fast to avoid running expensive script
     // checks when unnecessary.
     for (Workspace &ws : workspaces) {
-        if (!PreChecks(args, ws)) {
+        if (!PreChecks(args, ws) || !PolicyScriptChecks(args, ws) ||
+            !CreateEntry(args, ws)) {
             package_state.Invalid(PackageValidationResult::PCKG_TX,
                                   "transaction failed");
             // Exit early to avoid doing pointless work. Update the failed tx
@@ -1071,6 +1222,132 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptPackage(const Package &package,
     }
     return submission_result;
 }
+
+std::vector<std::optional<MempoolAcceptResult>>
+MemPoolAccept::AcceptIndependentTransactions(
+    const std::vector<CTransactionRef> &txns, ATMPArgs &args) {
+    AssertLockHeld(cs_main);
+    // mempool "read lock" (held through
+    // GetMainSignals().TransactionAddedToMempool())
+    LOCK(m_pool.cs);
+
+    const uint32_t next_block_script_verify_flags = GetNextBlockScriptFlags(
+        args.m_config.GetChainParams().GetConsensus(),
+        m_active_chainstate.m_chain.Tip());
+
+    std::vector<std::optional<MempoolAcceptResult>> results(txns.size());
+    // The workspaces are not moved once created, as the script checks point
+    // to their sigchecks limiter.
+    std::vector<Workspace> workspaces;
+    workspaces.reserve(txns.size());
+    std::vector<size_t> workspace_indices;
+
+    // Run the inexpensive checks in order, and prepare the script checks of
+    // the transactions that don't depend on, or conflict with, an earlier one.
+    std::unordered_set<TxId, SaltedTxIdHasher> batch_txids;
+    std::unordered_set<COutPoint, SaltedOutpointHasher> batch_spent;
+    for (size_t i = 0; i < txns.size(); i++) {
+        const CTransaction &tx = *txns[i];
+        bool independent = batch_txids.insert(tx.GetId()).second;
+        for (const CTxIn &txin : tx.vin) {
+            if (batch_txids.count(txin.prevout.GetTxId()) ||
+                !batch_spent.insert(txin.prevout).second) {
+                independent = false;
+            }
+        }
+        if (!independent) {
+            continue;
+        }
+
+        Workspace &ws =
+            workspaces.emplace_back(txns[i], next_block_script_verify_flags);
+        workspace_indices.push_back(i);
+        if (!PreChecks(args, ws) ||
+            !PolicyScriptChecks(args, ws, /*defer_checks=*/true)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+        }
+    }
+
+    // Run the script checks on the worker threads.
+    {
+        std::vector<CTxScriptsCheck> vChecks;
+        vChecks.reserve(workspaces.size());
+        for (size_t w = 0; w < workspaces.size(); w++) {
+            Workspace &ws = workspaces[w];
+            if (!results[workspace_indices[w]] && !ws.m_script_checks.empty()) {
+                vChecks.emplace_back(ws.m_script_checks,
+                                     ws.m_script_checks_ok);
+            }
+        }
+        CCheckQueueControl<CTxScriptsCheck> control(&txscriptscheckqueue);
+        control.Add(vChecks);
+        control.Wait();
+    }
+
+    // Finally, submit the valid transactions in order.
+    std::vector<size_t> submitted;
+    for (size_t w = 0; w < workspaces.size(); w++) {
+        Workspace &ws = workspaces[w];
+        const size_t i = workspace_indices[w];
+        if (results[i]) {
+            continue;
+        }
+        if (!ws.m_script_checks.empty()) {
+            if (!ws.m_script_checks_ok) {
+                continue;
+            }
+            ws.m_sig_checks_standard = 0;
+            for (const CScriptCheck &check : ws.m_script_checks) {
+                ws.m_sig_checks_standard +=
+                    check.GetScriptExecutionMetrics().nSigChecks;
+            }
+        }
+
+        if (!CreateEntry(args, ws) || !ConsensusScriptChecks(args, ws)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+
+        if (args.m_test_accept) {
+            results[i].emplace(
+                MempoolAcceptResult::Success(ws.m_vsize, ws.m_base_fees));
+            continue;
+        }
+
+        if (!Finalize(args, ws)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+        submitted.push_back(w);
+    }
+
+    if (args.m_test_accept) {
+        return results;
+    }
+
+    // Like for packages, the mempool is only trimmed once all the
+    // transactions are submitted, since trimming it may evict the mempool
+    // parents of the following ones.
+    m_pool.LimitSize(m_active_chainstate.CoinsTip());
+    for (const size_t w : submitted) {
+        Workspace &ws = workspaces[w];
+        const size_t i = workspace_indices[w];
+        if (!m_pool.exists(ws.m_ptx->GetId())) {
+            ws.m_state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY,
+                               "mempool full");
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+        results[i].emplace(
+            MempoolAcceptResult::Success(ws.m_vsize, ws.m_base_fees));
+        GetMainSignals().TransactionAddedToMempool(
+            ws.m_ptx,
+            std::make_shared<const std::vector<Coin>>(
+                getSpentCoins(ws.m_ptx, m_view)),
+            m_pool.GetAndIncrementSequence());
+    }
+    return results;
+}
 } // namespace
 
 MempoolAcceptResult AcceptToMemoryPool(const Config &config,
@@ -1145,6 +1422,57 @@ ProcessNewPackage(const Config &config, Chainstate &active_chainstate,
     return result;
 }
 
+std::vector<MempoolAcceptResult>
+ProcessNewTransactions(const Config &config, Chainstate &active_chainstate,
+                       CTxMemPool &pool,
+                       const std::vector<CTransactionRef> &txns,
+                       bool test_accept, const CFeeRate &max_fee_rate) {
+    AssertLockHeld(cs_main);
+    assert(std::all_of(txns.cbegin(), txns.cend(),
+                       [](const auto &tx) { return tx != nullptr; }));
+
+    std::vector<COutPoint> coins_to_uncache;
+    auto args = MemPoolAccept::ATMPArgs::BatchAccept(
+        config, GetTime(), coins_to_uncache, test_accept, max_fee_rate);
+    std::vector<std::optional<MempoolAcceptResult>> batch_results =
+        MemPoolAccept(pool, active_chainstate)
+            .AcceptIndependentTransactions(txns, args);
+
+    // The transactions that were left out of the batch are validated one by
+    // one, in order, now that the transactions they depend on are submitted.
+    std::vector<MempoolAcceptResult> results;
+    results.reserve(txns.size());
+    bool all_valid = true;
+    for (size_t i = 0; i < txns.size(); i++) {
+        if (!batch_results[i]) {
+            auto single_args = MemPoolAccept::ATMPArgs::SingleAccept(
+                config, GetTime(), /*bypass_limits=*/false, coins_to_uncache,
+                test_accept, /*heightOverride=*/0, max_fee_rate);
+            batch_results[i].emplace(MemPoolAccept(pool, active_chainstate)
+                                         .AcceptSingleTransaction(
+                                             txns[i], single_args));
+        }
+        if (batch_results[i]->m_result_type !=
+            MempoolAcceptResult::ResultType::VALID) {
+            all_valid = false;
+        }
+        results.push_back(std::move(*batch_results[i]));
+    }
+
+    // Uncache coins pertaining to transactions that were not submitted to the
+    // mempool. The coins are not tracked per transaction, so this includes
+    // the coins spent by the valid transactions if any of them failed.
+    if (test_accept || !all_valid) {
+        for (const COutPoint &outpoint : coins_to_uncache) {
+            active_chainstate.CoinsTip().Uncache(outpoint);
+        }
+    }
+    // Ensure the coins cache is still within limits.
+    BlockValidationState state_dummy;
+    active_chainstate.FlushStateToDisk(state_dummy, FlushStateMode::PERIODIC);
+    return results;
+}
+
 Amount GetBlockSubsidy(int nHeight, const Consensus::Params &consensusParams) {
     int halvings = nHeight / consensusParams.nSubsidyHalvingInterval;
     // Force block reward to zero when right shift is undefined.
@@ -1392,13 +1720,19 @@ void UpdateCoins(CCoinsViewCache &view, const CTransaction &tx, CTxUndo &txundo,
 }
 
 bool CScriptCheck::operator()() {
+    return VerifyScript(nullptr) && ConsumeSigChecks();
+}
+
+bool CScriptCheck::VerifyScript(CSchnorrBatch *schnorr_batch) {
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
-    if (!VerifyScript(scriptSig, m_tx_out.scriptPubKey, nFlags,
-                      CachingTransactionSignatureChecker(
-                          ptxTo, nIn, m_tx_out.nValue, cacheStore, txdata),
-                      metrics, &error)) {
-        return false;
-    }
+    return ::VerifyScript(scriptSig, m_tx_out.scriptPubKey, nFlags,
+                          CachingTransactionSignatureChecker(
+                              ptxTo, nIn, m_tx_out.nValue, cacheStore, txdata,
+                              schnorr_batch),
+                          metrics, &error);
+}
+
+bool CScriptCheck::ConsumeSigChecks() {
     if ((pTxLimitSigChecks &&
          !pTxLimitSigChecks->consume_and_check(metrics.nSigChecks)) ||
         (pBlockLimitSigChecks &&
@@ -1412,6 +1746,39 @@ bool CScriptCheck::operator()() {
     return true;
 }
 
+bool RunCheckBatch(std::vector<CScriptCheck> &checks) {
+    CSchnorrBatch schnorr_batch;
+    bool fOk = true;
+    for (CScriptCheck &check : checks) {
+        if (!check.VerifyScript(&schnorr_batch)) {
+            fOk = false;
+            break;
+        }
+    }
+
+    if (fOk && schnorr_batch.Verify()) {
+        // The scripts ran with the actual signature results, so they are
+        // valid. The sigchecks are only consumed now so that they are not
+        // counted twice if we fall back to the checks below.
+        for (CScriptCheck &check : checks) {
+            if (!check.ConsumeSigChecks()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Either a signature is invalid, or a script failed, possibly because it
+    // was run with an invalid signature assumed to be valid. Run the checks
+    // again without batching to get the actual result.
+    for (CScriptCheck &check : checks) {
+        if (!check()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CheckInputScripts(const CTransaction &tx, TxValidationState &state,
                        const CCoinsViewCache &inputs, const uint32_t flags,
                        bool sigCacheStore, bool scriptCacheStore,
@@ -1640,14 +2007,186 @@ DisconnectResult ApplyBlockUndo(CBlockUndo &&blockUndo, const CBlock &block,
     return fClean ? DisconnectResult::OK : DisconnectResult::UNCLEAN;
 }
 
+namespace {
+/**
+ * Parameters shared by all the CTxInputsCheck of a block.
+ */
+struct TxInputsCheckContext {
+    const CBlockIndex *pindex;
+    int nLockTimeFlags;
+    uint32_t flags;
+    bool fScriptChecks;
+    bool fCacheResults;
+    CheckInputsLimiter *pBlockLimitSigChecks;
+};
+
+/**
+ * Outcome of a CTxInputsCheck, applied in block order by ConnectBlock.
+ */
+struct TxInputsCheckResult {
+    //! Outcome of Consensus::CheckTxInputs
+    TxValidationState state;
+    Amount fee{Amount::zero()};
+    //! Whether the transaction is BIP68 final
+    bool fSequenceLocksOk{false};
+    ScriptCacheKey scriptCacheKey;
+    std::vector<CScriptCheck> scriptChecks;
+};
+
+/**
+ * Checks a block transaction against the coins it spends, as found in its undo
+ * data, and prepares its script checks. This neither touches the coins view
+ * nor the script cache, so it is safe to run on the worker threads while
+ * ConnectBlock holds cs_main.
+ */
+class CTxInputsCheck {
+private:
+    const CTransaction *ptx{nullptr};
+    const CTxUndo *ptxundo{nullptr};
+    const TxInputsCheckContext *pcontext{nullptr};
+    TxSigCheckLimiter *pTxLimitSigChecks{nullptr};
+    TxInputsCheckResult *presult{nullptr};
+
+public:
+    CTxInputsCheck() = default;
+
+    CTxInputsCheck(const CTransaction &txIn, const CTxUndo &txundoIn,
+                   const TxInputsCheckContext &contextIn,
+                   TxSigCheckLimiter &txLimitSigChecksIn,
+                   TxInputsCheckResult &resultIn)
+        : ptx(&txIn), ptxundo(&txundoIn), pcontext(&contextIn),
+          pTxLimitSigChecks(&txLimitSigChecksIn), presult(&resultIn) {}
+
+    bool operator()() {
+        const CTransaction &tx = *ptx;
+        const std::vector<Coin> &coins = ptxundo->vprevout;
+        const TxInputsCheckContext &context = *pcontext;
+        TxInputsCheckResult &result = *presult;
+
+        // Failures are recorded in the result rather than returned, so every
+        // transaction gets checked and ConnectBlock reports the first failure
+        // in block order regardless of scheduling.
+        if (!Consensus::CheckTxInputs(tx, result.state, coins,
+                                      context.pindex->nHeight, result.fee)) {
+            return true;
+        }
+
+        std::vector<int> prevheights(coins.size());
+        for (size_t j = 0; j < coins.size(); j++) {
+            prevheights[j] = coins[j].GetHeight();
+        }
+        result.fSequenceLocksOk = SequenceLocks(tx, context.nLockTimeFlags,
+                                                prevheights, *context.pindex);
+        if (!result.fSequenceLocksOk || !context.fScriptChecks) {
+            return true;
+        }
+
+        result.scriptCacheKey = ScriptCacheKey(tx, context.flags);
+        const PrecomputedTransactionData txdata(tx);
+        result.scriptChecks.reserve(coins.size());
+        for (size_t j = 0; j < coins.size(); j++) {
+            result.scriptChecks.emplace_back(
+                coins[j].GetTxOut(), tx, j, context.flags,
+                context.fCacheResults, txdata, pTxLimitSigChecks,
+                context.pBlockLimitSigChecks);
+        }
+        return true;
+    }
+
+    void swap(CTxInputsCheck &check) noexcept {
+        std::swap(ptx, check.ptx);
+        std::swap(ptxundo, check.ptxundo);
+        std::swap(pcontext, check.pcontext);
+        std::swap(pTxLimitSigChecks, check.pTxLimitSigChecks);
+        std::swap(presult, check.presult);
+    }
+};
+
+/**
+ * The root of a subtree of the merkle tree of a block, computed by a
+ * CBlockCheck.
+ */
+struct MerkleSubtree {
+    uint256 root;
+    bool mutated{false};
+};
+
+/**
+ * Part of the context-free checks of a large block, run on the worker threads
+ * by CheckBlock: either computing the root of the merkle subtree whose leaves
+ * are a range of its transactions, or checking these transactions.
+ */
+class CBlockCheck {
+private:
+    const CBlock *pblock{nullptr};
+    size_t nBegin{0};
+    size_t nEnd{0};
+    //! If set, compute the merkle subtree rather than check the transactions.
+    MerkleSubtree *pSubtree{nullptr};
+
+public:
+    CBlockCheck() = default;
+
+    CBlockCheck(const CBlock &blockIn, size_t nBeginIn, size_t nEndIn,
+                MerkleSubtree *pSubtreeIn = nullptr)
+        : pblock(&blockIn), nBegin(nBeginIn), nEnd(nEndIn),
+          pSubtree(pSubtreeIn) {}
+
+    bool operator()() {
+        const CBlock &block = *pblock;
+        if (pSubtree) {
+            std::vector<uint256> leaves(nEnd - nBegin);
+            for (size_t i = nBegin; i < nEnd; i++) {
+                leaves[i - nBegin] = block.vtx[i]->GetId();
+            }
+            pSubtree->root = ComputeMerkleSubtreeRoot(
+                std::move(leaves), MERKLE_SUBTREE_HEIGHT, &pSubtree->mutated);
+            return true;
+        }
+
+        for (size_t i = nBegin; i < nEnd; i++) {
+            TxValidationState tx_state;
+            if (!CheckRegularTransaction(*block.vtx[i], tx_state)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void swap(CBlockCheck &check) noexcept {
+        std::swap(pblock, check.pblock);
+        std::swap(nBegin, check.nBegin);
+        std::swap(nEnd, check.nEnd);
+        std::swap(pSubtree, check.pSubtree);
+    }
+
+    //! Height of the merkle subtrees computed on the worker threads
+    static constexpr int MERKLE_SUBTREE_HEIGHT{10};
+    static constexpr size_t MERKLE_SUBTREE_LEAVES{size_t(1)
+                                                  << MERKLE_SUBTREE_HEIGHT};
+    //! Number of transactions checked by a CBlockCheck
+    static constexpr size_t TXS_PER_CHECK{128};
+};
+} // namespace
+
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+static CCheckQueue<CTxInputsCheck> txinputscheckqueue(16, "txinch");
+static CCheckQueue<CBlockCheck> blockcheckqueue(16, "blkch");
 
 void StartScriptCheckWorkerThreads(int threads_num) {
     scriptcheckqueue.StartWorkerThreads(threads_num);
+    if (g_parallel_connect) {
+        txinputscheckqueue.StartWorkerThreads(threads_num);
+    }
+    blockcheckqueue.StartWorkerThreads(threads_num);
+    txscriptscheckqueue.StartWorkerThreads(threads_num);
 }
 
 void StopScriptCheckWorkerThreads() {
     scriptcheckqueue.StopWorkerThreads();
+    txinputscheckqueue.StopWorkerThreads();
+    blockcheckqueue.StopWorkerThreads();
+    txscriptscheckqueue.StopWorkerThreads();
 }
 
 // Returns the script flags which should be checked for the block after
@@ -2003,95 +2542,215 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
     size_t txIndex = 0;
     // nSigChecksRet may be accurate (found in cache) or 0 (checks were
     // deferred into vChecks).
-    int nSigChecksRet;
-    for (const auto &ptx : block.vtx) {
-        const CTransaction &tx = *ptx;
-        const bool isCoinBase = tx.IsCoinBase();
-        nInputs += tx.vin.size();
+    int nSigChecksRet = 0;
+    // Don't cache results if we're actually connecting blocks (still
+    // consult the cache, though).
+    const bool fCacheResults = fJustCheck;
+    const bool fEnforceSigCheck = flags & SCRIPT_ENFORCE_SIGCHECKS;
+    if (g_parallel_connect) {
+        // All the outputs of the block have been added above, so every input
+        // can be spent in a single pass before anything else is checked.
+        // Spending in block order produces the same undo data as the serial
+        // path and detects double spends at the same transaction. The coins
+        // view is not thread safe, so this part remains serial.
+        size_t nTxSpent = 1;
+        for (; nTxSpent < block.vtx.size(); nTxSpent++) {
+            const CTransaction &tx = *block.vtx[nTxSpent];
+            CTxUndo &txundo = blockundo.vtxundo[nTxSpent - 1];
+            txundo.vprevout.reserve(tx.vin.size());
+            bool fSpent = true;
+            for (const CTxIn &txin : tx.vin) {
+                Coin &coin = txundo.vprevout.emplace_back();
+                if (!view.SpendCoin(txin.prevout, &coin) || coin.IsSpent()) {
+                    fSpent = false;
+                    break;
+                }
+            }
+            if (!fSpent) {
+                break;
+            }
+        }
 
+        // The transactions are then checked against the coins they spend on
+        // the worker threads.
+        const TxInputsCheckContext context{pindex,
+                                           nLockTimeFlags,
+                                           flags,
+                                           fScriptChecks,
+                                           fCacheResults,
+                                           &nSigChecksBlockLimiter};
+        std::vector<TxInputsCheckResult> results(nTxSpent - 1);
         {
-            Amount txfee = Amount::zero();
-            TxValidationState tx_state;
-            if (!isCoinBase &&
-                !Consensus::CheckTxInputs(tx, tx_state, view, pindex->nHeight,
-                                          txfee)) {
-                // Any transaction validation failure in ConnectBlock is a block
-                // consensus failure.
-                state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
-                              tx_state.GetRejectReason(),
-                              tx_state.GetDebugMessage());
+            std::vector<CTxInputsCheck> vTxChecks;
+            vTxChecks.reserve(nTxSpent - 1);
+            for (size_t i = 1; i < nTxSpent; i++) {
+                if (!fEnforceSigCheck) {
+                    nSigChecksTxLimiters[i - 1] =
+                        TxSigCheckLimiter::getDisabled();
+                }
+                vTxChecks.emplace_back(*block.vtx[i], blockundo.vtxundo[i - 1],
+                                       context, nSigChecksTxLimiters[i - 1],
+                                       results[i - 1]);
+            }
+            CCheckQueueControl<CTxInputsCheck> txcontrol(&txinputscheckqueue);
+            txcontrol.Add(vTxChecks);
+            txcontrol.Wait();
+        }
+
+        // Finally, apply the results in block order, failing the same way the
+        // serial path would.
+        nInputs += block.vtx[0]->vin.size();
+        for (size_t i = 1; i < nTxSpent; i++) {
+            const CTransaction &tx = *block.vtx[i];
+            TxInputsCheckResult &result = results[i - 1];
+            nInputs += tx.vin.size();
 
+            if (!result.state.IsValid()) {
+                state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                              result.state.GetRejectReason(),
+                              result.state.GetDebugMessage());
                 return error("%s: Consensus::CheckTxInputs: %s, %s", __func__,
                              tx.GetId().ToString(), state.ToString());
             }
-            nFees += txfee;
-        }
-
-        if (!MoneyRange(nFees)) {
-            LogPrintf("ERROR: %s: accumulated fee in the block out of range.\n",
-                      __func__);
-            return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
-                                 "bad-txns-accumulated-fee-outofrange");
-        }
 
-        // The following checks do not apply to the coinbase.
-        if (isCoinBase) {
-            continue;
-        }
+            nFees += result.fee;
+            if (!MoneyRange(nFees)) {
+                LogPrintf("ERROR: %s: accumulated fee in the block out of "
+                          "range.\n",
+                          __func__);
+                return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                     "bad-txns-accumulated-fee-outofrange");
+            }
 
-        // Check that transaction is BIP68 final BIP68 lock checks (as
-        // opposed to nLockTime checks) must be in ConnectBlock because they
-        // require the UTXO set.
-        prevheights.resize(tx.vin.size());
-        for (size_t j = 0; j < tx.vin.size(); j++) {
-            prevheights[j] = view.AccessCoin(tx.vin[j].prevout).GetHeight();
-        }
+            if (!result.fSequenceLocksOk) {
+                LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n",
+                          __func__);
+                return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                     "bad-txns-nonfinal");
+            }
 
-        if (!SequenceLocks(tx, nLockTimeFlags, prevheights, *pindex)) {
-            LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n",
-                      __func__);
-            return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
-                                 "bad-txns-nonfinal");
-        }
+            if (!fScriptChecks) {
+                continue;
+            }
 
-        // Don't cache results if we're actually connecting blocks (still
-        // consult the cache, though).
-        bool fCacheResults = fJustCheck;
+            // Same as the script cache lookup in CheckInputScripts, which
+            // requires cs_main and so cannot be done by the workers.
+            if (IsKeyInScriptCache(result.scriptCacheKey, !fCacheResults,
+                                   nSigChecksRet)) {
+                if (!nSigChecksTxLimiters[i - 1].consume_and_check(
+                        nSigChecksRet) ||
+                    !nSigChecksBlockLimiter.consume_and_check(nSigChecksRet)) {
+                    state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                  "too-many-sigchecks");
+                    return error("ConnectBlock(): CheckInputScripts on %s "
+                                 "failed with %s",
+                                 tx.GetId().ToString(), state.ToString());
+                }
+                continue;
+            }
 
-        const bool fEnforceSigCheck = flags & SCRIPT_ENFORCE_SIGCHECKS;
-        if (!fEnforceSigCheck) {
-            // Historically, there has been transactions with a very high
-            // sigcheck count, so we need to disable this check for such
-            // transactions.
-            nSigChecksTxLimiters[txIndex] = TxSigCheckLimiter::getDisabled();
+            nSigChecksRet = 0;
+            control.Add(result.scriptChecks);
         }
 
-        std::vector<CScriptCheck> vChecks;
-        TxValidationState tx_state;
-        if (fScriptChecks &&
-            !CheckInputScripts(tx, tx_state, view, flags, fCacheResults,
-                               fCacheResults, PrecomputedTransactionData(tx),
-                               nSigChecksRet, nSigChecksTxLimiters[txIndex],
-                               &nSigChecksBlockLimiter, &vChecks)) {
-            // Any transaction validation failure in ConnectBlock is a block
-            // consensus failure
+        if (nTxSpent < block.vtx.size()) {
             state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
-                          tx_state.GetRejectReason(),
-                          tx_state.GetDebugMessage());
-            return error(
-                "ConnectBlock(): CheckInputScripts on %s failed with %s",
-                tx.GetId().ToString(), state.ToString());
+                          "bad-txns-inputs-missingorspent",
+                          "CheckTxInputs: inputs missing/spent");
+            return error("%s: Consensus::CheckTxInputs: %s, %s", __func__,
+                         block.vtx[nTxSpent]->GetId().ToString(),
+                         state.ToString());
         }
+    } else {
+        for (const auto &ptx : block.vtx) {
+            const CTransaction &tx = *ptx;
+            const bool isCoinBase = tx.IsCoinBase();
+            nInputs += tx.vin.size();
+
+            {
+                Amount txfee = Amount::zero();
+                TxValidationState tx_state;
+                if (!isCoinBase &&
+                    !Consensus::CheckTxInputs(tx, tx_state, view,
+                                              pindex->nHeight, txfee)) {
+                    // Any transaction validation failure in ConnectBlock is a
+                    // block consensus failure.
+                    state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                  tx_state.GetRejectReason(),
+                                  tx_state.GetDebugMessage());
+
+                    return error("%s: Consensus::CheckTxInputs: %s, %s",
+                                 __func__, tx.GetId().ToString(),
+                                 state.ToString());
+                }
+                nFees += txfee;
+            }
 
-        control.Add(vChecks);
+            if (!MoneyRange(nFees)) {
+                LogPrintf("ERROR: %s: accumulated fee in the block out of "
+                          "range.\n",
+                          __func__);
+                return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                     "bad-txns-accumulated-fee-outofrange");
+            }
+
+            // The following checks do not apply to the coinbase.
+            if (isCoinBase) {
+                continue;
+            }
+
+            // Check that transaction is BIP68 final BIP68 lock checks (as
+            // opposed to nLockTime checks) must be in ConnectBlock because they
+            // require the UTXO set.
+            prevheights.resize(tx.vin.size());
+            for (size_t j = 0; j < tx.vin.size(); j++) {
+                prevheights[j] = view.AccessCoin(tx.vin[j].prevout).GetHeight();
+            }
+
+            if (!SequenceLocks(tx, nLockTimeFlags, prevheights, *pindex)) {
+                LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n",
+                          __func__);
+                return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                     "bad-txns-nonfinal");
+            }
+
+            if (!fEnforceSigCheck) {
+                // Historically, there has been transactions with a very high
+                // sigcheck count, so we need to disable this check for such
+                // transactions.
+                nSigChecksTxLimiters[txIndex] =
+                    TxSigCheckLimiter::getDisabled();
+            }
+
+            std::vector<CScriptCheck> vChecks;
+            TxValidationState tx_state;
+            if (fScriptChecks &&
+                !CheckInputScripts(tx, tx_state, view, flags, fCacheResults,
+                                   fCacheResults,
+                                   PrecomputedTransactionData(tx),
+                                   nSigChecksRet, nSigChecksTxLimiters[txIndex],
+                                   &nSigChecksBlockLimiter, &vChecks)) {
+                // Any transaction validation failure in ConnectBlock is a block
+                // consensus failure
+                state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                              tx_state.GetRejectReason(),
+                              tx_state.GetDebugMessage());
+                return error(
+                    "ConnectBlock(): CheckInputScripts on %s failed with %s",
+                    tx.GetId().ToString(), state.ToString());
+            }
+
+            control.Add(vChecks);
 
-        // Note: this must execute in the same iteration as CheckTxInputs (not
-        // in a separate loop) in order to detect double spends. However,
-        // this does not prevent double-spending by duplicated transaction
-        // inputs in the same transaction (cf. CVE-2018-17144) -- that check is
-        // done in CheckBlock (CheckRegularTransaction).
-        SpendCoins(view, tx, blockundo.vtxundo.at(txIndex), pindex->nHeight);
-        txIndex++;
+            // Note: this must execute in the same iteration as CheckTxInputs
+            // (not in a separate loop) in order to detect double spends.
+            // However, this does not prevent double-spending by duplicated
+            // transaction inputs in the same transaction (cf. CVE-2018-17144)
+            // -- that check is done in CheckBlock (CheckRegularTransaction).
+            SpendCoins(view, tx, blockundo.vtxundo.at(txIndex),
+                       pindex->nHeight);
+            txIndex++;
+        }
     }
 
     int64_t nTime3 = GetTimeMicros();
@@ -2211,6 +2870,15 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
             bool fFlushForPrune = false;
             bool fDoFullFlush = false;
 
+            if (CoinsDB().FlushFailed()) {
+                return AbortNode(state, "Failed to write to coin database");
+            }
+            // Report the background flush that completed since the last call.
+            if (m_background_flush_locator && !CoinsDB().IsFlushing()) {
+                GetMainSignals().ChainStateFlushed(*m_background_flush_locator);
+                m_background_flush_locator.reset();
+            }
+
             CoinsCacheSizeState cache_state = GetCoinsCacheSizeState();
             LOCK(m_blockman.cs_LastBlockFile);
             if (m_blockman.IsPruneMode() &&
@@ -2309,6 +2977,13 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
                     LOG_TIME_MILLIS_WITH_CATEGORY("unlink pruned files",
                                                   BCLog::BENCH);
 
+                    // A background flush that is interrupted is replayed from
+                    // the blocks on the next start, so keep them until it
+                    // completes.
+                    if (!CoinsDB().WaitForFlush()) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
                     UnlinkPrunedFiles(setFilesToPrune);
                 }
                 m_last_write = nNow;
@@ -2333,13 +3008,58 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
                                      _("Disk space is too low!"));
                 }
 
+                // Coins prefetched from the database may be outdated once it
+                // has been written to.
+                if (m_coins_prefetcher) {
+                    m_coins_prefetcher->Clear();
+                }
+
                 // Flush the chainstate (which may refer to block index
                 // entries).
-                if (!CoinsTip().Flush()) {
-                    return AbortNode(state, "Failed to write to coin database");
+                if (g_background_flush && mode != FlushStateMode::ALWAYS &&
+                    !fFlushForPrune) {
+                    // Only one flush runs at a time, so that the cache doesn't
+                    // grow past twice its size.
+                    if (!CoinsDB().BatchWriteInBackground(
+                            CoinsTip().TakeCoins())) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
+                    // The previous background flush was written before this
+                    // one started, and this one is reported once written.
+                    if (m_background_flush_locator) {
+                        GetMainSignals().ChainStateFlushed(
+                            *m_background_flush_locator);
+                    }
+                    m_background_flush_locator = m_chain.GetLocator();
+                } else if (mode == FlushStateMode::ALWAYS) {
+                    // Callers flushing unconditionally, e.g. at shutdown or to
+                    // resize the cache, expect it to be empty afterwards.
+                    if (!CoinsTip().Flush()) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
+                } else {
+                    // Keep the coins cached so that the next blocks don't have
+                    // to read them back from the database, and only evict the
+                    // oldest ones when the cache is full.
+                    if (!CoinsTip().Sync()) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
+                    if (fCacheLarge || fCacheCritical) {
+                        CoinsTip().Trim(m_coinstip_cache_size_bytes *
+                                        COINS_CACHE_TRIM_PERCENT / 100);
+                    }
                 }
                 m_last_flush = nNow;
-                full_flush_completed = true;
+                // Unless a background flush is still writing them, the coins
+                // are written up to the tip. The synchronous flushes wait for
+                // the background one and supersede its report.
+                if (!m_background_flush_locator || !CoinsDB().IsFlushing()) {
+                    m_background_flush_locator.reset();
+                    full_flush_completed = true;
+                }
             }
 
             TRACE5(utxocache, flush,
@@ -2925,6 +3645,51 @@ void Chainstate::PruneBlockIndexCandidates() {
     assert(!setBlockIndexCandidates.empty());
 }
 
+std::shared_ptr<const CBlock> Chainstate::PrefetchBlocks(
+    const CBlockIndex *pindexNext,
+    const std::vector<CBlockIndex *> &vpindexToConnect) {
+    AssertLockHeld(cs_main);
+
+    if (g_prefetch_blocks <= 0 || !IsInitialBlockDownload()) {
+        // Stop the reader threads once they are no longer useful.
+        m_coins_prefetcher.reset();
+        return nullptr;
+    }
+
+    if (!m_coins_prefetcher) {
+        m_coins_prefetcher = std::make_unique<node::CoinsPrefetcher>(
+            CoinsDB(), m_chainman.GetConsensus(), g_prefetch_blocks);
+    }
+
+    std::shared_ptr<const CBlock> pblock;
+    if (auto prefetched =
+            m_coins_prefetcher->Take(pindexNext->GetBlockHash())) {
+        CCoinsViewCache &coins_cache = CoinsTip();
+        for (auto &[outpoint, coin] : prefetched->coins) {
+            coins_cache.EmplaceCoinFromBase(outpoint, std::move(coin));
+        }
+        pblock = std::move(prefetched->block);
+    }
+
+    // vpindexToConnect is ordered by decreasing height, down to the successor
+    // of the current tip.
+    const int max_height = std::min(vpindexToConnect.front()->nHeight,
+                                    pindexNext->nHeight + g_prefetch_blocks);
+    std::vector<std::pair<BlockHash, FlatFilePos>> blocks;
+    for (int height = pindexNext->nHeight + 1; height <= max_height;
+         height++) {
+        const CBlockIndex *pindex =
+            vpindexToConnect[vpindexToConnect.front()->nHeight - height];
+        if (!pindex->nStatus.hasData()) {
+            break;
+        }
+        blocks.emplace_back(pindex->GetBlockHash(), pindex->GetBlockPos());
+    }
+    m_coins_prefetcher->Prefetch(blocks);
+
+    return pblock;
+}
+
 /**
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to
@@ -2995,12 +3760,15 @@ bool Chainstate::ActivateBestChainStep(
 
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
+            std::shared_ptr<const CBlock> pblockConnect =
+                PrefetchBlocks(pindexConnect, vpindexToConnect);
+            if (pindexConnect == pindexMostWork && pblock) {
+                pblockConnect = pblock;
+            }
+
             BlockPolicyValidationState blockPolicyState;
             if (!ConnectTip(config, state, blockPolicyState, pindexConnect,
-                            pindexConnect == pindexMostWork
-                                ? pblock
-                                : std::shared_ptr<const CBlock>(),
-                            connectTrace, disconnectpool)) {
+                            pblockConnect, connectTrace, disconnectpool)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (state.GetResult() !=
@@ -3803,6 +4571,69 @@ static bool CheckBlockHeader(const CBlockHeader &block,
     return true;
 }
 
+/**
+ * Blocks with at least this many transactions get their merkle root and their
+ * transactions checked on the worker threads.
+ */
+static constexpr size_t PARALLEL_CHECK_BLOCK_MIN_TXS{
+    4 * CBlockCheck::MERKLE_SUBTREE_LEAVES};
+
+/**
+ * Same as BlockMerkleRoot, computing the subtrees on the worker threads.
+ */
+static uint256 ParallelBlockMerkleRoot(const CBlock &block, bool *mutated) {
+    // With a single subtree there would be no subtree of the full height.
+    static_assert(PARALLEL_CHECK_BLOCK_MIN_TXS >
+                  CBlockCheck::MERKLE_SUBTREE_LEAVES);
+
+    const size_t nSubtreeLeaves = CBlockCheck::MERKLE_SUBTREE_LEAVES;
+    std::vector<MerkleSubtree> subtrees(
+        (block.vtx.size() + nSubtreeLeaves - 1) / nSubtreeLeaves);
+    std::vector<CBlockCheck> vChecks;
+    vChecks.reserve(subtrees.size());
+    for (size_t i = 0; i < subtrees.size(); i++) {
+        vChecks.emplace_back(
+            block, i * nSubtreeLeaves,
+            std::min((i + 1) * nSubtreeLeaves, block.vtx.size()), &subtrees[i]);
+    }
+    {
+        CCheckQueueControl<CBlockCheck> control(&blockcheckqueue);
+        control.Add(vChecks);
+        control.Wait();
+    }
+
+    bool subtree_mutated = false;
+    std::vector<uint256> roots;
+    roots.reserve(subtrees.size());
+    for (const MerkleSubtree &subtree : subtrees) {
+        subtree_mutated |= subtree.mutated;
+        roots.push_back(subtree.root);
+    }
+    uint256 root = ComputeMerkleRoot(std::move(roots), mutated);
+    if (mutated) {
+        *mutated |= subtree_mutated;
+    }
+    return root;
+}
+
+/**
+ * Check the transactions of the block after the coinbase on the worker
+ * threads. Returns whether they are all valid, the caller is expected to find
+ * out which one failed and why otherwise.
+ */
+static bool ParallelCheckRegularTransactions(const CBlock &block) {
+    std::vector<CBlockCheck> vChecks;
+    vChecks.reserve(block.vtx.size() / CBlockCheck::TXS_PER_CHECK + 1);
+    for (size_t i = 1; i < block.vtx.size(); i += CBlockCheck::TXS_PER_CHECK) {
+        vChecks.emplace_back(
+            block, i,
+            std::min(i + CBlockCheck::TXS_PER_CHECK, block.vtx.size()));
+    }
+    CCheckQueueControl<CBlockCheck> control(&blockcheckqueue);
+    control.Add(vChecks);
+    return control.Wait();
+}
+
 bool CheckBlock(const CBlock &block, BlockValidationState &state,
                 const Consensus::Params &params,
                 BlockValidationOptions validationOptions) {
@@ -3817,10 +4648,16 @@ bool CheckBlock(const CBlock &block, BlockValidationState &state,
         return false;
     }
 
+    // Large blocks get the expensive checks below run on the worker threads.
+    // The outcome is the same as the serial checks.
+    const bool fParallel = block.vtx.size() >= PARALLEL_CHECK_BLOCK_MIN_TXS;
+
     // Check the merkle root.
     if (validationOptions.shouldValidateMerkleRoot()) {
         bool mutated;
-        uint256 hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
+        uint256 hashMerkleRoot2 = fParallel
+                                      ? ParallelBlockMerkleRoot(block, &mutated)
+                                      : BlockMerkleRoot(block, &mutated);
         if (block.hashMerkleRoot != hashMerkleRoot2) {
             return state.Invalid(BlockValidationResult::BLOCK_MUTATED,
                                  "bad-txnmrklroot", "hashMerkleRoot mismatch");
@@ -3872,14 +4709,19 @@ bool CheckBlock(const CBlock &block, BlockValidationState &state,
 
     // Check transactions for regularity, skipping the first. Note that this
     // is the first time we check that all after the first are !IsCoinBase.
-    for (size_t i = 1; i < block.vtx.size(); i++) {
-        auto *tx = block.vtx[i].get();
-        if (!CheckRegularTransaction(*tx, tx_state)) {
-            return state.Invalid(
-                BlockValidationResult::BLOCK_CONSENSUS,
-                tx_state.GetRejectReason(),
-                strprintf("Transaction check failed (txid %s) %s",
-                          tx->GetId().ToString(), tx_state.GetDebugMessage()));
+    // Large blocks only go through the serial loop to find out which
+    // transaction failed the parallel check.
+    if (!fParallel || !ParallelCheckRegularTransactions(block)) {
+        for (size_t i = 1; i < block.vtx.size(); i++) {
+            auto *tx = block.vtx[i].get();
+            if (!CheckRegularTransaction(*tx, tx_state)) {
+                return state.Invalid(
+                    BlockValidationResult::BLOCK_CONSENSUS,
+                    tx_state.GetRejectReason(),
+                    strprintf("Transaction check failed (txid %s) %s",
+                              tx->GetId().ToString(),
+                              tx_state.GetDebugMessage()));
+            }
         }
     }
 
@@ -4572,6 +5414,27 @@ ChainstateManager::ProcessTransaction(const CTransactionRef &tx,
     return result;
 }
 
+std::vector<MempoolAcceptResult>
+ChainstateManager::ProcessTransactions(const std::vector<CTransactionRef> &txns,
+                                       bool test_accept,
+                                       const CFeeRate &max_fee_rate) {
+    AssertLockHeld(cs_main);
+    Chainstate &active_chainstate = ActiveChainstate();
+    if (!active_chainstate.GetMempool()) {
+        TxValidationState state;
+        state.Invalid(TxValidationResult::TX_NO_MEMPOOL, "no-mempool");
+        return std::vector<MempoolAcceptResult>(
+            txns.size(), MempoolAcceptResult::Failure(state));
+    }
+    // See ProcessTransaction() for the use of GetConfig().
+    auto results = ProcessNewTransactions(
+        ::GetConfig(), active_chainstate, *active_chainstate.GetMempool(), txns,
+        test_accept, max_fee_rate);
+    active_chainstate.GetMempool()->check(
+        active_chainstate.CoinsTip(), active_chainstate.m_chain.Height() + 1);
+    return results;
+}
+
 bool TestBlockValidity(
     BlockValidationState &state, const CChainParams &params,
     Chainstate &chainstate, const CBlock &block, CBlockIndex *pindexPrev,
@@ -4671,9 +5534,143 @@ CVerifyDB::~CVerifyDB() {
     uiInterface.ShowProgress("", 100, false);
 }
 
+namespace {
+/** The outcome of the checks of VerifyDB that don't need the UTXO set */
+struct VerifyDBBlock {
+    std::shared_ptr<const CBlock> block;
+    //! Why the checks failed, empty if they passed
+    std::string error;
+};
+
+/**
+ * Threads running the reads and checks of VerifyDB ahead of time. They are
+ * started once for the whole verification and run the jobs in the order they
+ * are submitted.
+ */
+class VerifyDBWorkers {
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::packaged_task<void()>> m_jobs GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void ThreadWork() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
+        while (true) {
+            std::packaged_task<void()> job;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                    return m_request_stop || !m_jobs.empty();
+                });
+                // The jobs left when stopping are abandoned, as the
+                // verification stopped early.
+                if (m_request_stop) {
+                    return;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    explicit VerifyDBWorkers(int threads_num) {
+        for (int n = 0; n < threads_num; ++n) {
+            m_threads.emplace_back([this, n]() {
+                util::ThreadRename(strprintf("verifydb.%i", n));
+                ThreadWork();
+            });
+        }
+    }
+
+    ~VerifyDBWorkers() {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_cv.notify_all();
+        for (std::thread &t : m_threads) {
+            t.join();
+        }
+    }
+
+    /** Queue f to run on a worker thread, and return its future result. */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F &&f)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+        auto result = task.get_future();
+        WITH_LOCK(m_mutex, m_jobs.emplace_back(std::move(task)));
+        m_cv.notify_one();
+        return result;
+    }
+};
+} // namespace
+
+/**
+ * Read the block at block_pos and check that it is the block of pindex. This
+ * doesn't lock cs_main, so it can run on any thread while the caller holds it.
+ */
+static std::shared_ptr<const CBlock>
+ReadVerifyDBBlock(const CBlockIndex *pindex, const FlatFilePos &block_pos,
+                  const Consensus::Params &params) {
+    auto pblock = std::make_shared<CBlock>();
+    if (!ReadBlockFromDisk(*pblock, block_pos, params) ||
+        pblock->GetHash() != pindex->GetBlockHash()) {
+        return nullptr;
+    }
+    return pblock;
+}
+
+/**
+ * Run the check levels 0 to 2 of VerifyDB on the block of pindex: read it from
+ * disk, check its validity and read its undo data. The positions are read from
+ * the block index by the caller, so this can run on any thread.
+ */
+static VerifyDBBlock CheckVerifyDBBlock(const Config &config, int nCheckLevel,
+                                        const CBlockIndex *pindex,
+                                        const FlatFilePos &block_pos,
+                                        const FlatFilePos &undo_pos) {
+    VerifyDBBlock result;
+
+    // check level 0: read from disk
+    result.block = ReadVerifyDBBlock(
+        pindex, block_pos, config.GetChainParams().GetConsensus());
+    if (!result.block) {
+        result.error = strprintf("ReadBlockFromDisk failed at %d, hash=%s",
+                                 pindex->nHeight,
+                                 pindex->GetBlockHash().ToString());
+        return result;
+    }
+
+    // check level 1: verify block validity
+    BlockValidationState state;
+    if (nCheckLevel >= 1 &&
+        !CheckBlock(*result.block, state,
+                    config.GetChainParams().GetConsensus(),
+                    BlockValidationOptions(config))) {
+        result.error = strprintf("found bad block at %d, hash=%s (%s)",
+                                 pindex->nHeight,
+                                 pindex->GetBlockHash().ToString(),
+                                 state.ToString());
+        return result;
+    }
+
+    // check level 2: verify undo validity
+    if (nCheckLevel >= 2 && !undo_pos.IsNull()) {
+        CBlockUndo undo;
+        if (!UndoReadFromDisk(undo, undo_pos, pindex->pprev->GetBlockHash())) {
+            result.error = strprintf("found bad undo data at %d, hash=%s",
+                                     pindex->nHeight,
+                                     pindex->GetBlockHash().ToString());
+            return result;
+        }
+    }
+
+    return result;
+}
+
 VerifyDBResult CVerifyDB::VerifyDB(Chainstate &chainstate, const Config &config,
                                    CCoinsView &coinsview, int nCheckLevel,
-                                   int nCheckDepth) {
+                                   int nCheckDepth, int threads_num) {
     AssertLockHeld(cs_main);
 
     const CChainParams &params = config.GetChainParams();
@@ -4705,6 +5702,45 @@ VerifyDBResult CVerifyDB::VerifyDB(Chainstate &chainstate, const Config &config,
 
     const bool is_snapshot_cs{!chainstate.m_from_snapshot_blockhash};
 
+    // Whether the block of pindex_check is within the blocks to verify.
+    auto should_check = [&](const CBlockIndex *pindex_check)
+                            EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        return pindex_check && pindex_check->pprev &&
+               pindex_check->nHeight >
+                   chainstate.m_chain.Height() - nCheckDepth &&
+               !((chainstate.m_blockman.IsPruneMode() || is_snapshot_cs) &&
+                 !pindex_check->nStatus.hasData());
+    };
+
+    // With threads_num > 0, the checks of levels 0 to 2 run ahead of time on
+    // up to threads_num blocks in parallel, while the blocks before them are
+    // disconnected. The futures are queued in the order the blocks are
+    // visited. The workers are declared last so that they are stopped before
+    // the state their jobs refer to is destroyed.
+    std::deque<std::pair<const CBlockIndex *, std::future<VerifyDBBlock>>>
+        pending_checks;
+    std::deque<std::future<std::shared_ptr<const CBlock>>> pending_reads;
+    std::optional<VerifyDBWorkers> workers;
+    if (threads_num > 0) {
+        workers.emplace(threads_num);
+    }
+    const CBlockIndex *pindex_ahead = chainstate.m_chain.Tip();
+    auto schedule_checks = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        while (pending_checks.size() < size_t(threads_num) &&
+               should_check(pindex_ahead)) {
+            pending_checks.emplace_back(
+                pindex_ahead,
+                workers->Submit([&config, nCheckLevel, pindex_ahead,
+                                 block_pos = pindex_ahead->GetBlockPos(),
+                                 undo_pos = pindex_ahead->GetUndoPos()]() {
+                    return CheckVerifyDBBlock(config, nCheckLevel,
+                                              pindex_ahead, block_pos,
+                                              undo_pos);
+                }));
+            pindex_ahead = pindex_ahead->pprev;
+        }
+    };
+
     for (pindex = chainstate.m_chain.Tip(); pindex && pindex->pprev;
          pindex = pindex->pprev) {
         const int percentageDone = std::max(
@@ -4736,39 +5772,25 @@ VerifyDBResult CVerifyDB::VerifyDB(Chainstate &chainstate, const Config &config,
             break;
         }
 
-        CBlock block;
-
-        // check level 0: read from disk
-        if (!ReadBlockFromDisk(block, pindex, consensusParams)) {
-            LogPrintf(
-                "Verification error: ReadBlockFromDisk failed at %d, hash=%s\n",
-                pindex->nHeight, pindex->GetBlockHash().ToString());
-            return VerifyDBResult::CORRUPTED_BLOCK_DB;
+        // check levels 0 to 2: read from disk, verify block validity and
+        // verify undo validity
+        VerifyDBBlock checked;
+        if (threads_num > 0) {
+            schedule_checks();
+            assert(!pending_checks.empty() &&
+                   pending_checks.front().first == pindex);
+            checked = pending_checks.front().second.get();
+            pending_checks.pop_front();
+        } else {
+            checked = CheckVerifyDBBlock(config, nCheckLevel, pindex,
+                                         pindex->GetBlockPos(),
+                                         pindex->GetUndoPos());
         }
-
-        // check level 1: verify block validity
-        if (nCheckLevel >= 1 && !CheckBlock(block, state, consensusParams,
-                                            BlockValidationOptions(config))) {
-            LogPrintf(
-                "Verification error: found bad block at %d, hash=%s (%s)\n",
-                pindex->nHeight, pindex->GetBlockHash().ToString(),
-                state.ToString());
+        if (!checked.error.empty()) {
+            LogPrintf("Verification error: %s\n", checked.error);
             return VerifyDBResult::CORRUPTED_BLOCK_DB;
         }
-
-        // check level 2: verify undo validity
-        if (nCheckLevel >= 2 && pindex) {
-            CBlockUndo undo;
-            if (!pindex->GetUndoPos().IsNull()) {
-                if (!UndoReadFromDisk(undo, pindex)) {
-                    LogPrintf("Verification error: found bad undo data at %d, "
-                              "hash=%s\n",
-                              pindex->nHeight,
-                              pindex->GetBlockHash().ToString());
-                    return VerifyDBResult::CORRUPTED_BLOCK_DB;
-                }
-            }
-        }
+        const CBlock &block = *checked.block;
         // check level 3: check for inconsistencies during memory-only
         // disconnect of tip blocks
         size_t curr_coins_usage = coins.DynamicMemoryUsage() +
@@ -4819,6 +5841,9 @@ VerifyDBResult CVerifyDB::VerifyDB(Chainstate &chainstate, const Config &config,
 
     // check level 4: try reconnecting blocks
     if (nCheckLevel >= 4 && !skipped_l3_checks) {
+        // With threads_num > 0, read up to threads_num blocks ahead of the one
+        // being connected.
+        pindex_ahead = pindex;
         while (pindex != chainstate.m_chain.Tip()) {
             const int percentageDone = std::max(
                 1, std::min(99, 100 - int(double(chainstate.m_chain.Height() -
@@ -4832,13 +5857,31 @@ VerifyDBResult CVerifyDB::VerifyDB(Chainstate &chainstate, const Config &config,
             uiInterface.ShowProgress(_("Verifying blocks...").translated,
                                      percentageDone, false);
             pindex = chainstate.m_chain.Next(pindex);
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensusParams)) {
+            std::shared_ptr<const CBlock> pblock;
+            if (threads_num > 0) {
+                while (pending_reads.size() < size_t(threads_num) &&
+                       pindex_ahead != chainstate.m_chain.Tip()) {
+                    pindex_ahead = chainstate.m_chain.Next(pindex_ahead);
+                    pending_reads.push_back(workers->Submit(
+                        [&consensusParams, pindex_ahead,
+                         block_pos = pindex_ahead->GetBlockPos()]() {
+                            return ReadVerifyDBBlock(pindex_ahead, block_pos,
+                                                     consensusParams);
+                        }));
+                }
+                pblock = pending_reads.front().get();
+                pending_reads.pop_front();
+            } else {
+                pblock = ReadVerifyDBBlock(pindex, pindex->GetBlockPos(),
+                                           consensusParams);
+            }
+            if (!pblock) {
                 LogPrintf("Verification error: ReadBlockFromDisk failed at %d, "
                           "hash=%s\n",
                           pindex->nHeight, pindex->GetBlockHash().ToString());
                 return VerifyDBResult::CORRUPTED_BLOCK_DB;
             }
+            const CBlock &block = *pblock;
             if (!chainstate.ConnectBlock(block, state, pindex, coins,
                                          BlockValidationOptions(config))) {
                 LogPrintf("Verification error: found unconnectable block at "
@@ -5157,6 +6200,196 @@ bool Chainstate::LoadGenesisBlock() {
     return true;
 }
 
+/**
+ * Deserialize the blocks found in a block file, in file order, and call
+ * fn(pblock, nBlockPos) on each of them until it returns false. Data that
+ * doesn't deserialize to a block is skipped, as are the exceptions thrown by
+ * fn.
+ */
+template <typename Fn>
+static void ScanBlockFile(FILE *fileIn, const CChainParams &params, Fn &&fn) {
+    // This takes over fileIn and calls fclose() on it in the CBufferedFile
+    // destructor. Make sure we have at least 2*MAX_TX_SIZE space in there
+    // so any transaction can fit in the buffer.
+    CBufferedFile blkdat(fileIn, 2 * MAX_TX_SIZE, MAX_TX_SIZE + 8, SER_DISK,
+                         CLIENT_VERSION);
+    uint64_t nRewind = blkdat.GetPos();
+    while (!blkdat.eof()) {
+        if (ShutdownRequested()) {
+            return;
+        }
+
+        blkdat.SetPos(nRewind);
+        // Start one byte further next time, in case of failure.
+        nRewind++;
+        // Remove former limit.
+        blkdat.SetLimit();
+        unsigned int nSize = 0;
+        try {
+            // Locate a header.
+            uint8_t buf[CMessageHeader::MESSAGE_START_SIZE];
+            blkdat.FindByte(char(params.DiskMagic()[0]));
+            nRewind = blkdat.GetPos() + 1;
+            blkdat >> buf;
+            if (memcmp(buf, params.DiskMagic().data(),
+                       CMessageHeader::MESSAGE_START_SIZE)) {
+                continue;
+            }
+
+            // Read size.
+            blkdat >> nSize;
+            if (nSize < 80) {
+                continue;
+            }
+        } catch (const std::exception &) {
+            // No valid block header found; don't complain.
+            break;
+        }
+
+        try {
+            // read block
+            uint64_t nBlockPos = blkdat.GetPos();
+            blkdat.SetLimit(nBlockPos + nSize);
+            std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+            blkdat >> *pblock;
+            nRewind = blkdat.GetPos();
+
+            if (!fn(pblock, nBlockPos)) {
+                return;
+            }
+        } catch (const std::exception &e) {
+            // Historical bugs added extra data to the block files that does
+            // not deserialize cleanly. Commonly this data is between readable
+            // blocks, but it does not really matter. Such data is not fatal to
+            // the import process. The code that reads the block files deals
+            // with invalid data by simply ignoring it. It continues to search
+            // for the next {4 byte magic message start bytes + 4 byte length +
+            // block} that does deserialize cleanly and passes all of the other
+            // block validation checks dealing with POW and the merkle root,
+            // etc... We merely note with this informational log message when
+            // unexpected data is encountered. We could also be experiencing a
+            // storage system read error, or a read of a previous bad write.
+            // These are possible, but less likely scenarios. We don't have
+            // enough information to tell a difference here. The reindex
+            // process is not the place to attempt to clean and/or compact the
+            // block files. If so desired, a studious node operator may use
+            // knowledge of the fact that the block files are not entirely
+            // pristine in order to prepare a set of pristine, and perhaps
+            // ordered, block files for later reindexing.
+            LogPrint(BCLog::REINDEX,
+                     "%s: unexpected data at file offset 0x%x - %s. "
+                     "continuing\n",
+                     __func__, (nRewind - 1), e.what());
+        }
+    }
+}
+
+bool Chainstate::ImportExternalBlock(
+    const Config &config, const std::shared_ptr<CBlock> &pblock,
+    FlatFilePos *dbp,
+    std::multimap<BlockHash, FlatFilePos> *blocks_with_unknown_parent,
+    int &nLoaded) {
+    AssertLockNotHeld(m_chainstate_mutex);
+
+    const CChainParams &params{m_chainman.GetParams()};
+    const CBlock &block = *pblock;
+    const BlockHash hash = block.GetHash();
+    {
+        LOCK(cs_main);
+        // detect out of order blocks, and store them for later
+        if (hash != params.GetConsensus().hashGenesisBlock &&
+            !m_blockman.LookupBlockIndex(block.hashPrevBlock)) {
+            LogPrint(BCLog::REINDEX,
+                     "%s: Out of order block %s, parent %s not known\n",
+                     __func__, hash.ToString(),
+                     block.hashPrevBlock.ToString());
+            if (dbp && blocks_with_unknown_parent) {
+                blocks_with_unknown_parent->emplace(block.hashPrevBlock, *dbp);
+            }
+            return true;
+        }
+
+        // process in case the block isn't known yet
+        const CBlockIndex *pindex = m_blockman.LookupBlockIndex(hash);
+        if (!pindex || !pindex->nStatus.hasData()) {
+            BlockValidationState state;
+            if (AcceptBlock(config, pblock, state, true, dbp, nullptr, true)) {
+                nLoaded++;
+            }
+            if (state.IsError()) {
+                return false;
+            }
+        } else if (hash != params.GetConsensus().hashGenesisBlock &&
+                   pindex->nHeight % 1000 == 0) {
+            LogPrint(BCLog::REINDEX,
+                     "Block Import: already had block %s at height %d\n",
+                     hash.ToString(), pindex->nHeight);
+        }
+    }
+
+    // Activate the genesis block so normal node progress can continue
+    if (hash == params.GetConsensus().hashGenesisBlock) {
+        BlockValidationState state;
+        if (!ActivateBestChain(config, state, nullptr)) {
+            return false;
+        }
+    }
+
+    if (m_blockman.IsPruneMode() && !fReindex && pblock) {
+        // Must update the tip for pruning to work while importing with
+        // -loadblock. This is a tradeoff to conserve disk space at the expense
+        // of time spent updating the tip to be able to prune. Otherwise,
+        // ActivateBestChain won't be called by the import process until after
+        // all of the block files are loaded. ActivateBestChain can be called
+        // by concurrent network message processing, but that is not reliable
+        // for the purpose of pruning while importing.
+        BlockValidationState state;
+        if (!ActivateBestChain(config, state, pblock)) {
+            LogPrint(BCLog::REINDEX, "failed to activate chain (%s)\n",
+                     state.ToString());
+            return false;
+        }
+    }
+
+    NotifyHeaderTip(*this);
+
+    if (!blocks_with_unknown_parent) {
+        return true;
+    }
+
+    // Recursively process earlier encountered successors of this block
+    std::deque<BlockHash> queue;
+    queue.push_back(hash);
+    while (!queue.empty()) {
+        BlockHash head = queue.front();
+        queue.pop_front();
+        auto range = blocks_with_unknown_parent->equal_range(head);
+        while (range.first != range.second) {
+            std::multimap<BlockHash, FlatFilePos>::iterator it = range.first;
+            std::shared_ptr<CBlock> pblockrecursive =
+                std::make_shared<CBlock>();
+            if (ReadBlockFromDisk(*pblockrecursive, it->second,
+                                  params.GetConsensus())) {
+                LogPrint(BCLog::REINDEX,
+                         "%s: Processing out of order child %s of %s\n",
+                         __func__, pblockrecursive->GetHash().ToString(),
+                         head.ToString());
+                LOCK(cs_main);
+                BlockValidationState dummy;
+                if (AcceptBlock(config, pblockrecursive, dummy, true,
+                                &it->second, nullptr, true)) {
+                    nLoaded++;
+                    queue.push_back(pblockrecursive->GetHash());
+                }
+            }
+            range.first++;
+            blocks_with_unknown_parent->erase(it);
+            NotifyHeaderTip(*this);
+        }
+    }
+    return true;
+}
+
 void Chainstate::LoadExternalBlockFile(
     const Config &config, FILE *fileIn, FlatFilePos *dbp,
     std::multimap<BlockHash, FlatFilePos> *blocks_with_unknown_parent) {
@@ -5170,189 +6403,68 @@ void Chainstate::LoadExternalBlockFile(
 
     int nLoaded = 0;
     try {
-        // This takes over fileIn and calls fclose() on it in the CBufferedFile
-        // destructor. Make sure we have at least 2*MAX_TX_SIZE space in there
-        // so any transaction can fit in the buffer.
-        CBufferedFile blkdat(fileIn, 2 * MAX_TX_SIZE, MAX_TX_SIZE + 8, SER_DISK,
-                             CLIENT_VERSION);
-        uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
-            if (ShutdownRequested()) {
-                return;
-            }
-
-            blkdat.SetPos(nRewind);
-            // Start one byte further next time, in case of failure.
-            nRewind++;
-            // Remove former limit.
-            blkdat.SetLimit();
-            unsigned int nSize = 0;
-            try {
-                // Locate a header.
-                uint8_t buf[CMessageHeader::MESSAGE_START_SIZE];
-                blkdat.FindByte(char(params.DiskMagic()[0]));
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> buf;
-                if (memcmp(buf, params.DiskMagic().data(),
-                           CMessageHeader::MESSAGE_START_SIZE)) {
-                    continue;
-                }
-
-                // Read size.
-                blkdat >> nSize;
-                if (nSize < 80) {
-                    continue;
-                }
-            } catch (const std::exception &) {
-                // No valid block header found; don't complain.
-                break;
-            }
-
-            try {
-                // read block
-                uint64_t nBlockPos = blkdat.GetPos();
+        ScanBlockFile(
+            fileIn, params,
+            [&](const std::shared_ptr<CBlock> &pblock, uint64_t nBlockPos) {
                 if (dbp) {
                     dbp->nPos = nBlockPos;
                 }
-                blkdat.SetLimit(nBlockPos + nSize);
-                std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-                CBlock &block = *pblock;
-                blkdat >> block;
-                nRewind = blkdat.GetPos();
-
-                const BlockHash hash = block.GetHash();
-                {
-                    LOCK(cs_main);
-                    // detect out of order blocks, and store them for later
-                    if (hash != params.GetConsensus().hashGenesisBlock &&
-                        !m_blockman.LookupBlockIndex(block.hashPrevBlock)) {
-                        LogPrint(
-                            BCLog::REINDEX,
-                            "%s: Out of order block %s, parent %s not known\n",
-                            __func__, hash.ToString(),
-                            block.hashPrevBlock.ToString());
-                        if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(
-                                block.hashPrevBlock, *dbp);
-                        }
-                        continue;
-                    }
-
-                    // process in case the block isn't known yet
-                    const CBlockIndex *pindex =
-                        m_blockman.LookupBlockIndex(hash);
-                    if (!pindex || !pindex->nStatus.hasData()) {
-                        BlockValidationState state;
-                        if (AcceptBlock(config, pblock, state, true, dbp,
-                                        nullptr, true)) {
-                            nLoaded++;
-                        }
-                        if (state.IsError()) {
-                            break;
-                        }
-                    } else if (hash != params.GetConsensus().hashGenesisBlock &&
-                               pindex->nHeight % 1000 == 0) {
-                        LogPrint(
-                            BCLog::REINDEX,
-                            "Block Import: already had block %s at height %d\n",
-                            hash.ToString(), pindex->nHeight);
-                    }
-                }
-
-                // Activate the genesis block so normal node progress can
-                // continue
-                if (hash == params.GetConsensus().hashGenesisBlock) {
-                    BlockValidationState state;
-                    if (!ActivateBestChain(config, state, nullptr)) {
-                        break;
-                    }
-                }
+                return ImportExternalBlock(config, pblock, dbp,
+                                           blocks_with_unknown_parent, nLoaded);
+            });
+    } catch (const std::runtime_error &e) {
+        AbortNode(std::string("System error: ") + e.what());
+    }
 
-                if (m_blockman.IsPruneMode() && !fReindex && pblock) {
-                    // Must update the tip for pruning to work while importing
-                    // with -loadblock. This is a tradeoff to conserve disk
-                    // space at the expense of time spent updating the tip to be
-                    // able to prune. Otherwise, ActivateBestChain won't be
-                    // called by the import process until after all of the block
-                    // files are loaded. ActivateBestChain can be called by
-                    // concurrent network message processing, but that is not
-                    // reliable for the purpose of pruning while importing.
-                    BlockValidationState state;
-                    if (!ActivateBestChain(config, state, pblock)) {
-                        LogPrint(BCLog::REINDEX,
-                                 "failed to activate chain (%s)\n",
-                                 state.ToString());
-                        break;
-                    }
-                }
+    LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded,
+              GetTimeMillis() - nStart);
+}
 
-                NotifyHeaderTip(*this);
+std::vector<ExternalBlock> ReadBlockFile(const Config &config, FILE *fileIn,
+                                         int nFile) {
+    const CChainParams &params = config.GetChainParams();
+    std::vector<ExternalBlock> blocks;
+    try {
+        ScanBlockFile(
+            fileIn, params,
+            [&](const std::shared_ptr<CBlock> &pblock, uint64_t nBlockPos) {
+                // This lets AcceptBlock skip the context-free checks. If they
+                // fail, AcceptBlock runs them again and reports the failure.
+                BlockValidationState state;
+                CheckBlock(*pblock, state, params.GetConsensus(),
+                           BlockValidationOptions(config));
+                blocks.emplace_back(pblock, FlatFilePos(nFile, nBlockPos));
+                return true;
+            });
+    } catch (const std::runtime_error &e) {
+        AbortNode(std::string("System error: ") + e.what());
+    }
+    return blocks;
+}
 
-                if (!blocks_with_unknown_parent) {
-                    continue;
-                }
+void Chainstate::LoadExternalBlocks(
+    const Config &config, std::vector<ExternalBlock> blocks,
+    std::multimap<BlockHash, FlatFilePos> &blocks_with_unknown_parent) {
+    AssertLockNotHeld(m_chainstate_mutex);
 
-                // Recursively process earlier encountered successors of this
-                // block
-                std::deque<BlockHash> queue;
-                queue.push_back(hash);
-                while (!queue.empty()) {
-                    BlockHash head = queue.front();
-                    queue.pop_front();
-                    auto range = blocks_with_unknown_parent->equal_range(head);
-                    while (range.first != range.second) {
-                        std::multimap<BlockHash, FlatFilePos>::iterator it =
-                            range.first;
-                        std::shared_ptr<CBlock> pblockrecursive =
-                            std::make_shared<CBlock>();
-                        if (ReadBlockFromDisk(*pblockrecursive, it->second,
-                                              params.GetConsensus())) {
-                            LogPrint(
-                                BCLog::REINDEX,
-                                "%s: Processing out of order child %s of %s\n",
-                                __func__, pblockrecursive->GetHash().ToString(),
-                                head.ToString());
-                            LOCK(cs_main);
-                            BlockValidationState dummy;
-                            if (AcceptBlock(config, pblockrecursive, dummy,
-                                            true, &it->second, nullptr, true)) {
-                                nLoaded++;
-                                queue.push_back(pblockrecursive->GetHash());
-                            }
-                        }
-                        range.first++;
-                        blocks_with_unknown_parent->erase(it);
-                        NotifyHeaderTip(*this);
-                    }
-                }
-            } catch (const std::exception &e) {
-                // Historical bugs added extra data to the block files that does
-                // not deserialize cleanly. Commonly this data is between
-                // readable blocks, but it does not really matter. Such data is
-                // not fatal to the import process. The code that reads the
-                // block files deals with invalid data by simply ignoring it. It
-                // continues to search for the next {4 byte magic message start
-                // bytes + 4 byte length + block} that does deserialize cleanly
-                // and passes all of the other block validation checks dealing
-                // with POW and the merkle root, etc... We merely note with this
-                // informational log message when unexpected data is
-                // encountered. We could also be experiencing a storage system
-                // read error, or a read of a previous bad write. These are
-                // possible, but less likely scenarios. We don't have enough
-                // information to tell a difference here. The reindex process is
-                // not the place to attempt to clean and/or compact the block
-                // files. If so desired, a studious node operator may use
-                // knowledge of the fact that the block files are not entirely
-                // pristine in order to prepare a set of pristine, and perhaps
-                // ordered, block files for later reindexing.
-                LogPrint(BCLog::REINDEX,
-                         "%s: unexpected data at file offset 0x%x - %s. "
-                         "continuing\n",
-                         __func__, (nRewind - 1), e.what());
+    int64_t nStart = GetTimeMillis();
+    int nLoaded = 0;
+    for (auto &[pblock, pos] : blocks) {
+        if (ShutdownRequested()) {
+            return;
+        }
+        try {
+            if (!ImportExternalBlock(config, pblock, &pos,
+                                     &blocks_with_unknown_parent, nLoaded)) {
+                break;
             }
+        } catch (const std::exception &e) {
+            // Same as LoadExternalBlockFile, errors are not fatal.
+            LogPrint(BCLog::REINDEX,
+                     "%s: unexpected data at file offset 0x%x - %s. "
+                     "continuing\n",
+                     __func__, pos.nPos, e.what());
         }
-    } catch (const std::runtime_error &e) {
-        AbortNode(std::string("System error: ") + e.what());
     }
 
     LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded,
@@ -5743,6 +6855,57 @@ bool Chainstate::ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size) {
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
+//! Number of transactions from mempool.dat whose scripts are checked together
+//! before they are added to the mempool
+static constexpr size_t MEMPOOL_LOAD_BATCH_SIZE{1000};
+
+/**
+ * Check the scripts of transactions read from mempool.dat on the script check
+ * threads, storing the valid signatures in the signature cache. The
+ * transactions are then added to the mempool one by one, which mostly hits
+ * the cache instead of verifying their signatures again.
+ *
+ * This is only a warm up: the transactions whose inputs are not available
+ * are skipped, and failures are ignored since the transactions are fully
+ * validated when they are added to the mempool.
+ */
+static void PrecheckMempoolScripts(const Config &config, CTxMemPool &pool,
+                                   Chainstate &active_chainstate,
+                                   const std::vector<CTransactionRef> &txs) {
+    // The checks keep pointers to the limiters, so they must not move.
+    std::vector<TxSigCheckLimiter> limiters(txs.size(),
+                                            TxSigCheckLimiter::getDisabled());
+    std::vector<CScriptCheck> checks;
+    {
+        LOCK2(cs_main, pool.cs);
+        const uint32_t flags =
+            GetNextBlockScriptFlags(config.GetChainParams().GetConsensus(),
+                                    active_chainstate.m_chain.Tip()) |
+            STANDARD_SCRIPT_VERIFY_FLAGS;
+        CCoinsViewMemPool mempool_view(&active_chainstate.CoinsTip(), pool);
+        CCoinsViewCache view(&mempool_view);
+        for (size_t i = 0; i < txs.size(); i++) {
+            const CTransaction &tx = *txs[i];
+            if (tx.IsCoinBase() || !view.HaveInputs(tx)) {
+                continue;
+            }
+            TxValidationState state;
+            int nSigChecks;
+            CheckInputScripts(tx, state, view, flags, /*sigCacheStore=*/true,
+                              /*scriptCacheStore=*/false,
+                              PrecomputedTransactionData(tx), nSigChecks,
+                              limiters[i], nullptr, &checks);
+            // The transactions are in dependency order, so the outputs are
+            // made available to their children in the same batch.
+            AddCoins(view, tx, MEMPOOL_HEIGHT, /*check_for_overwrite=*/true);
+        }
+    }
+
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    control.Add(checks);
+    control.Wait();
+}
+
 bool LoadMempool(const Config &config, CTxMemPool &pool,
                  Chainstate &active_chainstate,
                  FopenFn mockable_fopen_function) {
@@ -5772,45 +6935,62 @@ bool LoadMempool(const Config &config, CTxMemPool &pool,
 
         uint64_t num;
         file >> num;
+        std::vector<CTransactionRef> txs;
+        std::vector<int64_t> times;
         while (num) {
-            --num;
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
-
-            Amount amountdelta = nFeeDelta * SATOSHI;
-            if (amountdelta != Amount::zero()) {
-                pool.PrioritiseTransaction(tx->GetId(), amountdelta);
-            }
-            if (nTime > nNow - nExpiryTimeout) {
-                LOCK(cs_main);
-                const auto &accepted =
-                    AcceptToMemoryPool(config, active_chainstate, tx, nTime,
-                                       /*bypass_limits=*/false,
-                                       /*test_accept=*/false);
-                if (accepted.m_result_type ==
-                    MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
+            txs.clear();
+            times.clear();
+            while (num && txs.size() < MEMPOOL_LOAD_BATCH_SIZE) {
+                --num;
+                CTransactionRef tx;
+                int64_t nTime;
+                int64_t nFeeDelta;
+                file >> tx;
+                file >> nTime;
+                file >> nFeeDelta;
+
+                Amount amountdelta = nFeeDelta * SATOSHI;
+                if (amountdelta != Amount::zero()) {
+                    pool.PrioritiseTransaction(tx->GetId(), amountdelta);
+                }
+                if (nTime > nNow - nExpiryTimeout) {
+                    txs.push_back(std::move(tx));
+                    times.push_back(nTime);
                 } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetId())) {
-                        ++already_there;
+                    ++expired;
+                }
+            }
+
+            PrecheckMempoolScripts(config, pool, active_chainstate, txs);
+
+            for (size_t i = 0; i < txs.size(); i++) {
+                const CTransactionRef &tx = txs[i];
+                {
+                    LOCK(cs_main);
+                    const auto &accepted = AcceptToMemoryPool(
+                        config, active_chainstate, tx, times[i],
+                        /*bypass_limits=*/false,
+                        /*test_accept=*/false);
+                    if (accepted.m_result_type ==
+                        MempoolAcceptResult::ResultType::VALID) {
+                        ++count;
                     } else {
-                        ++failed;
+                        // mempool may contain the transaction already, e.g.
+                        // from wallet(s) having loaded it while we were
+                        // processing mempool transactions; consider these as
+                        // valid, instead of failed, but mark them as 'already
+                        // there'
+                        if (pool.exists(tx->GetId())) {
+                            ++already_there;
+                        } else {
+                            ++failed;
+                        }
                     }
                 }
-            } else {
-                ++expired;
-            }
 
-            if (ShutdownRequested()) {
-                return false;
+                if (ShutdownRequested()) {
+                    return false;
+                }
             }
         }
         std::map<TxId, Amount> mapDeltas;
@@ -6155,6 +7335,12 @@ struct StopHashingException : public std::exception {
     }
 };
 
+//! Number of coins decoded from a snapshot before handing them over to be
+//! hashed and inserted into the coins cache.
+static constexpr size_t SNAPSHOT_LOAD_BATCH_SIZE{10000};
+//! Size of the reads of the chunks of a chunked snapshot.
+static constexpr size_t SNAPSHOT_READ_SIZE{1 << 20};
+
 static void SnapshotUTXOHashBreakpoint() {
     if (ShutdownRequested()) {
         throw StopHashingException();
@@ -6204,61 +7390,191 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
               base_blockhash.ToString());
     int64_t coins_processed{0};
 
-    while (coins_left > 0) {
+    // Snapshots are written in database order, so the content hash can be
+    // computed while the coins are loaded rather than by reading the whole
+    // coins database back once they are flushed. The coins are decoded in
+    // batches: while a worker thread hashes a batch, this thread inserts the
+    // previous one into the cache and decodes the next one.
+    SerializedCoinsHasher hasher{base_height, base_blockhash};
+    bool hashed_in_order{true};
+    std::vector<std::pair<COutPoint, Coin>> hashing_batch;
+    std::future<bool> hashing;
+
+    const auto is_valid_coin = [base_height](const COutPoint &coin_outpoint,
+                                             const Coin &coin_data) {
+        return coin_data.GetHeight() <= uint32_t(base_height) &&
+               // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+               coin_outpoint.GetN() <
+                   std::numeric_limits<decltype(coin_outpoint.GetN())>::max();
+    };
+
+    // The chunks of a chunked snapshot are read from the file by this thread,
+    // and checked and decoded on a worker thread while the coins of the
+    // previous chunk are hashed and inserted.
+    if (metadata.IsChunked() &&
+        !metadata.CheckChunks(GetSerializeSize(metadata, PROTOCOL_VERSION))) {
+        LogPrintf("[snapshot] bad snapshot chunk index\n");
+        return false;
+    }
+    const auto decode_chunk = [&metadata, &is_valid_coin](
+                                  CDataStream &data, size_t chunk)
+        -> std::optional<std::vector<std::pair<COutPoint, Coin>>> {
+        if (Hash(data) != metadata.m_chunks[chunk].m_checksum) {
+            LogPrintf("[snapshot] bad checksum for snapshot chunk %d\n",
+                      chunk);
+            return std::nullopt;
+        }
+        std::vector<std::pair<COutPoint, Coin>> coins;
+        coins.resize(metadata.GetChunkCoins(chunk));
         try {
-            coins_file >> outpoint;
-            coins_file >> coin;
+            for (auto &[chunk_outpoint, chunk_coin] : coins) {
+                data >> chunk_outpoint;
+                data >> chunk_coin;
+                if (!is_valid_coin(chunk_outpoint, chunk_coin)) {
+                    LogPrintf("[snapshot] bad data in snapshot chunk %d\n",
+                              chunk);
+                    return std::nullopt;
+                }
+            }
         } catch (const std::ios_base::failure &) {
-            LogPrintf("[snapshot] bad snapshot format or truncated snapshot "
-                      "after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
+            LogPrintf("[snapshot] bad format for snapshot chunk %d\n", chunk);
+            return std::nullopt;
         }
-        if (coin.GetHeight() > uint32_t(base_height) ||
-            // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-            outpoint.GetN() >=
-                std::numeric_limits<decltype(outpoint.GetN())>::max()) {
-            LogPrintf(
-                "[snapshot] bad snapshot data after deserializing %d coins\n",
-                coins_count - coins_left);
-            return false;
+        if (!data.empty()) {
+            LogPrintf("[snapshot] trailing data in snapshot chunk %d\n",
+                      chunk);
+            return std::nullopt;
+        }
+        return coins;
+    };
+    size_t next_chunk{0};
+    std::future<std::optional<std::vector<std::pair<COutPoint, Coin>>>>
+        decoding;
+
+    while (coins_left > 0 || !hashing_batch.empty()) {
+        std::vector<std::pair<COutPoint, Coin>> batch;
+        if (metadata.IsChunked()) {
+            if (decoding.valid()) {
+                auto decoded = decoding.get();
+                if (!decoded) {
+                    return false;
+                }
+                batch = std::move(*decoded);
+                coins_left -= batch.size();
+            }
+            if (next_chunk < metadata.m_chunks.size()) {
+                const uint64_t chunk_size{metadata.m_chunks[next_chunk].m_size};
+                CDataStream data(SER_DISK, PROTOCOL_VERSION);
+                try {
+                    // Grow the buffer as the data is read, so a bogus chunk
+                    // size can't make us allocate more than the file size.
+                    while (data.size() < chunk_size) {
+                        const size_t read_pos{data.size()};
+                        const size_t read_size = std::min<uint64_t>(
+                            chunk_size - read_pos, SNAPSHOT_READ_SIZE);
+                        data.resize(read_pos + read_size);
+                        coins_file.read(
+                            reinterpret_cast<char *>(data.data() + read_pos),
+                            read_size);
+                    }
+                } catch (const std::ios_base::failure &) {
+                    LogPrintf("[snapshot] truncated snapshot in chunk %d\n",
+                              next_chunk);
+                    return false;
+                }
+                decoding = std::async(
+                    std::launch::async,
+                    [&decode_chunk, data = std::move(data),
+                     chunk = next_chunk]() mutable {
+                        util::ThreadRename("snapshotdecode");
+                        return decode_chunk(data, chunk);
+                    });
+                ++next_chunk;
+            }
+        } else {
+            batch.reserve(
+                std::min<uint64_t>(coins_left, SNAPSHOT_LOAD_BATCH_SIZE));
+            while (coins_left > 0 && batch.size() < SNAPSHOT_LOAD_BATCH_SIZE) {
+                try {
+                    coins_file >> outpoint;
+                    coins_file >> coin;
+                } catch (const std::ios_base::failure &) {
+                    LogPrintf("[snapshot] bad snapshot format or truncated "
+                              "snapshot after deserializing %d coins\n",
+                              coins_count - coins_left);
+                    return false;
+                }
+                if (!is_valid_coin(outpoint, coin)) {
+                    LogPrintf("[snapshot] bad snapshot data after "
+                              "deserializing %d coins\n",
+                              coins_count - coins_left);
+                    return false;
+                }
+                batch.emplace_back(std::move(outpoint), std::move(coin));
+                --coins_left;
+            }
         }
-        coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint),
-                                              std::move(coin));
-
-        --coins_left;
-        ++coins_processed;
 
-        if (coins_processed % 1000000 == 0) {
-            LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
-                      coins_processed,
-                      static_cast<float>(coins_processed) * 100 /
-                          static_cast<float>(coins_count),
-                      coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+        if (hashing.valid()) {
+            hashed_in_order = hashing.get() && hashed_in_order;
+        }
+        std::vector<std::pair<COutPoint, Coin>> loaded_batch =
+            std::exchange(hashing_batch, std::move(batch));
+        if (hashed_in_order && !hashing_batch.empty()) {
+            hashing = std::async(std::launch::async, [&hasher,
+                                                      &hashing_batch]() {
+                util::ThreadRename("snapshothash");
+                for (const auto &[batch_outpoint, batch_coin] :
+                     hashing_batch) {
+                    if (!hasher.Add(batch_outpoint, batch_coin)) {
+                        return false;
+                    }
+                }
+                return true;
+            });
         }
 
-        // Batch write and flush (if we need to) every so often.
-        //
-        // If our average Coin size is roughly 41 bytes, checking every 120,000
-        // coins means <5MB of memory imprecision.
-        if (coins_processed % 120000 == 0) {
-            if (ShutdownRequested()) {
-                return false;
-            }
+        for (auto &[loaded_outpoint, loaded_coin] : loaded_batch) {
+            coins_cache.EmplaceCoinInternalDANGER(std::move(loaded_outpoint),
+                                                  std::move(loaded_coin));
 
-            const auto snapshot_cache_state = WITH_LOCK(
-                ::cs_main, return snapshot_chainstate.GetCoinsCacheSizeState());
+            ++coins_processed;
 
-            if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                // This is a hack - we don't know what the actual best block is,
-                // but that doesn't matter for the purposes of flushing the
-                // cache here. We'll set this to its correct value
-                // (`base_blockhash`) below after the coins are loaded.
-                coins_cache.SetBestBlock(BlockHash{GetRandHash()});
+            if (coins_processed % 1000000 == 0) {
+                LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
+                          coins_processed,
+                          static_cast<float>(coins_processed) * 100 /
+                              static_cast<float>(coins_count),
+                          coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+            }
 
-                // No need to acquire cs_main since this chainstate isn't being
-                // used yet.
-                FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+            // Batch write and flush (if we need to) every so often.
+            //
+            // If our average Coin size is roughly 41 bytes, checking every
+            // 120,000 coins means <5MB of memory imprecision.
+            if (coins_processed % 120000 == 0) {
+                if (ShutdownRequested()) {
+                    return false;
+                }
+
+                const auto snapshot_cache_state =
+                    WITH_LOCK(::cs_main,
+                              return snapshot_chainstate
+                                  .GetCoinsCacheSizeState());
+
+                if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
+                    // This is a hack - we don't know what the actual best
+                    // block is, but that doesn't matter for the purposes of
+                    // flushing the cache here. We'll set this to its correct
+                    // value (`base_blockhash`) below after the coins are
+                    // loaded.
+                    coins_cache.SetBestBlock(BlockHash{GetRandHash()});
+
+                    // No need to acquire cs_main since this chainstate isn't
+                    // being used yet.
+                    FlushSnapshotToDisk(coins_cache,
+                                        /*snapshot_loaded=*/false);
+                }
             }
         }
     }
@@ -6300,12 +7616,20 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
 
     std::optional<CCoinsStats> maybe_stats;
 
-    try {
-        maybe_stats = ComputeUTXOStats(CoinStatsHashType::HASH_SERIALIZED,
-                                       snapshot_coinsdb, m_blockman,
-                                       SnapshotUTXOHashBreakpoint);
-    } catch (StopHashingException const &) {
-        return false;
+    if (hashed_in_order) {
+        maybe_stats = hasher.Finalize();
+    } else {
+        // The snapshot was not in database order, so hash the coins in the
+        // order they were written.
+        LogPrintf("[snapshot] coins are not sorted, hashing the coins "
+                  "database\n");
+        try {
+            maybe_stats = ComputeUTXOStats(CoinStatsHashType::HASH_SERIALIZED,
+                                           snapshot_coinsdb, m_blockman,
+                                           SnapshotUTXOHashBreakpoint);
+        } catch (StopHashingException const &) {
+            return false;
+        }
     }
     if (!maybe_stats.has_value()) {
         LogPrintf("[snapshot] failed to generate coins stats\n");
@@ -22,10 +22,12 @@
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
 #include <disconnectresult.h>
+#include <feerate.h>
 #include <flatfile.h>
 #include <fs.h>
 #include <kernel/chainstatemanager_opts.h>
 #include <node/blockstorage.h>
+#include <node/coinsprefetcher.h>
 #include <policy/packages.h>
 #include <script/script_error.h>
 #include <script/script_metrics.h>
@@ -52,6 +54,7 @@ class BlockPolicyValidationState;
 class CChainParams;
 class Chainstate;
 class ChainstateManager;
+class CSchnorrBatch;
 class CScriptCheck;
 class CTxMemPool;
 class CTxUndo;
@@ -82,6 +85,10 @@ static const int MAX_SCRIPTCHECK_THREADS = 15;
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
+/** Default for -parallelconnect */
+static const bool DEFAULT_PARALLEL_CONNECT = false;
+/** Default for -backgroundflush */
+static const bool DEFAULT_BACKGROUND_FLUSH = false;
 static const bool DEFAULT_TXINDEX = false;
 static constexpr bool DEFAULT_COINSTATSINDEX{false};
 static const char *const DEFAULT_BLOCKFILTERINDEX = "0";
@@ -100,6 +107,10 @@ static const int DEFAULT_STOPATHEIGHT = 0;
 static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
 static const signed int DEFAULT_CHECKBLOCKS = 6;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
+/** Default for -checkblocksthreads */
+static constexpr int DEFAULT_CHECKBLOCKS_THREADS{0};
+/** Maximum number of blocks checked in parallel by -checkblocksthreads */
+static constexpr int MAX_CHECKBLOCKS_THREADS{64};
 /**
  * Require that user allocate at least 550 MiB for block & undo files
  * (blk???.dat and rev???.dat)
@@ -126,6 +137,23 @@ extern uint256 g_best_block;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+/**
+ * Whether ConnectBlock checks the block transactions against the coins they
+ * spend on the script check worker threads instead of serially.
+ */
+extern bool g_parallel_connect;
+/**
+ * Number of upcoming blocks whose spent coins are read from the coins database
+ * in the background during initial block download, at most
+ * node::MAX_PREFETCH_BLOCKS. 0 disables prefetching.
+ */
+extern int g_prefetch_blocks;
+/**
+ * Whether the coins cache is written to the coins database on a background
+ * thread when it is flushed while the node is running, instead of blocking
+ * validation until the write completes.
+ */
+extern bool g_background_flush;
 
 /**
  * If the tip is older than this (in seconds), the node is considered to be in
@@ -181,7 +209,8 @@ public:
 };
 
 /**
- * Run instances of script checking worker threads
+ * Run instances of script checking worker threads. The same number of threads
+ * is started to check transaction inputs when -parallelconnect is set.
  */
 void StartScriptCheckWorkerThreads(int threads_num);
 
@@ -339,6 +368,33 @@ ProcessNewPackage(const Config &config, Chainstate &active_chainstate,
                   CTxMemPool &pool, const Package &txns, bool test_accept)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Validate (and maybe submit) transactions to the mempool, in order. The script
+ * checks of the transactions that neither depend on nor conflict with an
+ * earlier one are run in parallel.
+ *
+ * Like for packages, the mempool is only trimmed once all the transactions are
+ * submitted, so that the mempool parents of the following transactions are not
+ * evicted. A transaction that is evicted then is reported as rejected for
+ * "mempool full". The evictions and the minimum fee bump can differ from the
+ * ones of submitting the transactions one by one, and a transaction can be
+ * accepted below a minimum fee that trimming after an earlier transaction of
+ * the batch would have raised.
+ *
+ * @param[in]    test_accept     When true, run validation checks but don't
+ *                               submit to mempool.
+ * @param[in]    max_fee_rate    Reject the transactions paying a higher fee
+ *                               rate, unless it is zero.
+ * @returns the MempoolAcceptResult of each transaction, in order.
+ */
+std::vector<MempoolAcceptResult>
+ProcessNewTransactions(const Config &config, Chainstate &active_chainstate,
+                       CTxMemPool &pool,
+                       const std::vector<CTransactionRef> &txns,
+                       bool test_accept,
+                       const CFeeRate &max_fee_rate = CFeeRate())
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
  * Simple class for regulating resource usage during CheckInputScripts (and
  * CScriptCheck), atomic so as to be compatible with parallel validation.
@@ -489,6 +545,9 @@ private:
     TxSigCheckLimiter *pTxLimitSigChecks;
     CheckInputsLimiter *pBlockLimitSigChecks;
 
+    bool VerifyScript(CSchnorrBatch *schnorr_batch);
+    bool ConsumeSigChecks();
+
 public:
     CScriptCheck()
         : ptxTo(nullptr), nIn(0), nFlags(0), cacheStore(false),
@@ -523,8 +582,17 @@ public:
     ScriptError GetScriptError() const { return error; }
 
     ScriptExecutionMetrics GetScriptExecutionMetrics() const { return metrics; }
+
+    friend bool RunCheckBatch(std::vector<CScriptCheck> &checks);
 };
 
+/**
+ * Run a batch of script checks, verifying their Schnorr signatures all at once.
+ * If the batch fails, the checks are run again one by one to find the failing
+ * one.
+ */
+bool RunCheckBatch(std::vector<CScriptCheck> &checks);
+
 /** Functions for validating blocks and updating the block tree */
 
 /**
@@ -537,6 +605,20 @@ bool CheckBlock(const CBlock &block, BlockValidationState &state,
                 const Consensus::Params &params,
                 BlockValidationOptions validationOptions);
 
+/** A block read from a block file, and its position on disk */
+using ExternalBlock = std::pair<std::shared_ptr<CBlock>, FlatFilePos>;
+
+/**
+ * Read the blocks of the block file number nFile for -reindex, in file order,
+ * and run their context-free checks. This doesn't use the chainstate, so
+ * several files can be read concurrently before they are imported with
+ * Chainstate::LoadExternalBlocks.
+ *
+ * @param[in]     fileIn  FILE handle to the block file, closed when done
+ */
+std::vector<ExternalBlock> ReadBlockFile(const Config &config, FILE *fileIn,
+                                         int nFile);
+
 /**
  * This is a variant of ContextualCheckTransaction which computes the contextual
  * check for a transaction based on the chain tip.
@@ -585,10 +667,14 @@ public:
 
     ~CVerifyDB();
 
+    /**
+     * @param[in] threads_num Number of blocks to read and check ahead of time
+     *                        on background threads. 0 checks them serially.
+     */
     [[nodiscard]] VerifyDBResult
     VerifyDB(Chainstate &chainstate, const Config &config,
-             CCoinsView &coinsview, int nCheckLevel, int nCheckDepth)
-        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+             CCoinsView &coinsview, int nCheckLevel, int nCheckDepth,
+             int threads_num = 0) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 };
 
 /** @see Chainstate::FlushStateToDisk */
@@ -689,6 +775,12 @@ protected:
     //! `m_chain`.
     std::unique_ptr<CoinsViews> m_coins_views;
 
+    //! Reads the next blocks to connect during initial block download ahead
+    //! of time, and warms the coins cache with the coins they spend. It reads
+    //! from m_coins_views, so it must be destroyed first.
+    std::unique_ptr<node::CoinsPrefetcher> m_coins_prefetcher
+        GUARDED_BY(::cs_main);
+
     //! This toggle exists for use when doing background validation for UTXO
     //! snapshots.
     //!
@@ -813,7 +905,10 @@ public:
     }
 
     //! Destructs all objects related to accessing the UTXO set.
-    void ResetCoinsViews() { m_coins_views.reset(); }
+    void ResetCoinsViews() EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+        m_coins_prefetcher.reset();
+        m_coins_views.reset();
+    }
 
     //! Does this chainstate have a UTXO set attached?
     bool HasCoinsViews() const { return (bool)m_coins_views; }
@@ -866,6 +961,16 @@ public:
             nullptr) EXCLUSIVE_LOCKS_REQUIRED(!m_chainstate_mutex,
                                               !cs_avalancheFinalizedBlockIndex);
 
+    /**
+     * Import blocks that were read from a block file by ReadBlockFile, the same
+     * way LoadExternalBlockFile does during reindexing.
+     */
+    void LoadExternalBlocks(
+        const Config &config, std::vector<ExternalBlock> blocks,
+        std::multimap<BlockHash, FlatFilePos> &blocks_with_unknown_parent)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_chainstate_mutex,
+                                 !cs_avalancheFinalizedBlockIndex);
+
     /**
      * Update the on-disk chain state.
      * The caches and indexes are flushed depending on the mode we're called
@@ -1052,6 +1157,19 @@ public:
     }
 
 private:
+    /**
+     * Import a block read from an external file, see LoadExternalBlockFile.
+     *
+     * @returns false if importing the following blocks should be aborted
+     */
+    bool ImportExternalBlock(
+        const Config &config, const std::shared_ptr<CBlock> &pblock,
+        FlatFilePos *dbp,
+        std::multimap<BlockHash, FlatFilePos> *blocks_with_unknown_parent,
+        int &nLoaded)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_chainstate_mutex,
+                                 !cs_avalancheFinalizedBlockIndex);
+
     bool ActivateBestChainStep(const Config &config,
                                BlockValidationState &state,
                                CBlockIndex *pindexMostWork,
@@ -1059,6 +1177,17 @@ private:
                                bool &fInvalidFound, ConnectTrace &connectTrace)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs,
                                  !cs_avalancheFinalizedBlockIndex);
+    /**
+     * Warm the coins cache with the prefetched coins of pindexNext, which is
+     * about to be connected, and start prefetching the blocks that follow it
+     * in vpindexToConnect.
+     *
+     * @returns the prefetched pindexNext block, or nullptr if it isn't ready
+     */
+    std::shared_ptr<const CBlock>
+    PrefetchBlocks(const CBlockIndex *pindexNext,
+                   const std::vector<CBlockIndex *> &vpindexToConnect)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool ConnectTip(const Config &config, BlockValidationState &state,
                     BlockPolicyValidationState &blockPolicyState,
                     CBlockIndex *pindexNew,
@@ -1105,6 +1234,11 @@ private:
 
     std::chrono::microseconds m_last_write{0};
     std::chrono::microseconds m_last_flush{0};
+    //! Locator of the chain written by the background flush in progress. It is
+    //! only reported to ChainStateFlushed once the coins are written, so that
+    //! the wallets never record a block the coin database didn't reach.
+    std::optional<CBlockLocator>
+        m_background_flush_locator GUARDED_BY(::cs_main);
 
     /**
      * In case of an invalid snapshot, rename the coins leveldb directory so
@@ -1455,6 +1589,23 @@ public:
     ProcessTransaction(const CTransactionRef &tx, bool test_accept = false)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Try to add transactions to the memory pool, as if they were submitted
+     * one by one in order. See ProcessNewTransactions().
+     *
+     * @param[in]  txns            The transactions to submit for mempool
+     *                             acceptance.
+     * @param[in]  test_accept     When true, run validation checks but don't
+     *                             submit to mempool.
+     * @param[in]  max_fee_rate    Reject the transactions paying a higher fee
+     *                             rate, unless it is zero.
+     */
+    [[nodiscard]] std::vector<MempoolAcceptResult>
+    ProcessTransactions(const std::vector<CTransactionRef> &txns,
+                        bool test_accept = false,
+                        const CFeeRate &max_fee_rate = CFeeRate())
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     //! Load the block tree and coins database from disk, initializing state if
     //! we're running with -reindex
     bool LoadBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
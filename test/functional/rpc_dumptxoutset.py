@@ -56,6 +56,26 @@ class DumptxoutsetTest(BitcoinTestFramework):
             -8, f"{FILENAME} already exists", node.dumptxoutset, FILENAME
         )
 
+        # Chunked snapshots start with the magic bytes and version 2.
+        CHUNKED_FILENAME = "txoutset_chunked.dat"
+        out = node.dumptxoutset(CHUNKED_FILENAME, 30)
+        assert_equal(out["coins_written"], 100)
+        assert_equal(out["chunks"], 4)
+        assert_equal(
+            out["txoutset_hash"],
+            "f00b066f5014ef37f0bb40ab455f995a85ac475bc3beaa721476854a37fb4268",
+        )
+        with open(str(Path(node.datadir) / self.chain / CHUNKED_FILENAME), "rb") as f:
+            assert_equal(f.read(7), b"utxo\xff\x02\x00")
+
+        assert_raises_rpc_error(
+            -8,
+            "chunk_coins must be between 0 and 1000000",
+            node.dumptxoutset,
+            "txoutset_invalid.dat",
+            -1,
+        )
+
 
 if __name__ == "__main__":
     DumptxoutsetTest().main()
@@ -0,0 +1,192 @@
+# Copyright (c) 2026 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the sendrawtransactions RPC.
+
+The transactions are submitted as if sendrawtransaction was called for each of
+them in order, and the result of each transaction is reported in the same
+order as the input.
+"""
+
+from decimal import Decimal
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_raises_rpc_error
+from test_framework.wallet import MiniWallet
+
+MAX_FEE_EXCEEDED = "Fee exceeds maximum configured by user (e.g. -maxtxfee, maxfeerate)"
+
+
+class SendRawTransactionsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+
+    def run_test(self):
+        node = self.nodes[0]
+        self.wallet = MiniWallet(node)
+        self.generate(self.wallet, 10)
+        self.generate(node, 100)
+
+        self.test_invalid_parameters()
+        self.test_mixed_results()
+        self.test_duplicates()
+        self.test_maxfeerate()
+
+    def test_invalid_parameters(self):
+        self.log.info("Test invalid parameters")
+        node = self.nodes[0]
+        assert_raises_rpc_error(
+            -8,
+            "Array must contain between 1 and 1000 transactions.",
+            node.sendrawtransactions,
+            [],
+        )
+        assert_raises_rpc_error(
+            -22, "TX decode failed", node.sendrawtransactions, ["00"]
+        )
+
+    def test_mixed_results(self):
+        self.log.info(
+            "Test a mix of valid, invalid and already known transactions, in order"
+        )
+        node = self.nodes[0]
+
+        in_chain = self.wallet.send_self_transfer(from_node=node)
+        self.generate(node, 1)
+        in_mempool = self.wallet.send_self_transfer(from_node=node)
+
+        utxo = self.wallet.get_utxo()
+        parent = self.wallet.create_self_transfer(from_node=node, utxo_to_spend=utxo)
+        child = self.wallet.create_self_transfer(
+            from_node=node, utxo_to_spend=parent["new_utxo"]
+        )
+        conflicting = self.wallet.create_self_transfer(
+            from_node=node, utxo_to_spend=utxo, fee_rate=Decimal("2000.00")
+        )
+        missing_inputs = self.wallet.create_self_transfer(
+            from_node=node,
+            utxo_to_spend={
+                "txid": "00" * 32,
+                "vout": 0,
+                "value": Decimal("1000000.00"),
+                "height": 0,
+            },
+        )
+        independent = self.wallet.create_self_transfer(from_node=node)
+
+        # The child is listed before the parent, so it has no inputs when it is
+        # submitted. The conflicting transaction comes after the parent and its
+        # child.
+        txs = [
+            child,
+            in_chain,
+            parent,
+            conflicting,
+            missing_inputs,
+            in_mempool,
+            independent,
+        ]
+        results = node.sendrawtransactions([tx["hex"] for tx in txs])
+        assert_equal(
+            results,
+            [
+                {
+                    "txid": child["txid"],
+                    "error": "bad-txns-inputs-missingorspent",
+                },
+                {
+                    "txid": in_chain["txid"],
+                    "error": "Transaction already in block chain",
+                },
+                {"txid": parent["txid"]},
+                {"txid": conflicting["txid"], "error": "txn-mempool-conflict"},
+                {
+                    "txid": missing_inputs["txid"],
+                    "error": "bad-txns-inputs-missingorspent",
+                },
+                {"txid": in_mempool["txid"]},
+                {"txid": independent["txid"]},
+            ],
+        )
+        assert_equal(
+            sorted(node.getrawmempool()),
+            sorted([in_mempool["txid"], parent["txid"], independent["txid"]]),
+        )
+
+        # Once its parent is known, the child is accepted.
+        results = node.sendrawtransactions([parent["hex"], child["hex"]])
+        assert_equal(results, [{"txid": parent["txid"]}, {"txid": child["txid"]}])
+        assert child["txid"] in node.getrawmempool()
+        self.generate(node, 1)
+
+    def test_duplicates(self):
+        self.log.info("Test the copies of a transaction get the same result")
+        node = self.nodes[0]
+
+        parent = self.wallet.create_self_transfer(from_node=node)
+        child = self.wallet.create_self_transfer(
+            from_node=node, utxo_to_spend=parent["new_utxo"]
+        )
+        missing_inputs = self.wallet.create_self_transfer(
+            from_node=node,
+            utxo_to_spend={
+                "txid": "00" * 32,
+                "vout": 0,
+                "value": Decimal("1000000.00"),
+                "height": 0,
+            },
+        )
+
+        txs = [parent, missing_inputs, parent, child, missing_inputs, child]
+        results = node.sendrawtransactions([tx["hex"] for tx in txs])
+        missing_inputs_result = {
+            "txid": missing_inputs["txid"],
+            "error": "bad-txns-inputs-missingorspent",
+        }
+        assert_equal(
+            results,
+            [
+                {"txid": parent["txid"]},
+                missing_inputs_result,
+                {"txid": parent["txid"]},
+                {"txid": child["txid"]},
+                missing_inputs_result,
+                {"txid": child["txid"]},
+            ],
+        )
+        assert_equal(
+            sorted(node.getrawmempool()), sorted([parent["txid"], child["txid"]])
+        )
+        self.generate(node, 1)
+
+    def test_maxfeerate(self):
+        self.log.info("Test maxfeerate")
+        node = self.nodes[0]
+
+        high_fee = self.wallet.create_self_transfer(
+            from_node=node, fee_rate=Decimal("3000.00")
+        )
+        low_fee = self.wallet.create_self_transfer(
+            from_node=node, fee_rate=Decimal("500.00")
+        )
+        results = node.sendrawtransactions(
+            rawtxs=[high_fee["hex"], low_fee["hex"]], maxfeerate=Decimal("1000.00")
+        )
+        assert_equal(
+            results,
+            [
+                {"txid": high_fee["txid"], "error": MAX_FEE_EXCEEDED},
+                {"txid": low_fee["txid"]},
+            ],
+        )
+        assert_equal(node.getrawmempool(), [low_fee["txid"]])
+
+        # A zero maxfeerate accepts any fee rate.
+        results = node.sendrawtransactions(rawtxs=[high_fee["hex"]], maxfeerate=0)
+        assert_equal(results, [{"txid": high_fee["txid"]}])
+        assert high_fee["txid"] in node.getrawmempool()
+
+
+if __name__ == "__main__":
+    SendRawTransactionsTest().main()